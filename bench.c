@@ -0,0 +1,703 @@
+// ============================================================================
+//         PROJETO WAR ESTRUTURADO - BENCHMARKS
+// ============================================================================
+//
+// Mede os caminhos quentes do jogo e imprime os resultados em JSON:
+// - simularAtaque() e resolverAtaque(): ataques resolvidos por segundo
+// - verificarVitoria(): latência com mapas de 5 a 100 mil territórios
+// - verificarMissoes(): todas as missões de 30 jogadores, com regiões dominadas
+// - calcularReforcos(): uma conquista e os reforços de todas as cores por turno
+// - restaurarInstantaneo(): uma jogada hipotética desfeita pelo diário, contra
+//   copiarEstadoMapa()
+// - alocarMapa()/inicializarTerritorios(): tempo de preparação do mapa
+// - exibirMapa(): custo de um quadro completo e de um quadro com uma mudança
+//
+// Uso:
+//   make bench
+//   ./bench --saida base.json                  # grava uma referência
+//   ./bench --comparar base.json [--tolerancia 10]
+//
+// No modo de comparação, cada resultado pior que a referência além da
+// tolerância (em %) é marcado como regressão e o programa retorna 1.
+//
+// ============================================================================
+
+#include "war.h"
+
+// --- Constantes dos Benchmarks ---
+#define REPETICOES 3
+#define MAX_RESULTADOS 64
+#define TOLERANCIA_PADRAO 10.0
+#define NUM_CORES_GRADE 5
+
+// --- Estrutura de Dados ---
+typedef struct {
+    char nome[64];
+    const char *unidade;
+    double valor;
+    int maiorMelhor;         // 1 se valores maiores são melhores (ops/s), 0 para tempos
+    int temBase;
+    double base;
+    int regrediu;
+} Resultado;
+
+typedef struct {
+    Resultado itens[MAX_RESULTADOS];
+    int quantidade;
+} ListaResultados;
+
+// Estado compartilhado por uma medição (cada benchmark usa os campos de que precisa).
+typedef struct {
+    const Mapa *modelo;
+    Mapa *mapa;
+    Objetivo objetivo;
+    Objetivo *objetivos;
+    int numObjetivos;
+    GeradorAleatorio gerador;
+    Tela *tela;
+    long long soma;
+} Contexto;
+
+typedef void (*FuncaoMedida)(Contexto *contexto, long long iteracoes);
+
+// --- Protótipos das Funções ---
+Mapa* criarMapaGrade(int quantidade);
+double medir(FuncaoMedida funcao, Contexto *contexto, long long iteracoes);
+void medirAtaques(ListaResultados *lista);
+void medirVitoria(ListaResultados *lista);
+void medirMissoes(ListaResultados *lista);
+void medirReforcos(ListaResultados *lista);
+void medirInstantaneos(ListaResultados *lista);
+void medirPreparacao(ListaResultados *lista);
+void medirExibicao(ListaResultados *lista);
+void anotarResultado(ListaResultados *lista, const char *nome, const char *unidade, double valor, int maiorMelhor);
+int carregarBase(ListaResultados *lista, const char *caminho);
+void imprimirJSON(FILE *saida, const ListaResultados *lista);
+int compararComBase(ListaResultados *lista, double tolerancia);
+
+// --- Função Principal (main) ---
+int main(int argc, char *argv[]) {
+    const char *arquivoSaida = NULL;
+    const char *arquivoBase = NULL;
+    double tolerancia = TOLERANCIA_PADRAO;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--saida") == 0 && i + 1 < argc) {
+            arquivoSaida = argv[++i];
+        } else if (strcmp(argv[i], "--comparar") == 0 && i + 1 < argc) {
+            arquivoBase = argv[++i];
+        } else if (strcmp(argv[i], "--tolerancia") == 0 && i + 1 < argc) {
+            tolerancia = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "Uso: %s [--saida ARQUIVO.json] [--comparar BASE.json] [--tolerancia PORCENTAGEM]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // O jogo escreve na saída padrão: durante as medições ela vai para /dev/null
+    fflush(stdout);
+    int saidaOriginal = dup(STDOUT_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+    if (saidaOriginal < 0 || nulo < 0 || dup2(nulo, STDOUT_FILENO) < 0) {
+        fprintf(stderr, "❌ Não foi possível redirecionar a saída padrão\n");
+        return 1;
+    }
+    close(nulo);
+
+    ListaResultados resultados;
+    memset(&resultados, 0, sizeof(resultados));
+
+    medirAtaques(&resultados);
+    medirVitoria(&resultados);
+    medirMissoes(&resultados);
+    medirReforcos(&resultados);
+    medirInstantaneos(&resultados);
+    medirPreparacao(&resultados);
+    medirExibicao(&resultados);
+
+    fflush(stdout);
+    dup2(saidaOriginal, STDOUT_FILENO);
+    close(saidaOriginal);
+
+    int status = 0;
+    if (arquivoBase != NULL) {
+        if (carregarBase(&resultados, arquivoBase) != 0) {
+            return 1;
+        }
+        status = compararComBase(&resultados, tolerancia);
+    }
+
+    imprimirJSON(stdout, &resultados);
+    if (arquivoSaida != NULL) {
+        FILE *arquivo = fopen(arquivoSaida, "w");
+        if (arquivo == NULL) {
+            fprintf(stderr, "❌ Não foi possível criar %s\n", arquivoSaida);
+            return 1;
+        }
+        imprimirJSON(arquivo, &resultados);
+        fclose(arquivo);
+    }
+    return status;
+}
+
+// --- Implementação das Funções ---
+
+/**
+ * criarMapaGrade()
+ * Cria um mapa sintético em grade quadrada, com as cores distribuídas em
+ * faixas e 3 tropas por território.
+ * Parâmetros:
+ *   - quantidade: número de territórios
+ * Retorna:
+ *   - Ponteiro para o mapa, ou NULL em caso de erro
+ */
+Mapa* criarMapaGrade(int quantidade) {
+    static const char *cores[NUM_CORES_GRADE] = {"Azul", "Verde", "Vermelho", "Amarelo", "Preto"};
+    Mapa *mapa = alocarMapa(quantidade);
+    if (mapa == NULL) {
+        return NULL;
+    }
+
+    int largura = 1;
+    while (largura * largura < quantidade) {
+        largura++;
+    }
+    uint32_t (*pares)[2] = (uint32_t (*)[2]) malloc((size_t) quantidade * 2 * sizeof(uint32_t[2]));
+    if (pares == NULL) {
+        liberarMemoria(mapa);
+        return NULL;
+    }
+
+    int numPares = 0;
+    char nome[32];
+    for (int i = 0; i < quantidade; i++) {
+        snprintf(nome, sizeof(nome), "T%d", i);
+        adicionarTexto(mapa->nomes, nome);
+        mapa->cor[i] = (IdCor) internarTexto(mapa->cores, cores[(i / largura) % NUM_CORES_GRADE]);
+        mapa->tropas[i] = 3;
+        if ((i + 1) % largura != 0 && i + 1 < quantidade) {
+            pares[numPares][0] = (uint32_t) i;
+            pares[numPares++][1] = (uint32_t) (i + 1);
+        }
+        if (i + largura < quantidade) {
+            pares[numPares][0] = (uint32_t) i;
+            pares[numPares++][1] = (uint32_t) (i + largura);
+        }
+    }
+
+    int falhou = definirFronteiras(mapa, (const uint32_t (*)[2]) pares, numPares) != 0
+              || recalcularContagens(mapa) != 0
+              || compilarMissoes(mapa, NULL) != 0;
+    free(pares);
+    if (falhou) {
+        liberarMemoria(mapa);
+        return NULL;
+    }
+    return mapa;
+}
+
+/**
+ * medir()
+ * Executa uma medição REPETICOES vezes e fica com o menor tempo, que é o
+ * menos afetado por interrupções do sistema.
+ * Parâmetros:
+ *   - funcao: laco a medir
+ *   - contexto: estado do laco
+ *   - iteracoes: repetições do laco em cada medição
+ * Retorna:
+ *   - Melhor tempo por iteração, em segundos
+ */
+double medir(FuncaoMedida funcao, Contexto *contexto, long long iteracoes) {
+    double melhor = 0.0;
+    for (int r = 0; r < REPETICOES; r++) {
+        struct timespec inicio, fim;
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        funcao(contexto, iteracoes);
+        clock_gettime(CLOCK_MONOTONIC, &fim);
+        double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+        if (r == 0 || segundos < melhor) {
+            melhor = segundos;
+        }
+    }
+    return melhor / iteracoes;
+}
+
+/**
+ * anotarResultado()
+ * Acrescenta um resultado à lista e mostra o progresso na saída de erro.
+ */
+void anotarResultado(ListaResultados *lista, const char *nome, const char *unidade, double valor, int maiorMelhor) {
+    if (lista->quantidade >= MAX_RESULTADOS) {
+        return;
+    }
+    Resultado *resultado = &lista->itens[lista->quantidade++];
+    memset(resultado, 0, sizeof(*resultado));
+    snprintf(resultado->nome, sizeof(resultado->nome), "%s", nome);
+    resultado->unidade = unidade;
+    resultado->valor = valor;
+    resultado->maiorMelhor = maiorMelhor;
+    fprintf(stderr, "  %-32s %14.3f %s\n", nome, valor, unidade);
+}
+
+// Ataque Brasil → Argentina repetido; o mapa volta ao estado inicial
+// sempre que o ataque deixa de ser válido ou o território é conquistado.
+static void lacoSimularAtaque(Contexto *contexto, long long iteracoes) {
+    for (long long i = 0; i < iteracoes; i++) {
+        if (validarAtaque(contexto->mapa, 0, 1) != ATAQUE_VALIDO) {
+            copiarEstadoMapa(contexto->mapa, contexto->modelo);
+        }
+        simularAtaque(contexto->mapa, 0, 1, &contexto->gerador, &contexto->objetivo, NULL);
+    }
+}
+
+static void lacoResolverAtaque(Contexto *contexto, long long iteracoes) {
+    for (long long i = 0; i < iteracoes; i++) {
+        if (validarAtaque(contexto->mapa, 0, 1) != ATAQUE_VALIDO) {
+            copiarEstadoMapa(contexto->mapa, contexto->modelo);
+        }
+        int dadoAtacante = rolarDado(&contexto->gerador);
+        int dadoDefensor = rolarDado(&contexto->gerador);
+        contexto->soma += resolverAtaque(contexto->mapa, 0, 1, dadoAtacante, dadoDefensor, &contexto->objetivo);
+    }
+}
+
+/**
+ * medirAtaques()
+ * Ataques resolvidos por segundo no mapa padrão: simularAtaque() completo
+ * (com a saída descartada) e só a lógica (validar, dados e resolverAtaque).
+ */
+void medirAtaques(ListaResultados *lista) {
+    Contexto contexto;
+    memset(&contexto, 0, sizeof(contexto));
+    Mapa *modelo = alocarMapa(NUM_TERRITORIOS);
+    if (modelo == NULL || inicializarTerritorios(modelo) != 0 || compilarMissoes(modelo, NULL) != 0) {
+        liberarMemoria(modelo);
+        return;
+    }
+    contexto.modelo = modelo;
+    contexto.mapa = clonarMapa(modelo);
+    if (contexto.mapa == NULL) {
+        liberarMemoria(modelo);
+        return;
+    }
+    contexto.objetivo = prepararObjetivo(modelo, 1, buscarCor(modelo, "Azul"));
+    semearGerador(&contexto.gerador, 42);
+
+    anotarResultado(lista, "simular_ataque", "ops/s", 1.0 / medir(lacoSimularAtaque, &contexto, 200000), 1);
+    anotarResultado(lista, "resolver_ataque", "ops/s", 1.0 / medir(lacoResolverAtaque, &contexto, 20000000), 1);
+
+    liberarMemoria(contexto.mapa);
+    liberarMemoria(modelo);
+}
+
+static void lacoVerificarVitoria(Contexto *contexto, long long iteracoes) {
+    Objetivo objetivos[2] = { contexto->objetivo, prepararObjetivo(contexto->modelo, 2, contexto->objetivo.corJogador) };
+    for (long long i = 0; i < iteracoes; i++) {
+        contexto->soma += verificarVitoria(contexto->modelo, &objetivos[i & 1]);
+    }
+}
+
+/**
+ * medirVitoria()
+ * Latência de verificarVitoria(), alternando as duas missões, com mapas de
+ * 5 a 100 mil territórios.
+ */
+void medirVitoria(ListaResultados *lista) {
+    static const int tamanhos[] = {5, 100, 1000, 10000, 100000};
+    for (size_t t = 0; t < sizeof(tamanhos) / sizeof(tamanhos[0]); t++) {
+        Mapa *mapa = criarMapaGrade(tamanhos[t]);
+        if (mapa == NULL) {
+            continue;
+        }
+        Contexto contexto;
+        memset(&contexto, 0, sizeof(contexto));
+        contexto.modelo = mapa;
+        contexto.objetivo = prepararObjetivo(mapa, 1, buscarCor(mapa, "Azul"));
+
+        char nome[64];
+        snprintf(nome, sizeof(nome), "verificar_vitoria_%d", tamanhos[t]);
+        anotarResultado(lista, nome, "ns", 1e9 * medir(lacoVerificarVitoria, &contexto, 20000000), 0);
+        liberarMemoria(mapa);
+    }
+}
+
+static void lacoVerificarMissoes(Contexto *contexto, long long iteracoes) {
+    int cumpridas[NUM_CORES_GRADE * 6];
+    for (long long i = 0; i < iteracoes; i++) {
+        contexto->soma += verificarMissoes(contexto->modelo, contexto->objetivos, contexto->numObjetivos, cumpridas);
+    }
+}
+
+/**
+ * medirMissoes()
+ * Latência de verificarMissoes() com um catálogo de 6 missões (eliminar,
+ * territórios e 4 regiões) sorteadas para cada uma das 5 cores. As regiões
+ * são os territórios da primeira cor divididos em 4, todas dominadas: o pior
+ * caso, em que cada região é percorrida inteira.
+ */
+void medirMissoes(ListaResultados *lista) {
+    static const int tamanhos[] = {1000, 100000};
+    for (size_t t = 0; t < sizeof(tamanhos) / sizeof(tamanhos[0]); t++) {
+        Mapa *mapa = criarMapaGrade(tamanhos[t]);
+        size_t capacidade = (size_t) tamanhos[t] * 16 + 1024;
+        char *texto = (char*) malloc(capacidade);
+        if (mapa == NULL || texto == NULL) {
+            liberarMemoria(mapa);
+            free(texto);
+            continue;
+        }
+
+        size_t usado = (size_t) snprintf(texto, capacidade, "missao;eliminar;Verde;Eliminar;\n"
+                                                            "missao;territorios;%d;Territórios;\n", tamanhos[t] / 2);
+        int porRegiao = (mapa->territoriosPorCor[0] + 3) / 4;
+        int naRegiao = 0, regioes = 0;
+        for (int i = 0; i < mapa->quantidade; i++) {
+            if (mapa->cor[i] != 0) {
+                continue;
+            }
+            usado += (size_t) snprintf(texto + usado, capacidade - usado, "%s%s",
+                                       naRegiao == 0 ? "missao;regiao;" : ",", nomeTerritorio(mapa, i));
+            if (++naRegiao == porRegiao) {
+                usado += (size_t) snprintf(texto + usado, capacidade - usado, ";Região %d;\n", ++regioes);
+                naRegiao = 0;
+            }
+        }
+        if (naRegiao > 0) {
+            snprintf(texto + usado, capacidade - usado, ";Região %d;\n", ++regioes);
+        }
+
+        Objetivo objetivos[NUM_CORES_GRADE * 6];
+        Contexto contexto;
+        memset(&contexto, 0, sizeof(contexto));
+        contexto.modelo = mapa;
+        contexto.objetivos = objetivos;
+        if (compilarMissoesTexto(mapa, texto, "bench") == 0) {
+            for (int cor = 0; cor < NUM_CORES_GRADE; cor++) {
+                for (int m = 1; m <= mapa->missoes->quantidade; m++) {
+                    objetivos[contexto.numObjetivos++] = prepararObjetivo(mapa, m, (IdCor) cor);
+                }
+            }
+            char nome[64];
+            snprintf(nome, sizeof(nome), "verificar_missoes_%d", tamanhos[t]);
+            anotarResultado(lista, nome, "ns", 1e9 * medir(lacoVerificarMissoes, &contexto,
+                                                            tamanhos[t] >= 100000 ? 2000 : 200000), 0);
+        }
+        free(texto);
+        liberarMemoria(mapa);
+    }
+}
+
+// Um "turno" com uma conquista: o território muda para a próxima cor e os
+// reforços de todas as cores são recalculados.
+static void lacoReforcos(Contexto *contexto, long long iteracoes) {
+    Mapa *mapa = contexto->mapa;
+    for (long long i = 0; i < iteracoes; i++) {
+        int territorio = (int) (i % mapa->quantidade);
+        transferirTerritorio(mapa, territorio, (IdCor) ((mapa->cor[territorio] + 1) % NUM_CORES_GRADE));
+        for (int cor = 0; cor < NUM_CORES_GRADE; cor++) {
+            contexto->soma += calcularReforcos(mapa, (IdCor) cor);
+        }
+    }
+}
+
+/**
+ * medirReforcos()
+ * Custo de um turno de reforço (uma conquista e os reforços das 5 cores)
+ * com cada linha da grade como uma região. Deve ser o mesmo com 1000 e com
+ * 100 mil territórios: nada percorre o mapa.
+ */
+void medirReforcos(ListaResultados *lista) {
+    static const int tamanhos[] = {1000, 100000};
+    for (size_t t = 0; t < sizeof(tamanhos) / sizeof(tamanhos[0]); t++) {
+        Mapa *modelo = criarMapaGrade(tamanhos[t]);
+        int32_t *linha = (int32_t*) malloc((size_t) tamanhos[t] * sizeof(int32_t));
+        if (modelo == NULL || linha == NULL) {
+            liberarMemoria(modelo);
+            free(linha);
+            continue;
+        }
+        int largura = 1;
+        while (largura * largura < modelo->quantidade) {
+            largura++;
+        }
+        char nome[32];
+        int falhou = 0;
+        for (int inicio = 0; inicio < modelo->quantidade && !falhou; inicio += largura) {
+            int tamanho = 0;
+            for (int i = inicio; i < inicio + largura && i < modelo->quantidade; i++) {
+                linha[tamanho++] = i;
+            }
+            snprintf(nome, sizeof(nome), "Linha %d", inicio / largura);
+            falhou = definirRegiao(modelo, nome, 2, linha, tamanho) != 0;
+        }
+        free(linha);
+
+        Contexto contexto;
+        memset(&contexto, 0, sizeof(contexto));
+        contexto.mapa = (!falhou && recalcularContagens(modelo) == 0) ? clonarMapa(modelo) : NULL;
+        if (contexto.mapa != NULL) {
+            snprintf(nome, sizeof(nome), "turno_reforcos_%d", tamanhos[t]);
+            anotarResultado(lista, nome, "ns", 1e9 * medir(lacoReforcos, &contexto, 5000000), 0);
+        }
+        liberarMemoria(contexto.mapa);
+        liberarMemoria(modelo);
+    }
+}
+
+// Uma jogada hipotética (uma conquista) e a volta ao estado de partida, pela
+// cópia completa do modelo ou pelo instantâneo tirado no início.
+static void lacoRamificarCopia(Contexto *contexto, long long iteracoes) {
+    Mapa *mapa = contexto->mapa;
+    for (long long i = 0; i < iteracoes; i++) {
+        int territorio = (int) (i % mapa->quantidade);
+        transferirTerritorio(mapa, territorio, (IdCor) ((mapa->cor[territorio] + 1) % NUM_CORES_GRADE));
+        contexto->soma += mapa->numFronteiras[0];
+        copiarEstadoMapa(mapa, contexto->modelo);
+    }
+}
+
+static void lacoRamificarInstantaneo(Contexto *contexto, long long iteracoes) {
+    Mapa *mapa = contexto->mapa;
+    Instantaneo raiz = tirarInstantaneo(mapa);
+    for (long long i = 0; i < iteracoes; i++) {
+        int territorio = (int) (i % mapa->quantidade);
+        transferirTerritorio(mapa, territorio, (IdCor) ((mapa->cor[territorio] + 1) % NUM_CORES_GRADE));
+        contexto->soma += mapa->numFronteiras[0];
+        restaurarInstantaneo(mapa, raiz);
+    }
+}
+
+/**
+ * medirInstantaneos()
+ * Custo de explorar uma jogada hipotética e voltar atrás, como na busca
+ * dos outros exércitos: copiando o mapa inteiro (cresce com o mapa) ou
+ * desfazendo só o que mudou pelo diário (não depende do tamanho do mapa).
+ */
+void medirInstantaneos(ListaResultados *lista) {
+    static const int tamanhos[] = {1000, 100000};
+    for (size_t t = 0; t < sizeof(tamanhos) / sizeof(tamanhos[0]); t++) {
+        Contexto contexto;
+        memset(&contexto, 0, sizeof(contexto));
+        Mapa *modelo = criarMapaGrade(tamanhos[t]);
+        contexto.modelo = modelo;
+        contexto.mapa = (modelo != NULL) ? clonarMapa(modelo) : NULL;
+        if (contexto.mapa != NULL) {
+            char nome[64];
+            long long iteracoes = 200000000LL / tamanhos[t];
+            snprintf(nome, sizeof(nome), "ramificar_copia_%d", tamanhos[t]);
+            anotarResultado(lista, nome, "ns", 1e9 * medir(lacoRamificarCopia, &contexto, iteracoes), 0);
+            if (iniciarDiario(contexto.mapa) == 0) {
+                snprintf(nome, sizeof(nome), "ramificar_instantaneo_%d", tamanhos[t]);
+                anotarResultado(lista, nome, "ns", 1e9 * medir(lacoRamificarInstantaneo, &contexto, 5000000), 0);
+            }
+        }
+        liberarMemoria(contexto.mapa);
+        liberarMemoria(modelo);
+    }
+}
+
+static void lacoInicializar(Contexto *contexto, long long iteracoes) {
+    for (long long i = 0; i < iteracoes; i++) {
+        Mapa *mapa = alocarMapa(NUM_TERRITORIOS);
+        if (mapa == NULL || inicializarTerritorios(mapa) != 0) {
+            liberarMemoria(mapa);
+            continue;
+        }
+        contexto->soma += mapa->territoriosPorCor[0];
+        liberarMemoria(mapa);
+    }
+}
+
+static void lacoCriarGrade(Contexto *contexto, long long iteracoes) {
+    for (long long i = 0; i < iteracoes; i++) {
+        Mapa *mapa = criarMapaGrade((int) contexto->soma);
+        liberarMemoria(mapa);
+    }
+}
+
+/**
+ * medirPreparacao()
+ * Tempo para alocar e inicializar o mapa padrão, e para montar mapas
+ * sintéticos grandes (alocação, nomes, fronteiras e contadores).
+ */
+void medirPreparacao(ListaResultados *lista) {
+    Contexto contexto;
+    memset(&contexto, 0, sizeof(contexto));
+    anotarResultado(lista, "inicializar_territorios", "us", 1e6 * medir(lacoInicializar, &contexto, 100000), 0);
+
+    static const int tamanhos[] = {1000, 100000};
+    for (size_t t = 0; t < sizeof(tamanhos) / sizeof(tamanhos[0]); t++) {
+        contexto.soma = tamanhos[t];
+        char nome[64];
+        snprintf(nome, sizeof(nome), "criar_mapa_%d", tamanhos[t]);
+        anotarResultado(lista, nome, "us", 1e6 * medir(lacoCriarGrade, &contexto, tamanhos[t] >= 100000 ? 5 : 200), 0);
+    }
+}
+
+// Quadro completo: uma tela nova a cada iteração desenha a tabela inteira
+static void lacoQuadroCompleto(Contexto *contexto, long long iteracoes) {
+    for (long long i = 0; i < iteracoes; i++) {
+        Tela *tela = criarTela(0);
+        exibirMapa(tela, contexto->mapa);
+        exibirMissao(tela, contexto->mapa, 1);
+        exibirMenuPrincipal(tela);
+        descarregarTela(tela);
+        liberarTela(tela);
+    }
+}
+
+// Quadro seguinte: um território muda de tropas entre um quadro e outro
+static void lacoQuadroDiferenca(Contexto *contexto, long long iteracoes) {
+    for (long long i = 0; i < iteracoes; i++) {
+        contexto->mapa->tropas[i % contexto->mapa->quantidade] ^= 1;
+        exibirMapa(contexto->tela, contexto->mapa);
+        exibirMissao(contexto->tela, contexto->mapa, 1);
+        exibirMenuPrincipal(contexto->tela);
+        descarregarTela(contexto->tela);
+    }
+}
+
+/**
+ * medirExibicao()
+ * Custo de um quadro de exibirMapa() (com missão e menu) enviado para
+ * /dev/null: o primeiro quadro, completo, e um quadro com uma única mudança.
+ */
+void medirExibicao(ListaResultados *lista) {
+    static const int tamanhos[] = {5, 1000, 100000};
+    for (size_t t = 0; t < sizeof(tamanhos) / sizeof(tamanhos[0]); t++) {
+        Contexto contexto;
+        memset(&contexto, 0, sizeof(contexto));
+        contexto.mapa = criarMapaGrade(tamanhos[t]);
+        contexto.tela = criarTela(0);
+        if (contexto.mapa == NULL || contexto.tela == NULL) {
+            liberarMemoria(contexto.mapa);
+            liberarTela(contexto.tela);
+            continue;
+        }
+        long long iteracoes = tamanhos[t] >= 100000 ? 10 : 200000 / tamanhos[t] + 100;
+
+        char nome[64];
+        snprintf(nome, sizeof(nome), "exibir_mapa_completo_%d", tamanhos[t]);
+        anotarResultado(lista, nome, "us", 1e6 * medir(lacoQuadroCompleto, &contexto, iteracoes), 0);
+
+        exibirMapa(contexto.tela, contexto.mapa);  // Primeiro quadro, fora da medição
+        descarregarTela(contexto.tela);
+        snprintf(nome, sizeof(nome), "exibir_mapa_diferenca_%d", tamanhos[t]);
+        anotarResultado(lista, nome, "us", 1e6 * medir(lacoQuadroDiferenca, &contexto, iteracoes * 10), 0);
+
+        liberarTela(contexto.tela);
+        liberarMemoria(contexto.mapa);
+    }
+}
+
+/**
+ * carregarBase()
+ * Lê um JSON gravado por este programa e associa cada valor ao resultado
+ * de mesmo nome. O arquivo tem um resultado por linha, então a leitura é
+ * feita linha a linha, sem um leitor de JSON completo.
+ * Parâmetros:
+ *   - lista: resultados atuais (recebem os valores da base)
+ *   - caminho: arquivo JSON da base
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro
+ */
+int carregarBase(ListaResultados *lista, const char *caminho) {
+    FILE *arquivo = fopen(caminho, "r");
+    if (arquivo == NULL) {
+        fprintf(stderr, "❌ Não foi possível abrir a base %s\n", caminho);
+        return 1;
+    }
+
+    char linha[512];
+    int encontrados = 0;
+    while (fgets(linha, sizeof(linha), arquivo) != NULL) {
+        char *campoNome = strstr(linha, "\"nome\": \"");
+        char *campoValor = strstr(linha, "\"valor\": ");
+        if (campoNome == NULL || campoValor == NULL) {
+            continue;
+        }
+        campoNome += strlen("\"nome\": \"");
+        char *fimNome = strchr(campoNome, '"');
+        if (fimNome == NULL) {
+            continue;
+        }
+        *fimNome = '\0';
+        double valor = strtod(campoValor + strlen("\"valor\": "), NULL);
+
+        for (int i = 0; i < lista->quantidade; i++) {
+            if (strcmp(lista->itens[i].nome, campoNome) == 0) {
+                lista->itens[i].temBase = 1;
+                lista->itens[i].base = valor;
+                encontrados++;
+            }
+        }
+    }
+    fclose(arquivo);
+
+    if (encontrados == 0) {
+        fprintf(stderr, "❌ %s não tem nenhum resultado em comum com esta execução\n", caminho);
+        return 1;
+    }
+    return 0;
+}
+
+// Variação do valor em relação à base, em %.
+static double variacao(const Resultado *resultado) {
+    if (resultado->base == 0.0) {
+        return 0.0;
+    }
+    return 100.0 * (resultado->valor - resultado->base) / resultado->base;
+}
+
+/**
+ * compararComBase()
+ * Mostra, na saída de erro, a variação de cada resultado em relação à base
+ * e marca como regressão o que piorou além da tolerância.
+ * Parâmetros:
+ *   - lista: resultados atuais, já com os valores da base
+ *   - tolerancia: piora máxima aceita, em %
+ * Retorna:
+ *   - 1 se algum resultado piorou além da tolerância, 0 caso contrário
+ */
+int compararComBase(ListaResultados *lista, double tolerancia) {
+    int regressoes = 0;
+    fprintf(stderr, "\nComparação com a base (tolerância de %.1f%%):\n", tolerancia);
+    for (int i = 0; i < lista->quantidade; i++) {
+        Resultado *resultado = &lista->itens[i];
+        if (!resultado->temBase) {
+            fprintf(stderr, "  %-32s (sem base)\n", resultado->nome);
+            continue;
+        }
+        // Para vazão, piorar é diminuir; para tempos, é aumentar
+        double pct = variacao(resultado);
+        double piora = resultado->maiorMelhor ? -pct : pct;
+        resultado->regrediu = piora > tolerancia;
+        regressoes += resultado->regrediu;
+        fprintf(stderr, "  %-32s %14.3f → %14.3f %-5s %+7.1f%% %s\n", resultado->nome, resultado->base,
+                resultado->valor, resultado->unidade, pct, resultado->regrediu ? "❌ REGRESSÃO" : "✓");
+    }
+    fprintf(stderr, "%d regressão(ões)\n", regressoes);
+    return regressoes > 0;
+}
+
+/**
+ * imprimirJSON()
+ * Escreve os resultados em JSON, um resultado por linha.
+ * Parâmetros:
+ *   - saida: arquivo de destino
+ *   - lista: resultados
+ */
+void imprimirJSON(FILE *saida, const ListaResultados *lista) {
+    fprintf(saida, "{\n  \"resultados\": [\n");
+    for (int i = 0; i < lista->quantidade; i++) {
+        const Resultado *resultado = &lista->itens[i];
+        fprintf(saida, "    {\"nome\": \"%s\", \"unidade\": \"%s\", \"valor\": %.10g, \"maior_melhor\": %s",
+                resultado->nome, resultado->unidade, resultado->valor, resultado->maiorMelhor ? "true" : "false");
+        if (resultado->temBase) {
+            fprintf(saida, ", \"base\": %.10g, \"variacao_pct\": %.2f, \"regressao\": %s",
+                    resultado->base, variacao(resultado), resultado->regrediu ? "true" : "false");
+        }
+        fprintf(saida, "}%s\n", i + 1 < lista->quantidade ? "," : "");
+    }
+    fprintf(saida, "  ]\n}\n");
+}
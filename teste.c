@@ -0,0 +1,1257 @@
+// ============================================================================
+//         PROJETO WAR ESTRUTURADO - TESTES DE COMPORTAMENTO
+// ============================================================================
+//
+// Confere, sem interação, os comportamentos de que as otimizações dependem:
+// - a mesma semente gera a mesma sequência de dados (e a mesma partida), e
+//   o lote de dados é uniforme
+// - os contadores por cor acompanham as conquistas, e a missão cumprida só
+//   é anunciada na conquista do jogador que a completa
+// - a tabela de batalha bate com uma estimativa de Monte Carlo rodada a
+//   rodada, e a batalha de um só sorteio segue a tabela
+// - a IA só escolhe ataques válidos e prefere a conquista garantida
+// - registrar uma partida e reproduzi-la chega ao mesmo mapa, inclusive
+//   quando a partida termina com jogadas desfeitas
+// - depois do primeiro quadro, o mapa só redesenha os territórios que
+//   mudaram (fora e dentro de um terminal)
+// - as mesmas linhas de várias sessões dão as mesmas partidas com uma ou
+//   várias threads
+// - as missões compilam para os IDs e índices do mapa, catálogos inválidos
+//   são recusados sem trocar o anterior, e verificarMissoes() concorda com
+//   verificarVitoria()
+// - os reforços e os contadores por região acompanham as conquistas, e uma
+//   missão pode pedir uma região do mapa pelo nome
+// - tirar um instantâneo, mudar o mapa e restaurá-lo é o mesmo que guardar
+//   uma cópia completa
+// - texto → binário → carregamento gera o mesmo mapa, e mapas malformados
+//   são recusados sem acesso fora dos vetores
+//
+// Uso:
+//   make test
+//
+// Cada verificação imprime uma linha (✓ ou ❌) na saída de erro; o programa
+// termina com código 1 se alguma falhar.
+//
+// ============================================================================
+
+#include "war.h"
+#include <stddef.h>
+
+// --- Constantes dos Testes ---
+#define DADOS_UNIFORMIDADE 600000
+#define LADO_GRADE 8
+#define NUM_CORES_GRADE 5
+#define BATALHAS_MONTE_CARLO 100000
+#define PARTIDAS_REGISTRADAS 20
+#define COMANDOS_POR_PARTIDA 400
+#define SESSOES_TESTE 200
+#define LINHAS_SESSOES 20000
+#define PASSOS_INSTANTANEOS 20000
+#define MAX_PILHA_INSTANTANEOS 16
+
+// --- Estrutura de Dados ---
+// Cópia completa guardada junto com o instantâneo tirado no mesmo momento.
+typedef struct {
+    Instantaneo instantaneo;
+    Mapa *copia;
+} Marca;
+
+// --- Variáveis Globais ---
+static int falhas = 0;
+
+// --- Protótipos das Funções ---
+void conferir(int condicao, const char *descricao);
+int criarArquivo(char caminho[], const char *conteudo);
+char* textoMapaGrade(int lado);
+Mapa* criarMapaPadrao(const char *missoes);
+int mesmoEstado(const Mapa *a, const Mapa *b);
+int mesmoEstadoCompleto(const Mapa *a, const Mapa *b);
+int mesmoMapa(const Mapa *a, const Mapa *b);
+int pertoDaEstimativa(double estimada, double exata, double variancia);
+void testarSemente(void);
+void testarMissoesIncrementais(void);
+void testarMapaBinario(const char *caminhoMapa);
+void testarMapasMalformados(const char *caminhoMapa);
+void testarTabelaBatalha(void);
+void testarEscolhaIA(void);
+void testarRegistro(const char *caminhoMapa);
+int quadroContem(const Tela *tela, const char *texto);
+void testarTelaIncremental(void);
+char* saidaSessoes(const Mapa *modelo, const char *caminhoComandos, int numThreads);
+void testarSessoes(const char *caminhoMapa);
+void testarCompilacaoMissoes(void);
+void testarReforcos(const char *caminhoMapa);
+void testarInstantaneos(const char *caminhoMapa);
+
+// --- Função Principal (main) ---
+int main(void) {
+    char *texto = textoMapaGrade(LADO_GRADE);
+    char caminhoMapa[] = "/tmp/war_teste_mapa_XXXXXX";
+    if (texto == NULL || criarArquivo(caminhoMapa, texto) != 0) {
+        fprintf(stderr, "❌ Não foi possível criar o mapa de teste\n");
+        free(texto);
+        return 1;
+    }
+    free(texto);
+
+    // O jogo escreve na saída padrão (inclusive as recusas esperadas dos
+    // mapas malformados): durante os testes ela vai para /dev/null
+    fflush(stdout);
+    int saidaOriginal = dup(STDOUT_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+    if (saidaOriginal < 0 || nulo < 0 || dup2(nulo, STDOUT_FILENO) < 0) {
+        fprintf(stderr, "❌ Não foi possível redirecionar a saída padrão\n");
+        unlink(caminhoMapa);
+        return 1;
+    }
+    close(nulo);
+
+    testarSemente();
+    testarMissoesIncrementais();
+    testarMapaBinario(caminhoMapa);
+    testarMapasMalformados(caminhoMapa);
+    testarTabelaBatalha();
+    testarEscolhaIA();
+    testarRegistro(caminhoMapa);
+    testarTelaIncremental();
+    testarSessoes(caminhoMapa);
+    testarCompilacaoMissoes();
+    testarReforcos(caminhoMapa);
+    testarInstantaneos(caminhoMapa);
+
+    fflush(stdout);
+    dup2(saidaOriginal, STDOUT_FILENO);
+    close(saidaOriginal);
+    unlink(caminhoMapa);
+
+    if (falhas > 0) {
+        fprintf(stderr, "\n❌ %d verificação(ões) falharam\n", falhas);
+        return 1;
+    }
+    fprintf(stderr, "\n✓ Todas as verificações passaram\n");
+    return 0;
+}
+
+// --- Implementação das Funções ---
+
+/**
+ * conferir()
+ * Registra o resultado de uma verificação.
+ * Parâmetros:
+ *   - condicao: verdadeira se o comportamento está correto
+ *   - descricao: o que foi verificado
+ */
+void conferir(int condicao, const char *descricao) {
+    fprintf(stderr, "%s %s\n", condicao ? "✓" : "❌", descricao);
+    if (!condicao) {
+        falhas++;
+    }
+}
+
+/**
+ * criarArquivo()
+ * Cria um arquivo temporário com o conteúdo dado.
+ * Parâmetros:
+ *   - caminho: modelo terminado em XXXXXX (recebe o nome criado)
+ *   - conteudo: texto gravado no arquivo
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro
+ */
+int criarArquivo(char caminho[], const char *conteudo) {
+    int descritor = mkstemp(caminho);
+    if (descritor < 0) {
+        return 1;
+    }
+    size_t tamanho = strlen(conteudo);
+    int status = write(descritor, conteudo, tamanho) == (ssize_t) tamanho ? 0 : 1;
+    close(descritor);
+    if (status != 0) {
+        unlink(caminho);
+    }
+    return status;
+}
+
+/**
+ * textoMapaGrade()
+ * Monta um mapa de texto em grade lado x lado, com as cores em faixas, uma
+ * região por linha da grade (menos a última, que fica sem região) e alguns
+ * registros indentados, que o carregador precisa contar como os demais.
+ * Parâmetros:
+ *   - lado: territórios em cada linha e coluna da grade
+ * Retorna:
+ *   - Texto alocado com malloc (ou NULL em caso de falha de memória)
+ */
+char* textoMapaGrade(int lado) {
+    static const char *cores[NUM_CORES_GRADE] = {"Azul", "Verde", "Vermelho", "Amarelo", "Preto"};
+    size_t capacidade = (size_t) lado * lado * 96 + 256;
+    char *texto = (char*) malloc(capacidade);
+    if (texto == NULL) {
+        return NULL;
+    }
+
+    size_t tamanho = (size_t) snprintf(texto, capacidade, "# Mapa em grade dos testes\n");
+    for (int i = 0; i < lado * lado; i++) {
+        tamanho += (size_t) snprintf(texto + tamanho, capacidade - tamanho, "%sterritorio;T%d;%s;%d\n",
+                                     (i % 7 == 3) ? "  " : "", i, cores[(i / 3) % NUM_CORES_GRADE], 1 + i % 4);
+    }
+    for (int i = 0; i < lado * lado; i++) {
+        if (i % lado + 1 < lado) {
+            tamanho += (size_t) snprintf(texto + tamanho, capacidade - tamanho, "%sfronteira;T%d;T%d\n",
+                                         (i % 5 == 2) ? "\t" : "", i, i + 1);
+        }
+        if (i + lado < lado * lado) {
+            tamanho += (size_t) snprintf(texto + tamanho, capacidade - tamanho, "fronteira ;T%d;T%d\n", i, i + lado);
+        }
+    }
+    for (int linha = 0; linha + 1 < lado; linha++) {
+        tamanho += (size_t) snprintf(texto + tamanho, capacidade - tamanho, "regiao;Linha %d;%d;", linha, 1 + linha % 3);
+        for (int coluna = 0; coluna < lado; coluna++) {
+            tamanho += (size_t) snprintf(texto + tamanho, capacidade - tamanho, "%sT%d",
+                                         coluna ? "," : "", linha * lado + coluna);
+        }
+        tamanho += (size_t) snprintf(texto + tamanho, capacidade - tamanho, "\n");
+    }
+    return texto;
+}
+
+/**
+ * criarMapaPadrao()
+ * Monta o mapa padrão de 5 territórios, com um catálogo de missões.
+ * Parâmetros:
+ *   - missoes: definições das missões, ou NULL para o catálogo padrão
+ * Retorna:
+ *   - O mapa, ou NULL em caso de erro
+ */
+Mapa* criarMapaPadrao(const char *missoes) {
+    Mapa *mapa = alocarMapa(NUM_TERRITORIOS);
+    if (mapa == NULL || inicializarTerritorios(mapa) != 0) {
+        liberarMemoria(mapa);
+        return NULL;
+    }
+    int status = (missoes != NULL) ? compilarMissoesTexto(mapa, missoes, "teste") : compilarMissoes(mapa, NULL);
+    if (status != 0) {
+        liberarMemoria(mapa);
+        return NULL;
+    }
+    return mapa;
+}
+
+/**
+ * mesmoEstado()
+ * Compara o que define uma posição do jogo: donos e tropas, e os contadores
+ * que não dependem da ordem das listas de fronteira.
+ * Retorna:
+ *   - 1 se os dois mapas estão na mesma posição
+ */
+int mesmoEstado(const Mapa *a, const Mapa *b) {
+    int n = a->quantidade;
+    return n == b->quantidade
+        && memcmp(a->cor, b->cor, (size_t) n * sizeof(IdCor)) == 0
+        && memcmp(a->tropas, b->tropas, (size_t) n * sizeof(int32_t)) == 0
+        && memcmp(a->territoriosPorCor, b->territoriosPorCor, sizeof(a->territoriosPorCor)) == 0
+        && memcmp(a->numFronteiras, b->numFronteiras, sizeof(a->numFronteiras)) == 0
+        && memcmp(a->regioesPorCor, b->regioesPorCor, sizeof(a->regioesPorCor)) == 0
+        && memcmp(a->bonusPorCor, b->bonusPorCor, sizeof(a->bonusPorCor)) == 0;
+}
+
+/**
+ * mesmoEstadoCompleto()
+ * Compara todo o estado dinâmico, inclusive a ordem das listas de
+ * fronteira: um instantâneo restaurado precisa ser idêntico byte a byte.
+ * Retorna:
+ *   - 1 se os dois mapas têm o mesmo estado
+ */
+int mesmoEstadoCompleto(const Mapa *a, const Mapa *b) {
+    int n = a->quantidade;
+    if (!mesmoEstado(a, b)
+        || memcmp(a->vizinhosInimigos, b->vizinhosInimigos, (size_t) n * sizeof(int32_t)) != 0
+        || memcmp(a->posicaoFronteira, b->posicaoFronteira, (size_t) n * sizeof(int32_t)) != 0) {
+        return 0;
+    }
+    for (int c = 0; c < a->cores->quantidade; c++) {
+        if (memcmp(a->fronteiras + (size_t) c * n, b->fronteiras + (size_t) c * n,
+                   (size_t) a->numFronteiras[c] * sizeof(int32_t)) != 0) {
+            return 0;
+        }
+    }
+    size_t contagens = (size_t) a->cores->quantidade * a->numRegioes;
+    return a->numRegioes == 0
+        || memcmp(a->territoriosPorRegiao, b->territoriosPorRegiao, contagens * sizeof(int32_t)) == 0;
+}
+
+/**
+ * mesmoMapa()
+ * Compara dois mapas carregados: nomes, cores, fronteiras, regiões e estado.
+ * Retorna:
+ *   - 1 se os mapas são iguais
+ */
+int mesmoMapa(const Mapa *a, const Mapa *b) {
+    int n = a->quantidade;
+    if (n != b->quantidade || a->cores->quantidade != b->cores->quantidade || a->numRegioes != b->numRegioes
+        || a->inicioVizinhos[n] != b->inicioVizinhos[n] || !mesmoEstado(a, b)) {
+        return 0;
+    }
+    int iguais = memcmp(a->inicioVizinhos, b->inicioVizinhos, (size_t) (n + 1) * sizeof(uint32_t)) == 0
+              && memcmp(a->vizinhos, b->vizinhos, (size_t) a->inicioVizinhos[n] * sizeof(uint32_t)) == 0;
+    for (int i = 0; iguais && i < n; i++) {
+        iguais = strcmp(nomeTerritorio(a, i), nomeTerritorio(b, i)) == 0;
+    }
+    for (int c = 0; iguais && c < a->cores->quantidade; c++) {
+        iguais = strcmp(nomeCor(a, (IdCor) c), nomeCor(b, (IdCor) c)) == 0;
+    }
+    if (iguais && a->numRegioes > 0) {
+        iguais = memcmp(a->regiaoDe, b->regiaoDe, (size_t) n * sizeof(int32_t)) == 0
+              && memcmp(a->tamanhoRegiao, b->tamanhoRegiao, (size_t) a->numRegioes * sizeof(int32_t)) == 0
+              && memcmp(a->bonusRegiao, b->bonusRegiao, (size_t) a->numRegioes * sizeof(int32_t)) == 0;
+    }
+    for (int r = 0; iguais && r < a->numRegioes; r++) {
+        iguais = strcmp(textoDe(a->regioes, r), textoDe(b->regioes, r)) == 0;
+    }
+    return iguais;
+}
+
+/**
+ * testarSemente()
+ * A mesma semente repete os dados, o lote de dados e a partida inteira;
+ * outra semente não. O lote de rolarDados() precisa ser uniforme.
+ */
+void testarSemente(void) {
+    GeradorAleatorio a, b, c;
+    semearGerador(&a, 42);
+    semearGerador(&b, 42);
+    semearGerador(&c, 43);
+    int iguais = 1, diferentes = 0;
+    for (int i = 0; i < 10000; i++) {
+        int dado = rolarDado(&a);
+        iguais = iguais && dado == rolarDado(&b) && dado >= 1 && dado <= 6;
+        diferentes += dado != rolarDado(&c);
+    }
+    conferir(iguais, "semente: a mesma semente gera a mesma sequência de dados");
+    conferir(diferentes > 0, "semente: outra semente gera outra sequência");
+
+    uint8_t *lote = (uint8_t*) malloc(DADOS_UNIFORMIDADE);
+    uint8_t *repeticao = (uint8_t*) malloc(DADOS_UNIFORMIDADE);
+    long long faces[7] = {0};
+    int repetiu = 0, validos = 0;
+    if (lote != NULL && repeticao != NULL) {
+        semearGerador(&a, 7);
+        semearGerador(&b, 7);
+        rolarDados(&a, lote, DADOS_UNIFORMIDADE);
+        rolarDados(&b, repeticao, DADOS_UNIFORMIDADE);
+        repetiu = memcmp(lote, repeticao, DADOS_UNIFORMIDADE) == 0;
+        validos = 1;
+        for (int i = 0; i < DADOS_UNIFORMIDADE; i++) {
+            validos = validos && lote[i] >= 1 && lote[i] <= 6;
+            faces[lote[i] <= 6 ? lote[i] : 0]++;
+        }
+    }
+    // Cada face perto de 1/6 (o desvio padrão da contagem é ~0,05% do total)
+    int uniforme = validos;
+    for (int face = 1; face <= 6; face++) {
+        double fracao = (double) faces[face] / DADOS_UNIFORMIDADE;
+        uniforme = uniforme && fracao > 1.0 / 6 - 0.003 && fracao < 1.0 / 6 + 0.003;
+    }
+    conferir(repetiu, "semente: o lote de dados se repete com a mesma semente");
+    conferir(uniforme, "semente: o lote de dados tem faces de 1 a 6 uniformes");
+    free(lote);
+    free(repeticao);
+
+    Mapa *modelo = criarMapaPadrao(NULL);
+    Mapa *partidas[2] = {NULL, NULL};
+    Ataque *ataques = (modelo != NULL) ? (Ataque*) malloc((size_t) limiteAtaques(modelo) * sizeof(Ataque)) : NULL;
+    int vitorias[2] = {0, 0}, turnos[2] = {0, 0};
+    if (ataques != NULL) {
+        for (int p = 0; p < 2; p++) {
+            partidas[p] = clonarMapa(modelo);
+            GeradorAleatorio gerador;
+            semearGerador(&gerador, 1234);
+            if (partidas[p] != NULL) {
+                int missao = sortearMissao(partidas[p], &gerador);
+                vitorias[p] = jogarPartidaAutomatica(partidas[p], missao, 0, 1, &gerador, ataques, &turnos[p]);
+            }
+        }
+    }
+    conferir(partidas[0] != NULL && partidas[1] != NULL && vitorias[0] == vitorias[1] && turnos[0] == turnos[1]
+             && mesmoEstado(partidas[0], partidas[1]),
+             "semente: a mesma semente joga a mesma partida automática");
+    free(ataques);
+    liberarMemoria(partidas[0]);
+    liberarMemoria(partidas[1]);
+    liberarMemoria(modelo);
+}
+
+/**
+ * testarMissoesIncrementais()
+ * Depois de conquistas sorteadas, os contadores por cor e as missões
+ * verificadas em O(1) batem com uma contagem do mapa inteiro. A missão
+ * cumprida só é anunciada na conquista do jogador que a completa: nem nas
+ * seguintes, nem quando a conquista de outro exército a cumpre.
+ */
+void testarMissoesIncrementais(void) {
+    Mapa *mapa = criarMapaPadrao(NULL);
+    int coincidem = mapa != NULL;
+    GeradorAleatorio gerador;
+    semearGerador(&gerador, 5);
+    for (int passo = 0; coincidem && passo < 2000; passo++) {
+        int territorio = (int) sortearIntervalo(&gerador, (uint32_t) mapa->quantidade);
+        IdCor cor = (IdCor) sortearIntervalo(&gerador, (uint32_t) mapa->cores->quantidade);
+        transferirTerritorio(mapa, territorio, cor);
+        for (int c = 0; c < mapa->cores->quantidade; c++) {
+            int contagem = 0;
+            for (int i = 0; i < mapa->quantidade; i++) {
+                contagem += mapa->cor[i] == c;
+            }
+            Objetivo eliminar = {.idMissao = 1, .tipo = MISSAO_ELIMINAR, .corJogador = 0, .corAlvo = (IdCor) c};
+            Objetivo dominar = {.idMissao = 2, .tipo = MISSAO_TERRITORIOS, .corJogador = (IdCor) c,
+                                .territoriosMinimos = 3};
+            coincidem = coincidem && contagem == contarTerritoriosDaCor(mapa, (IdCor) c)
+                     && verificarVitoria(mapa, &eliminar) == (contagem == 0)
+                     && verificarVitoria(mapa, &dominar) == (contagem >= 3);
+        }
+    }
+    conferir(coincidem, "missões: contadores por cor e verificação em O(1) batem com o mapa inteiro");
+    liberarMemoria(mapa);
+
+    // Mapa padrão: Brasil (0, Azul) faz fronteira com Argentina (1, Verde),
+    // Peru (2, Vermelho) e Colômbia (3, Verde); Colômbia faz fronteira com Peru
+    mapa = criarMapaPadrao("missao;territorios;2;Dois territórios;\n"
+                           "missao;eliminar;Vermelho;Sem vermelho;\n");
+    if (mapa == NULL) {
+        conferir(0, "missões: preparação do mapa padrão");
+        return;
+    }
+    IdCor azul = buscarCor(mapa, "Azul");
+    Objetivo dois = prepararObjetivo(mapa, 1, azul);
+    mapa->tropas[1] = 1;
+    mapa->tropas[3] = 1;
+    ResultadoAtaque primeira = resolverAtaque(mapa, 0, 1, 6, 1, &dois);
+    ResultadoAtaque segunda = resolverAtaque(mapa, 0, 3, 6, 1, &dois);
+    conferir(primeira == ATAQUE_MISSAO_CUMPRIDA && segunda == ATAQUE_CONQUISTA,
+             "missões: só a conquista que completa a missão a anuncia");
+
+    // Conquista de outro exército que cumpre a missão do jogador: não é anunciada
+    Objetivo semVermelho = prepararObjetivo(mapa, 2, azul);
+    transferirTerritorio(mapa, 3, buscarCor(mapa, "Verde"));
+    mapa->tropas[3] = 3;
+    mapa->tropas[2] = 1;
+    ResultadoAtaque alheia = resolverAtaque(mapa, 3, 2, 6, 1, &semVermelho);
+    conferir(alheia == ATAQUE_CONQUISTA && verificarVitoria(mapa, &semVermelho),
+             "missões: a conquista de outro exército não anuncia a missão do jogador");
+    liberarMemoria(mapa);
+}
+
+/**
+ * testarMapaBinario()
+ * Converte o mapa de texto para binário e o carrega de volta: os dois
+ * precisam ser iguais, inclusive as regiões.
+ */
+void testarMapaBinario(const char *caminhoMapa) {
+    char caminhoBinario[] = "/tmp/war_teste_binario_XXXXXX";
+    int descritor = mkstemp(caminhoBinario);
+    if (descritor < 0) {
+        conferir(0, "mapa binário: criação do arquivo temporário");
+        return;
+    }
+    close(descritor);
+
+    Mapa *texto = carregarMapaTexto(caminhoMapa);
+    int salvo = texto != NULL && salvarMapaBinario(texto, caminhoBinario) == 0;
+    Mapa *binario = salvo ? mapearMapaBinario(caminhoBinario) : NULL;
+    Mapa *detectado = salvo ? carregarMapa(caminhoBinario) : NULL;
+    conferir(texto != NULL && texto->quantidade == LADO_GRADE * LADO_GRADE && texto->numRegioes == LADO_GRADE - 1,
+             "mapa de texto: registros indentados são contados e carregados");
+    conferir(binario != NULL && mesmoMapa(texto, binario), "mapa binário: texto → binário → carregamento é igual");
+    conferir(detectado != NULL && mesmoMapa(texto, detectado), "mapa binário: carregarMapa() reconhece o formato");
+
+    liberarMemoria(detectado);
+    liberarMemoria(binario);
+    liberarMemoria(texto);
+    unlink(caminhoBinario);
+}
+
+/**
+ * testarMapasMalformados()
+ * Mapas de texto e binários inválidos precisam ser recusados (NULL), sem
+ * escrever fora dos vetores nem travar no índice de nomes.
+ */
+void testarMapasMalformados(const char *caminhoMapa) {
+    static const struct {
+        const char *descricao;
+        const char *conteudo;
+    } casos[] = {
+        {"tropas < 1", "territorio;A;Azul;0\nterritorio;B;Verde;1\n"},
+        {"território repetido", "territorio;A;Azul;1\n  territorio ; A ;Verde;1\n"},
+        {"fronteira inexistente", "territorio;A;Azul;1\nterritorio;B;Verde;1\n\tfronteira;A;C\n"},
+        {"fronteira consigo mesmo", "territorio;A;Azul;1\n fronteira;A;A\n"},
+        {"fronteira repetida", "territorio;A;Azul;1\nterritorio;B;Verde;1\nfronteira;A;B\nfronteira; A ;B\n"},
+        {"fronteira invertida", "territorio;A;Azul;1\nterritorio;B;Verde;1\nterritorio;C;Verde;1\n"
+                                "fronteira;A;B\nfronteira;B;C\nfronteira;B;A\n"},
+        {"tipo desconhecido", "territorio;A;Azul;1\nterritorios;B;Verde;1\n"},
+        {"sem territórios", "# vazio\nfronteira;A;B\n"},
+        {"região repetida", "territorio;A;Azul;1\nterritorio;B;Verde;1\nregiao;R;2;A\nregiao;R;3;B\n"},
+        {"território em duas regiões", "territorio;A;Azul;1\nterritorio;B;Verde;1\nregiao;R;2;A,B\nregiao;S;2;B\n"},
+        {"região com território inexistente", "territorio;A;Azul;1\nregiao;R;2;A,C\n"},
+    };
+    int recusados = 0;
+    int numCasos = (int) (sizeof(casos) / sizeof(casos[0]));
+    for (int i = 0; i < numCasos; i++) {
+        char caminho[] = "/tmp/war_teste_malformado_XXXXXX";
+        if (criarArquivo(caminho, casos[i].conteudo) != 0) {
+            continue;
+        }
+        Mapa *mapa = carregarMapaTexto(caminho);
+        if (mapa == NULL) {
+            recusados++;
+        } else {
+            fprintf(stderr, "   aceito por engano: %s\n", casos[i].descricao);
+            liberarMemoria(mapa);
+        }
+        unlink(caminho);
+    }
+    conferir(recusados == numCasos, "mapa de texto: registros malformados são recusados");
+
+    // Um pipe não tem tamanho: o carregador recusa em vez de ler com tamanho -1
+    int canos[2];
+    Mapa *doPipe = NULL;
+    int recusouPipe = 0;
+    if (pipe(canos) == 0) {
+        char caminhoPipe[32];
+        snprintf(caminhoPipe, sizeof(caminhoPipe), "/dev/fd/%d", canos[0]);
+        const char *valido = "territorio;A;Azul;1\n";
+        int escrito = write(canos[1], valido, strlen(valido)) > 0;
+        close(canos[1]);
+        doPipe = escrito ? carregarMapaTexto(caminhoPipe) : NULL;
+        recusouPipe = escrito && doPipe == NULL;
+        close(canos[0]);
+    }
+    liberarMemoria(doPipe);
+    conferir(recusouPipe, "mapa de texto: um pipe é recusado com uma mensagem clara");
+
+    // Corrompe cópias de um binário válido em cada invariante que o texto garante
+    char caminhoBinario[] = "/tmp/war_teste_corrompido_XXXXXX";
+    int descritor = mkstemp(caminhoBinario);
+    Mapa *texto = (descritor >= 0) ? carregarMapaTexto(caminhoMapa) : NULL;
+    if (descritor >= 0) {
+        close(descritor);
+    }
+    int salvo = texto != NULL && salvarMapaBinario(texto, caminhoBinario) == 0;
+    liberarMemoria(texto);
+    FILE *arquivo = salvo ? fopen(caminhoBinario, "rb") : NULL;
+    char *original = NULL;
+    long tamanho = 0;
+    if (arquivo != NULL) {
+        fseek(arquivo, 0, SEEK_END);
+        tamanho = ftell(arquivo);
+        fseek(arquivo, 0, SEEK_SET);
+        original = (char*) malloc((size_t) tamanho);
+        if (original != NULL && fread(original, 1, (size_t) tamanho, arquivo) != (size_t) tamanho) {
+            free(original);
+            original = NULL;
+        }
+        fclose(arquivo);
+    }
+    unlink(caminhoBinario);
+    if (original == NULL) {
+        conferir(0, "mapa binário: preparação dos arquivos corrompidos");
+        return;
+    }
+
+    CabecalhoMapa cabecalho;
+    memcpy(&cabecalho, original, sizeof(cabecalho));
+    int32_t zero = 0, grande = 1000;
+    uint32_t mesmo = 0;
+    struct {
+        const char *descricao;
+        uint64_t deslocamento;
+        const void *valor;
+        size_t bytes;
+    } corrupcoes[] = {
+        {"tropas < 1", cabecalho.secaoTropas, &zero, sizeof(zero)},
+        {"tamanho de região", cabecalho.secaoTamanhoRegioes, &grande, sizeof(grande)},
+        {"fronteira consigo mesmo", cabecalho.secaoVizinhos, &mesmo, sizeof(mesmo)},
+        {"fronteira repetida", cabecalho.secaoVizinhos + sizeof(uint32_t), original + cabecalho.secaoVizinhos,
+         sizeof(uint32_t)},
+        {"nome repetido", cabecalho.secaoNomes + sizeof(uint32_t), original + cabecalho.secaoNomes, sizeof(uint32_t)},
+        {"número de territórios", offsetof(CabecalhoMapa, numTerritorios), &grande, sizeof(grande)},
+    };
+    recusados = 0;
+    int numCorrupcoes = (int) (sizeof(corrupcoes) / sizeof(corrupcoes[0]));
+    for (int i = 0; i < numCorrupcoes; i++) {
+        char *corrompido = (char*) malloc((size_t) tamanho);
+        char caminho[] = "/tmp/war_teste_corrompido_XXXXXX";
+        descritor = (corrompido != NULL) ? mkstemp(caminho) : -1;
+        if (descritor < 0) {
+            free(corrompido);
+            continue;
+        }
+        memcpy(corrompido, original, (size_t) tamanho);
+        memcpy(corrompido + corrupcoes[i].deslocamento, corrupcoes[i].valor, corrupcoes[i].bytes);
+        int gravado = write(descritor, corrompido, (size_t) tamanho) == (ssize_t) tamanho;
+        close(descritor);
+        free(corrompido);
+
+        Mapa *mapa = gravado ? mapearMapaBinario(caminho) : NULL;
+        if (gravado && mapa == NULL) {
+            recusados++;
+        } else if (mapa != NULL) {
+            fprintf(stderr, "   aceito por engano: %s\n", corrupcoes[i].descricao);
+            liberarMemoria(mapa);
+        }
+        unlink(caminho);
+    }
+    free(original);
+    conferir(recusados == numCorrupcoes, "mapa binário: arquivos que quebram os invariantes são recusados");
+}
+
+/**
+ * pertoDaEstimativa()
+ * Diz se uma média de BATALHAS_MONTE_CARLO amostras está a no máximo 5
+ * desvios padrão do valor exato (compara os quadrados, sem libm).
+ * Parâmetros: estimada, exata, variancia de uma amostra
+ */
+int pertoDaEstimativa(double estimada, double exata, double variancia) {
+    double diferenca = estimada - exata;
+    return diferenca * diferenca <= 25 * variancia / BATALHAS_MONTE_CARLO + 1e-12;
+}
+
+/**
+ * testarTabelaBatalha()
+ * Compara a tabela exata de batalha com batalhas jogadas rodada a rodada
+ * (chance de conquista e perda média do defensor) e com resolverBatalha(),
+ * que resolve a batalha inteira com um só sorteio. As tolerâncias são de
+ * 5 desvios padrão da estimativa.
+ */
+void testarTabelaBatalha(void) {
+    static const int casos[][2] = {{1, 1}, {2, 5}, {3, 10}, {5, 10}, {8, 30}, {4, MAX_RODADAS_BATALHA}};
+    int numCasos = (int) (sizeof(casos) / sizeof(casos[0]));
+    GeradorAleatorio gerador;
+    semearGerador(&gerador, 2024);
+
+    int chancesBatem = 1, perdasBatem = 1;
+    for (int c = 0; c < numCasos; c++) {
+        int tropas = casos[c][0], rodadas = casos[c][1];
+        long long conquistas = 0;
+        double soma = 0, somaQuadrados = 0;
+        for (int b = 0; b < BATALHAS_MONTE_CARLO; b++) {
+            int perdas = 0;
+            for (int r = 0; r < rodadas && perdas < tropas; r++) {
+                int dadoAtacante = rolarDado(&gerador);
+                perdas += dadoAtacante > rolarDado(&gerador);
+            }
+            conquistas += perdas == tropas;
+            soma += perdas;
+            somaQuadrados += (double) perdas * perdas;
+        }
+        double chance = chanceConquista(tropas, rodadas);
+        double estimada = (double) conquistas / BATALHAS_MONTE_CARLO;
+        double media = soma / BATALHAS_MONTE_CARLO;
+        double variancia = somaQuadrados / BATALHAS_MONTE_CARLO - media * media;
+        chancesBatem = chancesBatem && pertoDaEstimativa(estimada, chance, chance * (1 - chance));
+        perdasBatem = perdasBatem && pertoDaEstimativa(media, perdasEsperadas(tropas, rodadas), variancia);
+    }
+    conferir(chancesBatem, "batalha: chance de conquista da tabela bate com Monte Carlo");
+    conferir(perdasBatem, "batalha: perda média do defensor bate com Monte Carlo");
+    conferir(pertoDaEstimativa(rodadasEsperadasConquista(3), 3 * 36.0 / 15, 0),
+             "batalha: rodadas médias até a conquista = tropas / (15/36)");
+
+    // resolverBatalha(): Brasil (0) contra Peru (2) no mapa padrão, sempre
+    // partindo do mesmo estado
+    Mapa *modelo = criarMapaPadrao(NULL);
+    Mapa *mapa = (modelo != NULL) ? clonarMapa(modelo) : NULL;
+    int sorteioBate = mapa != NULL;
+    for (int c = 0; sorteioBate && c < numCasos; c++) {
+        int tropas = casos[c][0], rodadas = casos[c][1];
+        long long conquistas = 0;
+        for (int b = 0; b < BATALHAS_MONTE_CARLO; b++) {
+            copiarEstadoMapa(mapa, modelo);
+            mapa->tropas[0] = 100;
+            mapa->tropas[2] = tropas;
+            ResultadoAtaque resultado = resolverBatalha(mapa, 0, 2, rodadas, &gerador, NULL);
+            conquistas += resultado == ATAQUE_CONQUISTA;
+        }
+        double chance = chanceConquista(tropas, rodadas);
+        double estimada = (double) conquistas / BATALHAS_MONTE_CARLO;
+        sorteioBate = pertoDaEstimativa(estimada, chance, chance * (1 - chance));
+    }
+    conferir(sorteioBate, "batalha: resolverBatalha() conquista com a chance da tabela");
+    liberarMemoria(mapa);
+    liberarMemoria(modelo);
+}
+
+/**
+ * testarEscolhaIA()
+ * Em estados sorteados do mapa padrão, a jogada da IA de cada cor precisa
+ * estar entre os ataques válidos da cor (ou a IA precisa dizer que não há
+ * nenhum). Depois, com uma conquista garantida ao lado de dois ataques sem
+ * chance, tanto a pré-seleção (sem orçamento) quanto a busca a escolhem.
+ */
+void testarEscolhaIA(void) {
+    Mapa *mapa = criarMapaPadrao(NULL);
+    MotorIA *motor = (mapa != NULL) ? criarMotorIA(mapa, 2, 1, 7) : NULL;
+    Ataque *ataques = (mapa != NULL) ? (Ataque*) malloc((limiteAtaques(mapa) + 1) * sizeof(Ataque)) : NULL;
+    if (motor == NULL || ataques == NULL) {
+        conferir(0, "IA: preparação do motor");
+        free(ataques);
+        destruirMotorIA(motor);
+        liberarMemoria(mapa);
+        return;
+    }
+
+    GeradorAleatorio gerador;
+    semearGerador(&gerador, 11);
+    int validas = 1;
+    for (int estado = 0; validas && estado < 50; estado++) {
+        for (int i = 0; i < mapa->quantidade; i++) {
+            transferirTerritorio(mapa, i, (IdCor) sortearIntervalo(&gerador, (uint32_t) mapa->cores->quantidade));
+            mapa->tropas[i] = 1 + (int) sortearIntervalo(&gerador, 6);
+        }
+        for (int c = 0; validas && c < mapa->cores->quantidade; c++) {
+            int total = listarAtaques(mapa, (IdCor) c, ataques, limiteAtaques(mapa));
+            Ataque jogada;
+            long long simulacoes = escolherJogadaIA(motor, mapa, (IdCor) c, &jogada);
+            int encontrada = 0;
+            for (int a = 0; simulacoes >= 0 && a < total; a++) {
+                encontrada |= ataques[a].atacante == jogada.atacante && ataques[a].defensor == jogada.defensor;
+            }
+            validas = (total == 0) ? simulacoes == -1 : encontrada;
+        }
+    }
+    conferir(validas, "IA: a jogada escolhida está sempre entre os ataques válidos da cor");
+    free(ataques);
+    destruirMotorIA(motor);
+    liberarMemoria(mapa);
+
+    // Brasil (Azul) contra Argentina com 1 tropa, Peru e Colômbia com 60
+    mapa = criarMapaPadrao(NULL);
+    if (mapa == NULL) {
+        conferir(0, "IA: preparação do mapa padrão");
+        return;
+    }
+    mapa->tropas[0] = 30;
+    mapa->tropas[1] = 1;
+    mapa->tropas[2] = 60;
+    mapa->tropas[3] = 60;
+    IdCor azul = buscarCor(mapa, "Azul");
+    int preferem = 1;
+    for (int orcamento = 0; orcamento <= 5; orcamento += 5) {
+        motor = criarMotorIA(mapa, 2, orcamento, 3);
+        Ataque jogada = {-1, -1};
+        long long simulacoes = (motor != NULL) ? escolherJogadaIA(motor, mapa, azul, &jogada) : -1;
+        preferem = preferem && simulacoes >= 0 && jogada.atacante == 0 && jogada.defensor == 1
+                && (orcamento == 0) == (simulacoes == 0);
+        destruirMotorIA(motor);
+    }
+    conferir(preferem, "IA: com ou sem busca, prefere a conquista garantida");
+    liberarMemoria(mapa);
+}
+
+/**
+ * testarRegistro()
+ * Joga partidas pelo modo de comandos, com ataques, reforços, fins de turno
+ * e jogadas desfeitas, gravando o registro; reproduzir o registro até o fim
+ * precisa chegar ao mesmo mapa da partida.
+ */
+void testarRegistro(const char *caminhoMapa) {
+    int reproduzidas = 0, desfeitas = 0, terminadasDesfazendo = 0;
+    Ataque *ataques = NULL;
+
+    for (int p = 0; p < PARTIDAS_REGISTRADAS; p++) {
+        char caminhoRegistro[] = "/tmp/war_teste_registro_XXXXXX";
+        int descritor = mkstemp(caminhoRegistro);
+        if (descritor < 0) {
+            break;
+        }
+        close(descritor);
+
+        uint64_t semente = 1000 + (uint64_t) p;
+        Mapa *mapa = carregarMapaTexto(caminhoMapa);
+        Tela *tela = criarTela(1);
+        if (mapa == NULL || tela == NULL || compilarMissoes(mapa, NULL) != 0 || iniciarDiario(mapa) != 0) {
+            liberarMemoria(mapa);
+            liberarTela(tela);
+            unlink(caminhoRegistro);
+            break;
+        }
+        free(ataques);
+        ataques = (Ataque*) malloc((size_t) limiteAtaques(mapa) * sizeof(Ataque));
+
+        Partida partida;
+        HistoricoDesfazer historico;
+        memset(&partida, 0, sizeof(partida));
+        memset(&historico, 0, sizeof(historico));
+        IdCor corJogador = (IdCor) (p % NUM_CORES_GRADE);
+        semearGerador(&partida.gerador, semente);
+        partida.mapa = mapa;
+        partida.tela = tela;
+        partida.historico = &historico;
+        partida.registro = abrirRegistro(caminhoRegistro, mapa, semente);
+        int missao = sortearMissao(mapa, &partida.gerador);
+        partida.objetivo = prepararObjetivo(mapa, missao, corJogador);
+        registrarMissao(partida.registro, missao, corJogador);
+        partida.reforcos = calcularReforcos(mapa, corJogador);
+
+        // Roteiro sorteado com um gerador próprio, separado dos dados da partida
+        GeradorAleatorio roteiro;
+        semearGerador(&roteiro, semente * 7919);
+        ResumoComandos resumo;
+        memset(&resumo, 0, sizeof(resumo));
+        int ultimoDesfez = 0;
+        for (int i = 0; ataques != NULL && partida.registro != NULL && i < COMANDOS_POR_PARTIDA; i++) {
+            char linha[64];
+            uint32_t sorteio = sortearIntervalo(&roteiro, 10);
+            int numAtaques = listarAtaques(mapa, corJogador, ataques, limiteAtaques(mapa));
+            if (i == COMANDOS_POR_PARTIDA - 1 || sorteio >= 8) {
+                snprintf(linha, sizeof(linha), "desfazer");
+            } else if (sorteio <= 4 && numAtaques > 0) {
+                const Ataque *ataque = &ataques[sortearIntervalo(&roteiro, (uint32_t) numAtaques)];
+                snprintf(linha, sizeof(linha), "atacar %d %d", ataque->atacante + 1, ataque->defensor + 1);
+            } else if (sorteio == 5 && mapa->numFronteiras[corJogador] > 0) {
+                int territorio = mapa->fronteiras[(size_t) corJogador * mapa->quantidade];
+                snprintf(linha, sizeof(linha), "reforcar %d 1", territorio + 1);
+            } else if (sorteio == 6) {
+                snprintf(linha, sizeof(linha), "tropas %u %d", 1 + sortearIntervalo(&roteiro, (uint32_t) mapa->quantidade),
+                         (int) sortearIntervalo(&roteiro, 4) - 1);
+            } else {
+                snprintf(linha, sizeof(linha), "turno");
+            }
+
+            Comando comando;
+            interpretarComando(linha, &comando);
+            int antes = historico.quantidade;
+            executarComando(&partida, &comando, &resumo);
+            ultimoDesfez = (comando.tipo == COMANDO_DESFAZER && historico.quantidade < antes);
+            desfeitas += ultimoDesfez;
+        }
+        terminadasDesfazendo += ultimoDesfez;
+
+        int gravado = partida.registro != NULL && fecharRegistro(partida.registro) == 0;
+        Mapa *reproducao = gravado ? carregarMapaTexto(caminhoMapa) : NULL;
+        ResumoReproducao resumoReproducao;
+        if (reproducao != NULL && compilarMissoes(reproducao, NULL) == 0
+            && reproduzirRegistro(reproducao, caminhoRegistro, -1, &resumoReproducao) == 0
+            && mesmoEstado(mapa, reproducao) && resumoReproducao.idMissao == missao) {
+            reproduzidas++;
+        }
+        liberarMemoria(reproducao);
+        liberarMemoria(mapa);
+        liberarTela(tela);
+        unlink(caminhoRegistro);
+    }
+    free(ataques);
+
+    conferir(reproduzidas == PARTIDAS_REGISTRADAS,
+             "registro: reproduzir chega ao mesmo mapa da partida gravada");
+    conferir(desfeitas > 0 && terminadasDesfazendo > 0,
+             "registro: as partidas desfizeram jogadas (inclusive no último comando)");
+}
+
+/**
+ * quadroContem()
+ * Diz se o quadro em montagem na tela contém o texto.
+ */
+int quadroContem(const Tela *tela, const char *texto) {
+    return tela->usado > 0 && strstr(tela->buffer, texto) != NULL;
+}
+
+/**
+ * testarTelaIncremental()
+ * Monta quadros do mapa padrão e confere o buffer antes de cada envio: o
+ * primeiro quadro tem todos os territórios, o seguinte só o que mudou e um
+ * quadro sem mudanças quase nada. Vale para a saída sem terminal (lista de
+ * mudanças) e para o mapa fixo no topo do terminal (linhas reescritas no
+ * lugar), forçado aqui com uma altura de terminal fictícia.
+ */
+void testarTelaIncremental(void) {
+    Mapa *mapa = criarMapaPadrao(NULL);
+    Tela *tela = criarTela(0);
+    if (mapa == NULL || tela == NULL) {
+        conferir(0, "tela: preparação do mapa e da tela");
+        liberarTela(tela);
+        liberarMemoria(mapa);
+        return;
+    }
+
+    // Sem terminal: a saída padrão dos testes vai para /dev/null
+    exibirMapa(tela, mapa);
+    size_t completo = tela->usado;
+    int todos = 1;
+    for (int i = 0; i < mapa->quantidade; i++) {
+        todos = todos && quadroContem(tela, nomeTerritorio(mapa, i));
+    }
+    descarregarTela(tela);
+    mapa->tropas[2] = 9;
+    exibirMapa(tela, mapa);
+    int soAlterado = tela->usado < completo && quadroContem(tela, "Peru") && !quadroContem(tela, "Brasil");
+    descarregarTela(tela);
+    exibirMapa(tela, mapa);
+    int semMudanca = quadroContem(tela, "Nenhuma mudança") && !quadroContem(tela, "Peru");
+    descarregarTela(tela);
+    conferir(!tela->fixa && todos && soAlterado && semMudanca,
+             "tela: sem terminal, o quadro seguinte lista só os territórios que mudaram");
+    liberarTela(tela);
+
+    // Mapa fixo: só a linha da Colômbia é reescrita, na posição dela na tabela
+    tela = criarTela(0);
+    if (tela == NULL) {
+        conferir(0, "tela: preparação da tela");
+        liberarMemoria(mapa);
+        return;
+    }
+    tela->linhasTerminal = mapa->quantidade + LINHAS_MOLDURA_MAPA + LINHAS_MINIMAS_ROLAGEM;
+    exibirMapa(tela, mapa);
+    int limpou = tela->fixa && quadroContem(tela, "\033[H\033[2J");
+    completo = tela->usado;
+    descarregarTela(tela);
+    transferirTerritorio(mapa, 3, buscarCor(mapa, "Azul"));
+    exibirMapa(tela, mapa);
+    char posicao[32];
+    snprintf(posicao, sizeof(posicao), "\033[%d;1H", LINHAS_ANTES_DA_TABELA + 3 + 1);
+    soAlterado = tela->usado < completo && quadroContem(tela, posicao) && quadroContem(tela, "Colômbia")
+              && !quadroContem(tela, "Brasil") && !quadroContem(tela, "\033[2J");
+    descarregarTela(tela);
+    exibirMapa(tela, mapa);
+    semMudanca = tela->usado == 0;
+    conferir(limpou && soAlterado && semMudanca,
+             "tela: com o mapa fixo, o quadro seguinte reescreve só as linhas que mudaram");
+    liberarTela(tela);
+    liberarMemoria(mapa);
+}
+
+/**
+ * saidaSessoes()
+ * Roda o modo multissessão com a saída padrão desviada para um arquivo
+ * temporário e devolve o que as sessões escreveram, sem o resumo final
+ * (que traz o tempo e o número de threads).
+ * Retorna:
+ *   - Texto alocado com malloc, ou NULL em caso de erro
+ */
+char* saidaSessoes(const Mapa *modelo, const char *caminhoComandos, int numThreads) {
+    char caminhoSaida[] = "/tmp/war_teste_sessoes_XXXXXX";
+    int descritor = mkstemp(caminhoSaida);
+    if (descritor < 0) {
+        return NULL;
+    }
+    unlink(caminhoSaida);
+
+    fflush(stdout);
+    int saidaAnterior = dup(STDOUT_FILENO);
+    if (saidaAnterior < 0 || dup2(descritor, STDOUT_FILENO) < 0) {
+        close(descritor);
+        return NULL;
+    }
+    int status = executarSessoes(modelo, caminhoComandos, SESSOES_TESTE, numThreads, 99, 0);
+    fflush(stdout);
+    dup2(saidaAnterior, STDOUT_FILENO);
+    close(saidaAnterior);
+
+    off_t tamanho = lseek(descritor, 0, SEEK_END);
+    char *texto = (status == 0 && tamanho > 0) ? (char*) malloc((size_t) tamanho + 1) : NULL;
+    if (texto != NULL && pread(descritor, texto, (size_t) tamanho, 0) != (ssize_t) tamanho) {
+        free(texto);
+        texto = NULL;
+    }
+    close(descritor);
+    if (texto != NULL) {
+        texto[tamanho] = '\0';
+        char *resumo = strstr(texto, "\n✓ ");
+        if (resumo != NULL) {
+            *resumo = '\0';
+        }
+    }
+    return texto;
+}
+
+/**
+ * testarSessoes()
+ * Gera linhas intercaladas de SESSOES_TESTE sessões no mapa em grade
+ * (ataques, reforços, fins de turno, mapas e sessões encerradas e abertas
+ * de novo) e compara a saída das sessões com 1 e com 4 threads: cada
+ * sessão executa os seus comandos em ordem, então ela precisa ser a mesma.
+ */
+void testarSessoes(const char *caminhoMapa) {
+    Mapa *modelo = carregarMapaTexto(caminhoMapa);
+    size_t capacidade = (size_t) (LINHAS_SESSOES + SESSOES_TESTE) * 32;
+    char *comandos = (char*) malloc(capacidade);
+    if (modelo == NULL || comandos == NULL || compilarMissoes(modelo, NULL) != 0) {
+        conferir(0, "sessões: preparação do mapa e dos comandos");
+        free(comandos);
+        liberarMemoria(modelo);
+        return;
+    }
+
+    GeradorAleatorio roteiro;
+    semearGerador(&roteiro, 4242);
+    int abertas[SESSOES_TESTE] = {0};
+    size_t tamanho = 0;
+    for (int i = 0; i < LINHAS_SESSOES; i++) {
+        int id = 1 + (int) sortearIntervalo(&roteiro, SESSOES_TESTE);
+        int territorio = (int) sortearIntervalo(&roteiro, LADO_GRADE * LADO_GRADE - LADO_GRADE);
+        uint32_t sorteio = sortearIntervalo(&roteiro, 20);
+        char linha[48];
+        if (!abertas[id - 1]) {
+            snprintf(linha, sizeof(linha), "nova");
+            abertas[id - 1] = 1;
+        } else if (sorteio < 12) {
+            int vizinho = territorio + ((sorteio % 2) ? 1 : LADO_GRADE);
+            snprintf(linha, sizeof(linha), "atacar %d %d", territorio + 1, vizinho + 1);
+        } else if (sorteio < 15) {
+            snprintf(linha, sizeof(linha), "reforcar %d 1", territorio + 1);
+        } else if (sorteio < 18) {
+            snprintf(linha, sizeof(linha), "turno");
+        } else if (sorteio == 18) {
+            snprintf(linha, sizeof(linha), "mapa");
+        } else {
+            snprintf(linha, sizeof(linha), "sair");
+            abertas[id - 1] = 0;
+        }
+        tamanho += (size_t) snprintf(comandos + tamanho, capacidade - tamanho, "%d %s\n", id, linha);
+    }
+
+    char caminhoComandos[] = "/tmp/war_teste_comandos_XXXXXX";
+    char *umaThread = NULL, *variasThreads = NULL;
+    if (criarArquivo(caminhoComandos, comandos) == 0) {
+        umaThread = saidaSessoes(modelo, caminhoComandos, 1);
+        variasThreads = saidaSessoes(modelo, caminhoComandos, 4);
+        unlink(caminhoComandos);
+    }
+    conferir(umaThread != NULL && variasThreads != NULL && strstr(umaThread, "conquist") != NULL
+             && strcmp(umaThread, variasThreads) == 0,
+             "sessões: as partidas são as mesmas com 1 e com 4 threads");
+    free(umaThread);
+    free(variasThreads);
+    free(comandos);
+    liberarMemoria(modelo);
+}
+
+/**
+ * testarCompilacaoMissoes()
+ * Compila um catálogo válido e confere os IDs e índices de cada missão;
+ * catálogos com uma cor ou território que não existe, tipo inválido, sem
+ * título, vazios ou com missões demais precisam ser recusados, mantendo o
+ * catálogo anterior. O catálogo padrão, em um mapa sem Verde, fica só com
+ * a missão de territórios. Por fim, verificarMissoes() precisa concordar
+ * com verificarVitoria() para todas as missões e cores.
+ */
+void testarCompilacaoMissoes(void) {
+    Mapa *mapa = criarMapaPadrao("missao;eliminar;Verde;Sem verde;\n"
+                                 "# comentário\n"
+                                 "missao;territorios;3;Três territórios;Detalhe\n"
+                                 "missao;regiao;Peru,Chile;Peru e Chile;\n");
+    if (mapa == NULL) {
+        conferir(0, "missões: compilação de um catálogo válido");
+        return;
+    }
+    const CatalogoMissoes *catalogo = mapa->missoes;
+    IdCor verde = buscarCor(mapa, "Verde");
+    Objetivo eliminar = prepararObjetivo(mapa, 1, 0);
+    Objetivo territorios = prepararObjetivo(mapa, 2, 0);
+    Objetivo regiao = prepararObjetivo(mapa, 3, 0);
+    conferir(catalogo->quantidade == 3 && eliminar.tipo == MISSAO_ELIMINAR && eliminar.corAlvo == verde
+             && territorios.tipo == MISSAO_TERRITORIOS && territorios.territoriosMinimos == 3
+             && regiao.tipo == MISSAO_REGIAO && regiao.regiaoMapa == -1 && regiao.tamanhoRegiao == 2
+             && regiao.regiao[0] == 2 && regiao.regiao[1] == 4 && prepararObjetivo(mapa, 4, 0).idMissao == 0,
+             "missões: cores e territórios viram IDs e índices do mapa");
+
+    static const char *invalidos[] = {
+        "missao;eliminar;Roxo;Cor que não existe;\n",
+        "missao;eliminar;;Sem cor;\n",
+        "missao;regiao;Peru,Atlântida;Território que não existe;\n",
+        "missao;conquistar;Peru;Tipo inválido;\n",
+        "missao;territorios;0;Nenhum território;\n",
+        "missao;territorios;3\n",
+        "# só comentários\n\n",
+    };
+    int recusados = 1;
+    for (size_t c = 0; c < sizeof(invalidos) / sizeof(invalidos[0]); c++) {
+        recusados = recusados && compilarMissoesTexto(mapa, invalidos[c], "teste") != 0;
+    }
+    char demais[(MAX_MISSOES + 1) * 32] = "";
+    for (int m = 0; m <= MAX_MISSOES; m++) {
+        strcat(demais, "missao;territorios;2;Dois;\n");
+    }
+    recusados = recusados && compilarMissoesTexto(mapa, demais, "teste") != 0;
+    conferir(recusados && mapa->missoes == catalogo && catalogo->quantidade == 3,
+             "missões: catálogos inválidos são recusados e o anterior é mantido");
+
+    // Verde conquista e perde territórios ao acaso; cada cor tenta cada missão
+    GeradorAleatorio gerador;
+    semearGerador(&gerador, 17);
+    int numCores = mapa->cores->quantidade;
+    Objetivo objetivos[3 * 8];
+    int numObjetivos = 0;
+    for (int m = 1; m <= 3; m++) {
+        for (int c = 0; c < numCores && numObjetivos < 3 * 8; c++) {
+            objetivos[numObjetivos++] = prepararObjetivo(mapa, m, (IdCor) c);
+        }
+    }
+    int concordam = 1;
+    for (int passo = 0; concordam && passo < 500; passo++) {
+        transferirTerritorio(mapa, (int) sortearIntervalo(&gerador, (uint32_t) mapa->quantidade),
+                             (IdCor) sortearIntervalo(&gerador, (uint32_t) numCores));
+        int cumpridas[3 * 8];
+        int total = verificarMissoes(mapa, objetivos, numObjetivos, cumpridas);
+        int esperado = 0;
+        for (int o = 0; o < numObjetivos; o++) {
+            int cumprida = verificarVitoria(mapa, &objetivos[o]);
+            esperado += cumprida;
+            concordam = concordam && cumpridas[o] == cumprida;
+        }
+        concordam = concordam && total == esperado;
+    }
+    conferir(concordam, "missões: verificarMissoes() concorda com verificarVitoria()");
+    liberarMemoria(mapa);
+
+    // Catálogo padrão em um mapa sem Verde
+    char caminho[] = "/tmp/war_teste_sem_verde_XXXXXX";
+    mapa = NULL;
+    if (criarArquivo(caminho, "territorio;A;Azul;2\nterritorio;B;Vermelho;2\nfronteira;A;B\n") == 0) {
+        mapa = carregarMapaTexto(caminho);
+        unlink(caminho);
+    }
+    conferir(mapa != NULL && compilarMissoes(mapa, NULL) == 0 && mapa->missoes->quantidade == 1
+             && prepararObjetivo(mapa, 1, 0).tipo == MISSAO_TERRITORIOS,
+             "missões: sem Verde no mapa, o catálogo padrão deixa de fora a missão de eliminá-lo");
+    liberarMemoria(mapa);
+}
+
+/**
+ * testarReforcos()
+ * Conquistas sorteadas no mapa em grade (com regiões): a cada passo, os
+ * contadores por cor e região, as regiões dominadas, os bônus e os reforços
+ * de cada cor precisam bater com uma contagem do mapa inteiro. Depois, uma
+ * missão com o nome de uma região do mapa padrão precisa valer a região.
+ */
+void testarReforcos(const char *caminhoMapa) {
+    Mapa *mapa = carregarMapaTexto(caminhoMapa);
+    if (mapa == NULL || mapa->numRegioes == 0) {
+        conferir(0, "reforços: preparação do mapa em grade com regiões");
+        liberarMemoria(mapa);
+        return;
+    }
+    int numCores = mapa->cores->quantidade;
+    int numRegioes = mapa->numRegioes;
+    int32_t *contagem = (int32_t*) malloc((size_t) numCores * numRegioes * sizeof(int32_t));
+    GeradorAleatorio gerador;
+    semearGerador(&gerador, 23);
+    int coincidem = contagem != NULL;
+    for (int passo = 0; coincidem && passo < 3000; passo++) {
+        // Poucas cores por passo para que as regiões sejam dominadas de vez em quando
+        IdCor novaCor = (IdCor) sortearIntervalo(&gerador, 2);
+        transferirTerritorio(mapa, (int) sortearIntervalo(&gerador, (uint32_t) mapa->quantidade), novaCor);
+
+        memset(contagem, 0, (size_t) numCores * numRegioes * sizeof(int32_t));
+        for (int i = 0; i < mapa->quantidade; i++) {
+            if (mapa->regiaoDe[i] >= 0) {
+                contagem[mapa->cor[i] * numRegioes + mapa->regiaoDe[i]]++;
+            }
+        }
+        for (int c = 0; c < numCores; c++) {
+            int regioes = 0, bonus = 0;
+            for (int r = 0; r < numRegioes; r++) {
+                coincidem = coincidem && mapa->territoriosPorRegiao[c * numRegioes + r] == contagem[c * numRegioes + r];
+                if (contagem[c * numRegioes + r] == mapa->tamanhoRegiao[r]) {
+                    regioes++;
+                    bonus += mapa->bonusRegiao[r];
+                }
+            }
+            int territorios = contarTerritoriosDaCor(mapa, (IdCor) c);
+            int esperado = 0;
+            if (territorios > 0) {
+                esperado = territorios / TERRITORIOS_POR_REFORCO;
+                esperado = (esperado < REFORCO_MINIMO ? REFORCO_MINIMO : esperado) + bonus;
+            }
+            coincidem = coincidem && mapa->regioesPorCor[c] == regioes && mapa->bonusPorCor[c] == bonus
+                     && calcularReforcos(mapa, (IdCor) c) == esperado;
+        }
+    }
+    conferir(coincidem, "reforços: contadores por região, bônus e reforços batem com o mapa inteiro");
+    free(contagem);
+    liberarMemoria(mapa);
+
+    // Missão de região pelo nome: Andes (Peru e Colômbia) no mapa padrão
+    mapa = criarMapaPadrao("missao;regiao;Andes;Dominar os Andes;\n");
+    if (mapa == NULL) {
+        conferir(0, "reforços: missão com o nome de uma região do mapa");
+        return;
+    }
+    IdCor azul = buscarCor(mapa, "Azul");
+    Objetivo andes = prepararObjetivo(mapa, 1, azul);
+    int antes = verificarVitoria(mapa, &andes);
+    int reforcosAntes = calcularReforcos(mapa, azul);
+    transferirTerritorio(mapa, 2, azul);
+    int metade = verificarVitoria(mapa, &andes);
+    transferirTerritorio(mapa, 3, azul);
+    conferir(andes.regiaoMapa == buscarRegiao(mapa, "Andes") && andes.tamanhoRegiao == 2
+             && !antes && !metade && verificarVitoria(mapa, &andes)
+             && calcularReforcos(mapa, azul) == reforcosAntes + 2,
+             "reforços: uma missão pode pedir uma região do mapa pelo nome, que dá o seu bônus");
+    liberarMemoria(mapa);
+}
+
+/**
+ * testarInstantaneos()
+ * Aplica ataques, batalhas e conquistas sorteados, tirando
+ * instantâneos junto com cópias completas; restaurar um instantâneo
+ * precisa deixar o mapa igual à cópia tirada no mesmo momento.
+ */
+void testarInstantaneos(const char *caminhoMapa) {
+    Mapa *mapa = carregarMapaTexto(caminhoMapa);
+    Ataque *ataques = (mapa != NULL) ? (Ataque*) malloc((size_t) limiteAtaques(mapa) * sizeof(Ataque)) : NULL;
+    if (mapa == NULL || ataques == NULL || iniciarDiario(mapa) != 0) {
+        conferir(0, "instantâneos: preparação do mapa");
+        free(ataques);
+        liberarMemoria(mapa);
+        return;
+    }
+
+    GeradorAleatorio gerador;
+    semearGerador(&gerador, 99);
+    Marca pilha[MAX_PILHA_INSTANTANEOS];
+    int topo = 0, restauracoes = 0, iguais = 1;
+    int numCores = mapa->cores->quantidade;
+
+    for (int passo = 0; passo < PASSOS_INSTANTANEOS && iguais; passo++) {
+        uint32_t operacao = sortearIntervalo(&gerador, 8);
+        if (operacao == 0 && topo < MAX_PILHA_INSTANTANEOS) {
+            pilha[topo].instantaneo = tirarInstantaneo(mapa);
+            pilha[topo].copia = clonarMapa(mapa);
+            iguais = pilha[topo].copia != NULL;
+            topo++;
+        } else if (operacao == 1 && topo > 0) {
+            // Volta a um instantâneo qualquer da pilha; os mais novos deixam de valer
+            int alvo = (int) sortearIntervalo(&gerador, (uint32_t) topo);
+            iguais = restaurarInstantaneo(mapa, pilha[alvo].instantaneo) == 0
+                  && mesmoEstadoCompleto(mapa, pilha[alvo].copia);
+            restauracoes++;
+            while (topo > alvo + 1) {
+                liberarMemoria(pilha[--topo].copia);
+            }
+        } else {
+            IdCor cor = (IdCor) sortearIntervalo(&gerador, (uint32_t) numCores);
+            int numAtaques = listarAtaques(mapa, cor, ataques, limiteAtaques(mapa));
+            if (operacao == 2 || numAtaques == 0) {
+                transferirTerritorio(mapa, (int) sortearIntervalo(&gerador, (uint32_t) mapa->quantidade), cor);
+            } else {
+                const Ataque *ataque = &ataques[sortearIntervalo(&gerador, (uint32_t) numAtaques)];
+                if (operacao == 3) {
+                    resolverBatalha(mapa, ataque->atacante, ataque->defensor, 10, &gerador, NULL);
+                } else {
+                    resolverAtaque(mapa, ataque->atacante, ataque->defensor, rolarDado(&gerador), rolarDado(&gerador),
+                                   NULL);
+                }
+            }
+        }
+    }
+    conferir(iguais && restauracoes > 0, "instantâneos: restaurar é igual a uma cópia completa do mapa");
+
+    // Depois de uma cópia inteira do estado, os instantâneos antigos deixam de valer
+    Instantaneo instantaneo = tirarInstantaneo(mapa);
+    copiarEstadoMapa(mapa, topo > 0 ? pilha[0].copia : mapa);
+    conferir(restaurarInstantaneo(mapa, instantaneo) != 0, "instantâneos: copiarEstadoMapa() invalida os antigos");
+
+    while (topo > 0) {
+        liberarMemoria(pilha[--topo].copia);
+    }
+    free(ataques);
+    liberarMemoria(mapa);
+}
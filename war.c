@@ -12,53 +12,173 @@
 //
 // ============================================================================
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <locale.h>
-#include <time.h>
-
-// --- Constantes Globais ---
-#define NUM_TERRITORIOS 5
-#define TAM_STRING 50
-
-// --- Estrutura de Dados ---
-typedef struct {
-    char nome[TAM_STRING];
-    char corExercito[TAM_STRING];
-    int numTropas;
-} Territorio;
-
-// --- Protótipos das Funções ---
-// Funções de setup e gerenciamento de memória:
-Territorio* alocarMapa(int quantidade);
-void inicializarTerritorios(Territorio territorios[], int quantidade);
-void liberarMemoria(Territorio *territorios);
-
-// Funções de interface com o usuário:
-void exibirMenuPrincipal();
-void exibirMapa(const Territorio territorios[], int quantidade);
-void exibirMissao(int idMissao);
-
-// Funções de lógica principal do jogo:
-void faseDeAtaque(Territorio territorios[], int quantidade);
-void simularAtaque(Territorio territorios[], int atacante, int defensor);
-int sortearMissao();
-int verificarVitoria(const Territorio territorios[], int quantidade, int idMissao, const char *corJogador);
-
-// Função utilitária:
-void limparBufferEntrada();
+#include "war.h"
 
 // --- Função Principal (main) ---
-int main() {
+// Omitida com -DWAR_SEM_MAIN para que outros programas (bench.c) usem as funções do jogo.
+#ifndef WAR_SEM_MAIN
+#ifdef WAR_METRICAS
+// Destino de --metricas: o retrato é gravado quando o programa termina,
+// qualquer que seja o modo de jogo.
+static const char *arquivoMetricas = NULL;
+
+static void gravarMetricasAoSair(void) {
+    salvarMetricas(arquivoMetricas);
+}
+#endif
+
+int main(int argc, char *argv[]) {
     // 1. Configuração Inicial (Setup)
     setlocale(LC_ALL, "Portuguese");
-    srand(time(NULL));
+    uint64_t semente = (uint64_t) time(NULL);
+    long long numPartidas = 0;
+    int numThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    int rodadasPorAtaque = 1;
+    int orcamentoIA = ORCAMENTO_IA_MS;
+    const char *arquivoMapa = NULL;
+    const char *arquivoMissoes = NULL;
+    const char *arquivoRegistro = NULL;
+    const char *arquivoReproducao = NULL;
+    const char *arquivoComandos = NULL;
+    int32_t turnoReproducao = -1;
+    int maxSessoes = 0;
+    int silencioso = 0;
     
-    // Aloca dinamicamente a memória para os territórios
-    Territorio *mapa = alocarMapa(NUM_TERRITORIOS);
-    if (mapa == NULL) {
-        printf("❌ Erro ao alocar memória para o mapa!\n");
+    // Opções de linha de comando
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--simular") == 0 && i + 1 < argc) {
+            numPartidas = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rodadas") == 0 && i + 1 < argc) {
+            rodadasPorAtaque = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ia-ms") == 0 && i + 1 < argc) {
+            orcamentoIA = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sem-ia") == 0) {
+            orcamentoIA = -1;
+        } else if (strcmp(argv[i], "--registrar") == 0 && i + 1 < argc) {
+            arquivoRegistro = argv[++i];
+        } else if (strcmp(argv[i], "--reproduzir") == 0 && i + 1 < argc) {
+            arquivoReproducao = argv[++i];
+        } else if (strcmp(argv[i], "--turno") == 0 && i + 1 < argc) {
+            turnoReproducao = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sessoes") == 0 && i + 1 < argc) {
+            maxSessoes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--comandos") == 0 && i + 1 < argc) {
+            arquivoComandos = argv[++i];
+        } else if (strcmp(argv[i], "--silencioso") == 0) {
+            silencioso = 1;
+        } else if (strcmp(argv[i], "--mapa") == 0 && i + 1 < argc) {
+            arquivoMapa = argv[++i];
+        } else if (strcmp(argv[i], "--missoes") == 0 && i + 1 < argc) {
+            arquivoMissoes = argv[++i];
+        } else if (strcmp(argv[i], "--metricas") == 0 && i + 1 < argc) {
+#ifdef WAR_METRICAS
+            arquivoMetricas = argv[++i];
+#else
+            printf("❌ Este executável foi compilado sem métricas (use: make METRICAS=1)\n");
+            return 1;
+#endif
+        } else if (strcmp(argv[i], "--converter") == 0 && i + 2 < argc) {
+            return converterMapa(argv[i + 1], argv[i + 2]);
+        } else {
+            printf("❌ Opção desconhecida: %s\n", argv[i]);
+            printf("   Uso: %s [--mapa ARQUIVO] [--missoes ARQUIVO] [--semente N] [--simular PARTIDAS] [--threads N] [--rodadas N]\n", argv[0]);
+            printf("        %s [--ia-ms MILISSEGUNDOS | --sem-ia] [--registrar ARQUIVO] [--silencioso]\n", argv[0]);
+            printf("        %s [--comandos ARQUIVO | --comandos -]   (comandos de um arquivo ou pipe, sem pausas)\n", argv[0]);
+            printf("        %s --sessoes MAXIMO [--comandos ARQUIVO] [--threads N]   (várias partidas, linhas \"SESSAO COMANDO\")\n", argv[0]);
+            printf("        %s [--mapa ARQUIVO] --reproduzir REGISTRO [--turno N]\n", argv[0]);
+            printf("        %s [--metricas ARQUIVO | --metricas -]   (só com make METRICAS=1; .json grava em JSON)\n", argv[0]);
+            printf("        %s --converter MAPA.txt MAPA.bin\n", argv[0]);
+            return 1;
+        }
+    }
+#ifdef WAR_METRICAS
+    if (arquivoMetricas != NULL) {
+        atexit(gravarMetricasAoSair);
+    }
+#endif
+    
+    // Carrega o mapa do arquivo ou usa o mapa padrão de 5 territórios
+    struct timespec inicioCarga, fimCarga;
+    clock_gettime(CLOCK_MONOTONIC, &inicioCarga);
+    Mapa *mapa;
+    if (arquivoMapa != NULL) {
+        mapa = carregarMapa(arquivoMapa);
+        if (mapa == NULL) {
+            return 1;
+        }
+    } else {
+        // Aloca dinamicamente a memória para os territórios
+        mapa = alocarMapa(NUM_TERRITORIOS);
+        if (mapa == NULL) {
+            printf("❌ Erro ao alocar memória para o mapa!\n");
+            return 1;
+        }
+        // Inicializa os territórios automaticamente
+        if (inicializarTerritorios(mapa) != 0) {
+            printf("❌ Erro ao preparar o mapa padrão!\n");
+            liberarMemoria(mapa);
+            return 1;
+        }
+    }
+    // Missões do arquivo ou o catálogo padrão, compiladas para este mapa
+    if (compilarMissoes(mapa, arquivoMissoes) != 0) {
+        liberarMemoria(mapa);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fimCarga);
+    
+    // Modo não interativo: simulação de partidas em lote
+    if (numPartidas > 0) {
+        int status = executarSimulacao(mapa, numPartidas, semente, numThreads, rodadasPorAtaque);
+        liberarMemoria(mapa);
+        return status;
+    }
+    
+    // Modo não interativo: várias partidas independentes, com os comandos multiplexados na entrada
+    if (maxSessoes > 0) {
+        int status = executarSessoes(mapa, arquivoComandos != NULL ? arquivoComandos : "-", maxSessoes, numThreads,
+                                     semente, silencioso);
+        liberarMemoria(mapa);
+        return status;
+    }
+    
+    // Modo não interativo: reprodução de uma partida registrada
+    if (arquivoReproducao != NULL) {
+        ResumoReproducao resumo;
+        struct timespec inicio, fim;
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        int status = reproduzirRegistro(mapa, arquivoReproducao, turnoReproducao, &resumo);
+        clock_gettime(CLOCK_MONOTONIC, &fim);
+        Tela *tela = (status == 0) ? criarTela(silencioso) : NULL;
+        if (tela != NULL) {
+            double milissegundos = (fim.tv_sec - inicio.tv_sec) * 1e3 + (fim.tv_nsec - inicio.tv_nsec) / 1e6;
+            exibirMapa(tela, mapa);
+            escreverTela(tela, "\n");
+            if (resumo.idMissao != 0) {
+                escreverTela(tela, "🎮 Exército do jogador: %s\n", nomeCor(mapa, resumo.corJogador));
+                exibirMissao(tela, mapa, resumo.idMissao);
+            }
+            descarregarTela(tela);
+            printf("\n✓ Turno %d alcançado a partir do checkpoint do turno %d: %lld eventos (%lld ataques) em %.2f ms\n",
+                   resumo.turno, resumo.turnoCheckpoint, resumo.eventos, resumo.ataques, milissegundos);
+            printf("🎲 Semente da partida: %" PRIu64 "\n", resumo.semente);
+            liberarTela(tela);
+        }
+        liberarMemoria(mapa);
+        return status;
+    }
+    
+    GeradorAleatorio gerador;
+    semearGerador(&gerador, semente);
+    
+    Tela *tela = criarTela(silencioso);
+    if (tela == NULL) {
+        printf("❌ Erro ao alocar memória para a tela!\n");
+        liberarMemoria(mapa);
         return 1;
     }
     
@@ -68,16 +188,77 @@ int main() {
     printf("║              Missões e Modularização Total                     ║\n");
     printf("╚════════════════════════════════════════════════════════════════╝\n\n");
     
-    // Inicializa os territórios automaticamente
-    inicializarTerritorios(mapa, NUM_TERRITORIOS);
+    if (arquivoMapa != NULL) {
+        double milissegundos = (fimCarga.tv_sec - inicioCarga.tv_sec) * 1e3 + (fimCarga.tv_nsec - inicioCarga.tv_nsec) / 1e6;
+        printf("✓ Mapa %s carregado: %d territórios em %.2f ms\n\n", arquivoMapa, mapa->quantidade, milissegundos);
+    } else {
+        printf("✓ Territórios inicializados com sucesso!\n\n");
+    }
+    
+    // Define a cor do jogador (a primeira cor do mapa, se não houver Azul)
+    IdCor corJogador = buscarCor(mapa, "Azul");
+    if (corJogador == COR_INVALIDA) {
+        corJogador = 0;
+    }
+    printf("🎮 Você está jogando com o exército: %s\n", nomeCor(mapa, corJogador));
+    printf("🎲 Semente da partida: %" PRIu64 " (use --semente para repeti-la)\n\n", semente);
+    
+    // Os outros exércitos são controlados pelo computador
+    MotorIA *motorIA = NULL;
+    if (orcamentoIA >= 0) {
+        motorIA = criarMotorIA(mapa, numThreads, orcamentoIA, semente);
+        if (motorIA == NULL) {
+            printf("⚠️  Não foi possível iniciar os jogadores do computador; os outros exércitos ficarão parados.\n\n");
+        }
+    }
     
-    // Define a cor do jogador
-    char corJogador[TAM_STRING] = "Azul";
-    printf("🎮 Você está jogando com o exército: %s\n\n", corJogador);
+    // Registro da partida (opcional), começando pelo estado inicial do mapa
+    RegistroEventos *registro = NULL;
+    if (arquivoRegistro != NULL) {
+        registro = abrirRegistro(arquivoRegistro, mapa, semente);
+        if (registro == NULL) {
+            destruirMotorIA(motorIA);
+            liberarTela(tela);
+            liberarMemoria(mapa);
+            return 1;
+        }
+        printf("💾 Registrando a partida em %s\n\n", arquivoRegistro);
+    }
     
     // Sorteia a missão secreta do jogador
-    int missao = sortearMissao();
+    int missao = sortearMissao(mapa, &gerador);
+    Objetivo objetivo = prepararObjetivo(mapa, missao, corJogador);
+    registrarMissao(registro, missao, corJogador);
     printf("📜 Sua missão foi definida!\n");
+    
+    // Diário do mapa: permite desfazer turnos (ou comandos) sem copiar o mapa
+    if (iniciarDiario(mapa) != 0) {
+        printf("⚠️  Não foi possível guardar o histórico da partida; não será possível desfazer jogadas.\n");
+    }
+    
+    // Modo de comandos: a partida é conduzida por um arquivo ou pipe, sem menus nem pausas
+    if (arquivoComandos != NULL) {
+        Partida partida;
+        partida.mapa = mapa;
+        partida.gerador = gerador;
+        partida.objetivo = objetivo;
+        partida.motorIA = motorIA;
+        partida.registro = registro;
+        partida.tela = tela;
+        partida.reforcos = calcularReforcos(mapa, corJogador);
+        HistoricoDesfazer historicoComandos;
+        memset(&historicoComandos, 0, sizeof(historicoComandos));
+        partida.historico = (mapa->diario != NULL) ? &historicoComandos : NULL;
+        int status = executarArquivoComandos(&partida, arquivoComandos);
+        if (fecharRegistro(registro) != 0) {
+            printf("❌ Erro ao gravar o registro %s\n", arquivoRegistro);
+            status = 1;
+        }
+        destruirMotorIA(motorIA);
+        liberarTela(tela);
+        liberarMemoria(mapa);
+        return status;
+    }
     printf("   Use a opção [2] no menu para visualizar sua missão.\n\n");
     
     printf("⏸️  Pressione ENTER para iniciar o jogo...");
@@ -87,36 +268,48 @@ int main() {
     // 2. Laço Principal do Jogo (Game Loop)
     int opcao;
     int venceu = 0;
+    HistoricoDesfazer historico;
+    memset(&historico, 0, sizeof(historico));
     
     do {
-        // Exibe o mapa atual
-        exibirMapa(mapa, NUM_TERRITORIOS);
+        // Monta o quadro (mapa, missão e menu) e o envia de uma só vez
+        exibirMapa(tela, mapa);
+        escreverTela(tela, "\n");
+        exibirMissao(tela, mapa, missao);
+        exibirMenuPrincipal(tela);
+        escreverTela(tela, "Escolha uma opção: ");
+        descarregarTela(tela);
         
-        // Exibe a missão atual
-        printf("\n");
-        exibirMissao(missao);
-        
-        // Exibe o menu de opções
-        exibirMenuPrincipal();
-        
-        printf("Escolha uma opção: ");
         scanf("%d", &opcao);
         limparBufferEntrada();
         printf("\n");
         
         switch (opcao) {
-            case 1:
-                faseDeAtaque(mapa, NUM_TERRITORIOS);
+            case 1: {
+                INICIAR_MEDICAO(inicioTurno);
+                guardarPassoDesfazer(&historico, mapa, 0, registro);
+                faseDeReforco(mapa, corJogador, registro);
+                faseDeAtaque(mapa, &gerador, &objetivo, registro);
+                if (motorIA != NULL) {
+                    jogarTurnosIA(motorIA, mapa, corJogador, &gerador, registro);
+                }
+                registrarFimTurno(registro, mapa);
+                ENCERRAR_MEDICAO(TEMPO_TURNO, inicioTurno);
+                if (mapa->territoriosPorCor[corJogador] == 0) {
+                    printf("\n💀 O exército %s perdeu todos os seus territórios. Fim de jogo!\n", nomeCor(mapa, corJogador));
+                    opcao = 0;
+                }
                 break;
+            }
                 
             case 2:
                 // Verifica se o jogador cumpriu a missão
-                if (verificarVitoria(mapa, NUM_TERRITORIOS, missao, corJogador)) {
+                if (verificarVitoria(mapa, &objetivo)) {
                     printf("╔════════════════════════════════════════════════════════════════╗\n");
                     printf("║                    🎉 VITÓRIA! 🎉                              ║\n");
                     printf("╠════════════════════════════════════════════════════════════════╣\n");
                     printf("║  Parabéns! Você completou sua missão com sucesso!             ║\n");
-                    printf("║  O exército %s dominou o mundo!                         ║\n", corJogador);
+                    printf("║  O exército %s dominou o mundo!                         ║\n", nomeCor(mapa, corJogador));
                     printf("╚════════════════════════════════════════════════════════════════╝\n");
                     venceu = 1;
                     opcao = 0; // Encerra o jogo
@@ -129,6 +322,19 @@ int main() {
                 }
                 break;
                 
+            case 3: {
+                // Volta ao início do último turno, inclusive as jogadas dos outros exércitos
+                PassoDesfazer passo;
+                if (desfazerPasso(&historico, mapa, &passo) != 0) {
+                    printf("❌ Não há turno para desfazer.\n");
+                    break;
+                }
+                registrarRestauracao(registro, mapa, passo.turno);
+                printf("↩️  Turno desfeito! O mapa voltou ao início do turno (mais %d turno(s) podem ser desfeitos).\n",
+                       historico.quantidade);
+                break;
+            }
+                
             case 0:
                 if (!venceu) {
                     printf("🏳️  Encerrando o jogo. Até a próxima batalha!\n");
@@ -148,288 +354,5633 @@ int main() {
     } while (opcao != 0);
     
     // 3. Limpeza
+    if (fecharRegistro(registro) != 0) {
+        printf("❌ Erro ao gravar o registro %s\n", arquivoRegistro);
+    }
+    destruirMotorIA(motorIA);
+    liberarTela(tela);
     liberarMemoria(mapa);
     
     return 0;
 }
+#endif // WAR_SEM_MAIN
 
 // --- Implementação das Funções ---
 
 /**
  * alocarMapa()
- * Aloca dinamicamente a memória para o vetor de territórios usando calloc.
+ * Aloca dinamicamente os vetores de um mapa vazio usando calloc.
+ * O mapa começa com "quantidade" territórios, tabelas de textos vazias e
+ * nenhuma fronteira (ver definirFronteiras()).
  * Parâmetros:
  *   - quantidade: número de territórios a alocar
  * Retorna:
- *   - Ponteiro para a memória alocada ou NULL em caso de falha
+ *   - Ponteiro para o mapa alocado ou NULL em caso de falha
  */
-Territorio* alocarMapa(int quantidade) {
-    Territorio *mapa = (Territorio*) calloc(quantidade, sizeof(Territorio));
+Mapa* alocarMapa(int quantidade) {
+    Mapa *mapa = (Mapa*) calloc(1, sizeof(Mapa));
+    if (mapa == NULL) {
+        return NULL;
+    }
+    
+    mapa->quantidade = quantidade;
+    mapa->cor = (IdCor*) calloc(quantidade, sizeof(IdCor));
+    mapa->tropas = (int32_t*) calloc(quantidade, sizeof(int32_t));
+    mapa->nomes = (TabelaTextos*) calloc(1, sizeof(TabelaTextos));
+    mapa->cores = (TabelaTextos*) calloc(1, sizeof(TabelaTextos));
+    mapa->regioes = (TabelaTextos*) calloc(1, sizeof(TabelaTextos));
+    mapa->inicioVizinhos = (uint32_t*) calloc(quantidade + 1, sizeof(uint32_t));
+    
+    if (mapa->cor == NULL || mapa->tropas == NULL || mapa->nomes == NULL || mapa->cores == NULL
+        || mapa->regioes == NULL || mapa->inicioVizinhos == NULL) {
+        liberarMemoria(mapa);
+        return NULL;
+    }
     return mapa;
 }
 
 /**
- * inicializarTerritorios()
- * Preenche os dados iniciais de cada território no mapa automaticamente.
- * Esta função modifica o mapa passado por referência (ponteiro).
+ * clonarMapa()
+ * Cria uma cópia independente do estado (donos, tropas, fronteiras por cor e
+ * contagens por região) de um mapa.
+ * Os nomes, as cores, as fronteiras e as regiões não mudam durante a partida e são
+ * compartilhados com o original, que deve continuar existindo enquanto o
+ * clone for usado.
  * Parâmetros:
- *   - territorios[]: vetor de territórios a ser preenchido
- *   - quantidade: número de territórios a inicializar
+ *   - original: mapa a ser copiado
+ * Retorna:
+ *   - Ponteiro para o clone ou NULL em caso de falha
  */
-void inicializarTerritorios(Territorio territorios[], int quantidade) {
-    // Dados predefinidos dos territórios
-    const char* nomes[] = {"Brasil", "Argentina", "Peru", "Colômbia", "Chile"};
-    const char* cores[] = {"Azul", "Verde", "Vermelho", "Verde", "Amarelo"};
-    const int tropas[] = {5, 3, 4, 2, 3};
+Mapa* clonarMapa(const Mapa *original) {
+    Mapa *clone = (Mapa*) calloc(1, sizeof(Mapa));
+    if (clone == NULL) {
+        return NULL;
+    }
     
-    for (int i = 0; i < quantidade && i < 5; i++) {
-        strcpy(territorios[i].nome, nomes[i]);
-        strcpy(territorios[i].corExercito, cores[i]);
-        territorios[i].numTropas = tropas[i];
+    int n = original->quantidade;
+    clone->quantidade = n;
+    clone->cor = (IdCor*) malloc(n * sizeof(IdCor));
+    clone->tropas = (int32_t*) malloc(n * sizeof(int32_t));
+    clone->vizinhosInimigos = (int32_t*) malloc(n * sizeof(int32_t));
+    clone->posicaoFronteira = (int32_t*) malloc(n * sizeof(int32_t));
+    clone->fronteiras = (int32_t*) malloc((size_t) original->cores->quantidade * n * sizeof(int32_t));
+    if (original->numRegioes > 0) {
+        clone->territoriosPorRegiao = (int32_t*) malloc((size_t) original->cores->quantidade * original->numRegioes
+                                                        * sizeof(int32_t));
     }
+    clone->nomes = original->nomes;
+    clone->cores = original->cores;
+    clone->regioes = original->regioes;
+    clone->inicioVizinhos = original->inicioVizinhos;
+    clone->vizinhos = original->vizinhos;
+    clone->numRegioes = original->numRegioes;
+    clone->regiaoDe = original->regiaoDe;
+    clone->tamanhoRegiao = original->tamanhoRegiao;
+    clone->bonusRegiao = original->bonusRegiao;
+    clone->missoes = original->missoes;
+    clone->original = original;
     
-    printf("✓ Territórios inicializados com sucesso!\n\n");
+    if (clone->cor == NULL || clone->tropas == NULL || clone->vizinhosInimigos == NULL
+        || clone->posicaoFronteira == NULL || clone->fronteiras == NULL
+        || (clone->numRegioes > 0 && clone->territoriosPorRegiao == NULL)) {
+        liberarMemoria(clone);
+        return NULL;
+    }
+    copiarEstadoMapa(clone, original);
+    return clone;
 }
 
+static void invalidarDiario(Mapa *mapa);
+
 /**
- * exibirMapa()
- * Exibe o estado atual de todos os territórios formatado como uma tabela.
+ * copiarEstadoMapa()
+ * Copia os donos, as tropas e o estado derivado (contadores, listas de
+ * fronteira e contagens por região) de um mapa para um clone dele.
+ * Os instantâneos do destino deixam de valer.
  * Parâmetros:
- *   - territorios[]: vetor de territórios a ser exibido (const - apenas leitura)
- *   - quantidade: número de territórios no vetor
+ *   - destino: mapa que recebe o estado
+ *   - origem: mapa de onde o estado é lido
  */
-void exibirMapa(const Territorio territorios[], int quantidade) {
-    printf("╔════════════════════════════════════════════════════════════════╗\n");
-    printf("║                    🗺️  MAPA DOS TERRITÓRIOS 🗺️                ║\n");
-    printf("╚════════════════════════════════════════════════════════════════╝\n\n");
-    
-    printf("┌────┬────────────────────────┬────────────────────────┬─────────┐\n");
-    printf("│ Nº │      TERRITÓRIO        │    COR DO EXÉRCITO     │ TROPAS  │\n");
-    printf("├────┼────────────────────────┼────────────────────────┼─────────┤\n");
-    
-    for (int i = 0; i < quantidade; i++) {
-        printf("│ %2d │ %-22s │ %-22s │  %5d  │\n",
-               i + 1,
-               territorios[i].nome,
-               territorios[i].corExercito,
-               territorios[i].numTropas);
+void copiarEstadoMapa(Mapa *destino, const Mapa *origem) {
+    int n = origem->quantidade;
+    memcpy(destino->cor, origem->cor, n * sizeof(IdCor));
+    memcpy(destino->tropas, origem->tropas, n * sizeof(int32_t));
+    memcpy(destino->territoriosPorCor, origem->territoriosPorCor, sizeof(origem->territoriosPorCor));
+    memcpy(destino->vizinhosInimigos, origem->vizinhosInimigos, n * sizeof(int32_t));
+    memcpy(destino->posicaoFronteira, origem->posicaoFronteira, n * sizeof(int32_t));
+    memcpy(destino->numFronteiras, origem->numFronteiras, sizeof(origem->numFronteiras));
+    for (int c = 0; c < origem->cores->quantidade; c++) {
+        memcpy(destino->fronteiras + (size_t) c * n, origem->fronteiras + (size_t) c * n,
+               origem->numFronteiras[c] * sizeof(int32_t));
     }
-    
-    printf("└────┴────────────────────────┴────────────────────────┴─────────┘\n");
+    if (origem->numRegioes > 0) {
+        memcpy(destino->territoriosPorRegiao, origem->territoriosPorRegiao,
+               (size_t) origem->cores->quantidade * origem->numRegioes * sizeof(int32_t));
+        memcpy(destino->regioesPorCor, origem->regioesPorCor, sizeof(origem->regioesPorCor));
+        memcpy(destino->bonusPorCor, origem->bonusPorCor, sizeof(origem->bonusPorCor));
+    }
+    invalidarDiario(destino);
 }
 
 /**
- * exibirMenuPrincipal()
- * Exibe o menu de opções disponíveis para o jogador.
+ * iniciarDiario()
+ * Passa a anotar as mudanças no estado do mapa, o que permite tirar
+ * instantâneos e voltar a eles.
+ * Parâmetros:
+ *   - mapa: mapa da partida (ainda sem diário)
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de falha de memória
  */
-void exibirMenuPrincipal() {
-    printf("\n╔════════════════════════════════════════════════════════════════╗\n");
-    printf("║                        MENU PRINCIPAL                          ║\n");
-    printf("╠════════════════════════════════════════════════════════════════╣\n");
-    printf("║  [1] ⚔️  Fase de Ataque                                        ║\n");
-    printf("║  [2] 🎯 Verificar Missão                                       ║\n");
-    printf("║  [0] 🏳️  Sair do Jogo                                          ║\n");
-    printf("╚════════════════════════════════════════════════════════════════╝\n\n");
+int iniciarDiario(Mapa *mapa) {
+    DiarioMapa *diario = (DiarioMapa*) calloc(1, sizeof(DiarioMapa));
+    if (diario == NULL) {
+        return 1;
+    }
+    diario->capacidade = 32;
+    diario->escritas = (EscritaDiario*) malloc(diario->capacidade * sizeof(EscritaDiario));
+    if (diario->escritas == NULL) {
+        free(diario);
+        return 1;
+    }
+    mapa->diario = diario;
+    return 0;
+}
+
+// Esquece todas as escritas anotadas: o mapa mudou sem passar pelo diário
+// (ou uma escrita não pôde ser anotada) e nenhum instantâneo tirado até aqui
+// vale mais. A posição avança uma casa para que o instantâneo atual também
+// deixe de valer.
+static void invalidarDiario(Mapa *mapa) {
+    DiarioMapa *diario = mapa->diario;
+    if (diario != NULL) {
+        diario->descartadas += diario->quantidade + 1;
+        diario->quantidade = 0;
+    }
+}
+
+// Caminho lento de anotarEscrita(): dobra o diário.
+static void anotarEscritaAmpliando(Mapa *mapa, void *campo, int32_t valor, int32_t largura) {
+    DiarioMapa *diario = mapa->diario;
+    size_t capacidade = diario->capacidade * 2;
+    EscritaDiario *escritas = (EscritaDiario*) realloc(diario->escritas, capacidade * sizeof(EscritaDiario));
+    if (escritas == NULL) {
+        invalidarDiario(mapa);
+        return;
+    }
+    diario->escritas = escritas;
+    diario->capacidade = capacidade;
+    diario->escritas[diario->quantidade].campo = campo;
+    diario->escritas[diario->quantidade].valor = valor;
+    diario->escritas[diario->quantidade].largura = largura;
+    diario->quantidade++;
+}
+
+// Anota o valor atual de um campo do estado do mapa, antes de alterá-lo.
+// Sem diário, custa só um teste.
+static inline void anotarEscrita(Mapa *mapa, int32_t *campo) {
+    DiarioMapa *diario = mapa->diario;
+    if (diario == NULL) {
+        return;
+    }
+    if (diario->quantidade == diario->capacidade) {
+        anotarEscritaAmpliando(mapa, campo, *campo, 4);
+        return;
+    }
+    EscritaDiario *escrita = &diario->escritas[diario->quantidade++];
+    escrita->campo = campo;
+    escrita->valor = *campo;
+    escrita->largura = 4;
+}
+
+// Como anotarEscrita(), para o dono de um território.
+static inline void anotarCor(Mapa *mapa, int territorio) {
+    DiarioMapa *diario = mapa->diario;
+    if (diario == NULL) {
+        return;
+    }
+    if (diario->quantidade == diario->capacidade) {
+        anotarEscritaAmpliando(mapa, &mapa->cor[territorio], mapa->cor[territorio], 1);
+        return;
+    }
+    EscritaDiario *escrita = &diario->escritas[diario->quantidade++];
+    escrita->campo = &mapa->cor[territorio];
+    escrita->valor = mapa->cor[territorio];
+    escrita->largura = 1;
 }
 
 /**
- * exibirMissao()
- * Exibe a descrição da missão atual do jogador com base no ID da missão sorteada.
+ * tirarInstantaneo()
+ * Marca o estado atual do mapa, em O(1): nada é copiado, o instantâneo é a
+ * posição atual do diário.
  * Parâmetros:
- *   - idMissao: identificador da missão (1 ou 2)
+ *   - mapa: mapa com diário (ver iniciarDiario())
+ * Retorna:
+ *   - O instantâneo, para restaurarInstantaneo()
  */
-void exibirMissao(int idMissao) {
-    printf("┌────────────────────────────────────────────────────────────────┐\n");
-    printf("│                      📜 MISSÃO SECRETA 📜                       │\n");
-    printf("├────────────────────────────────────────────────────────────────┤\n");
-    
-    if (idMissao == 1) {
-        printf("│  🎯 Objetivo: Destruir o exército VERDE                        │\n");
-        printf("│     → Todos os territórios verdes devem ser conquistados.     │\n");
-    } else if (idMissao == 2) {
-        printf("│  🎯 Objetivo: Conquistar 3 TERRITÓRIOS                         │\n");
-        printf("│     → Domine pelo menos 3 territórios com seu exército.       │\n");
-    } else {
-        printf("│  ⚠️  Missão desconhecida!                                      │\n");
+Instantaneo tirarInstantaneo(const Mapa *mapa) {
+    if (mapa->diario == NULL) {
+        return 0;
     }
-    
-    printf("└────────────────────────────────────────────────────────────────┘\n");
+    return mapa->diario->descartadas + mapa->diario->quantidade;
 }
 
 /**
- * faseDeAtaque()
- * Gerencia a interface para a ação de ataque.
- * Solicita ao jogador os territórios de origem e destino do ataque.
+ * restaurarInstantaneo()
+ * Volta o mapa ao estado de um instantâneo desfazendo, da última para a
+ * primeira, as escritas anotadas depois dele: custa O(campos alterados),
+ * não O(territórios). Instantâneos tirados depois deste deixam de valer.
  * Parâmetros:
- *   - territorios[]: vetor de territórios
- *   - quantidade: número de territórios no vetor
+ *   - mapa: mapa com diário
+ *   - instantaneo: retorno de tirarInstantaneo()
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 se o instantâneo não vale mais (esquecido,
+ *     ou o mapa mudou sem passar pelo diário); o mapa não é alterado
  */
-void faseDeAtaque(Territorio territorios[], int quantidade) {
-    int atacante, defensor;
-    
-    printf("╔════════════════════════════════════════════════════════════════╗\n");
-    printf("║                    ⚔️  FASE DE ATAQUE ⚔️                       ║\n");
-    printf("╚════════════════════════════════════════════════════════════════╝\n\n");
-    
-    printf("Escolha o território ATACANTE (1 a %d): ", quantidade);
-    scanf("%d", &atacante);
-    limparBufferEntrada();
-    
-    printf("Escolha o território DEFENSOR (1 a %d): ", quantidade);
-    scanf("%d", &defensor);
-    limparBufferEntrada();
-    
-    // Validações básicas
-    if (atacante < 1 || atacante > quantidade || defensor < 1 || defensor > quantidade) {
-        printf("\n❌ Território inválido! Os territórios devem estar entre 1 e %d.\n", quantidade);
+int restaurarInstantaneo(Mapa *mapa, Instantaneo instantaneo) {
+    DiarioMapa *diario = mapa->diario;
+    if (diario == NULL || instantaneo < diario->descartadas
+        || instantaneo > diario->descartadas + diario->quantidade) {
+        return 1;
+    }
+    size_t alvo = (size_t) (instantaneo - diario->descartadas);
+    while (diario->quantidade > alvo) {
+        const EscritaDiario *escrita = &diario->escritas[--diario->quantidade];
+        if (escrita->largura == 1) {
+            *(IdCor*) escrita->campo = (IdCor) escrita->valor;
+        } else {
+            *(int32_t*) escrita->campo = escrita->valor;
+        }
+    }
+    return 0;
+}
+
+/**
+ * esquecerInstantaneos()
+ * Avisa que nenhum instantâneo anterior a "instantaneo" será mais
+ * restaurado. As escritas antigas só são apagadas quando ocupam pelo menos
+ * metade do diário, para que o custo de mover as restantes se pague.
+ * Parâmetros:
+ *   - mapa: mapa com diário
+ *   - instantaneo: instantâneo mais antigo que ainda interessa
+ */
+void esquecerInstantaneos(Mapa *mapa, Instantaneo instantaneo) {
+    DiarioMapa *diario = mapa->diario;
+    if (diario == NULL || instantaneo <= diario->descartadas
+        || instantaneo > diario->descartadas + diario->quantidade) {
         return;
     }
-    
-    if (atacante == defensor) {
-        printf("\n❌ Um território não pode atacar a si mesmo!\n");
+    size_t antigas = (size_t) (instantaneo - diario->descartadas);
+    if (antigas * 2 < diario->quantidade) {
         return;
     }
-    
-    // Ajusta os índices (de 1-based para 0-based)
-    simularAtaque(territorios, atacante - 1, defensor - 1);
+    memmove(diario->escritas, diario->escritas + antigas, (diario->quantidade - antigas) * sizeof(EscritaDiario));
+    diario->quantidade -= antigas;
+    diario->descartadas += antigas;
 }
 
 /**
- * simularAtaque()
- * Executa a lógica de uma batalha entre dois territórios.
- * Realiza validações, simula lançamento de dados e atualiza o número de tropas.
- * Se um território for conquistado, atualiza seu dono.
+ * guardarPassoDesfazer()
+ * Guarda o estado atual da partida como um passo que pode ser desfeito.
+ * Com MAX_DESFAZER passos guardados, o mais antigo é esquecido.
  * Parâmetros:
- *   - territorios[]: vetor de territórios
- *   - atacante: índice do território atacante
- *   - defensor: índice do território defensor
+ *   - historico: passos da partida (NULL = partida sem histórico)
+ *   - mapa: mapa da partida (sem diário, nada é guardado)
+ *   - reforcos: tropas de reforço ainda não posicionadas
+ *   - registro: registro de eventos da partida (pode ser NULL)
  */
-void simularAtaque(Territorio territorios[], int atacante, int defensor) {
-    printf("\n════════════════════════════════════════════════════════════════\n");
-    printf("                      🎲 SIMULAÇÃO DE BATALHA 🎲\n");
-    printf("════════════════════════════════════════════════════════════════\n\n");
-    
-    // Exibe informações dos territórios
-    printf("⚔️  ATACANTE: %s (%s) - %d tropas\n", 
-           territorios[atacante].nome,
-           territorios[atacante].corExercito,
-           territorios[atacante].numTropas);
-    
-    printf("🛡️  DEFENSOR: %s (%s) - %d tropas\n\n",
-           territorios[defensor].nome,
-           territorios[defensor].corExercito,
-           territorios[defensor].numTropas);
-    
-    // Validação: atacante precisa ter pelo menos 2 tropas (1 fica no território)
-    if (territorios[atacante].numTropas < 2) {
-        printf("❌ O território atacante precisa ter pelo menos 2 tropas para atacar!\n");
-        printf("   (uma tropa deve sempre permanecer no território)\n");
+void guardarPassoDesfazer(HistoricoDesfazer *historico, Mapa *mapa, int32_t reforcos,
+                          const RegistroEventos *registro) {
+    if (historico == NULL || mapa->diario == NULL) {
         return;
     }
-    
-    // Validação: não pode atacar território da mesma cor
-    if (strcmp(territorios[atacante].corExercito, territorios[defensor].corExercito) == 0) {
-        printf("❌ Você não pode atacar um território da mesma cor!\n");
-        return;
+    if (historico->quantidade == MAX_DESFAZER) {
+        historico->inicio = (historico->inicio + 1) % MAX_DESFAZER;
+        historico->quantidade--;
+        esquecerInstantaneos(mapa, historico->passos[historico->inicio].instantaneo);
     }
+    PassoDesfazer *passo = &historico->passos[(historico->inicio + historico->quantidade) % MAX_DESFAZER];
+    passo->instantaneo = tirarInstantaneo(mapa);
+    passo->reforcos = reforcos;
+    passo->turno = registro != NULL ? registro->turno : 0;
+    historico->quantidade++;
+}
+
+/**
+ * desfazerPasso()
+ * Volta o mapa ao último passo guardado e o retira do histórico.
+ * Parâmetros:
+ *   - historico: passos da partida (NULL = partida sem histórico)
+ *   - mapa: mapa da partida
+ *   - passo: recebe o passo desfeito (reforços e turno de então)
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 se não há passo a desfazer (ou ele não vale
+ *     mais); o histórico é esvaziado nesse caso
+ */
+int desfazerPasso(HistoricoDesfazer *historico, Mapa *mapa, PassoDesfazer *passo) {
+    if (historico == NULL || historico->quantidade == 0) {
+        return 1;
+    }
+    historico->quantidade--;
+    *passo = historico->passos[(historico->inicio + historico->quantidade) % MAX_DESFAZER];
+    if (restaurarInstantaneo(mapa, passo->instantaneo) != 0) {
+        historico->quantidade = 0;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * adicionarFronteira() / removerFronteira()
+ * Inserem e retiram um território da lista de fronteira da sua cor atual,
+ * em O(1) (a remoção move o último item para a posição liberada). As
+ * escritas vão para o diário, para que a ordem das listas também volte.
+ */
+static void adicionarFronteira(Mapa *mapa, int territorio) {
+    IdCor cor = mapa->cor[territorio];
+    int32_t *lista = mapa->fronteiras + (size_t) cor * mapa->quantidade;
+    anotarEscrita(mapa, &mapa->posicaoFronteira[territorio]);
+    anotarEscrita(mapa, &lista[mapa->numFronteiras[cor]]);
+    anotarEscrita(mapa, &mapa->numFronteiras[cor]);
+    mapa->posicaoFronteira[territorio] = mapa->numFronteiras[cor];
+    lista[mapa->numFronteiras[cor]++] = territorio;
+}
+
+static void removerFronteira(Mapa *mapa, int territorio) {
+    IdCor cor = mapa->cor[territorio];
+    int32_t *lista = mapa->fronteiras + (size_t) cor * mapa->quantidade;
+    int32_t posicao = mapa->posicaoFronteira[territorio];
+    anotarEscrita(mapa, &mapa->numFronteiras[cor]);
+    int32_t ultimo = lista[--mapa->numFronteiras[cor]];
+    anotarEscrita(mapa, &lista[posicao]);
+    anotarEscrita(mapa, &mapa->posicaoFronteira[ultimo]);
+    anotarEscrita(mapa, &mapa->posicaoFronteira[territorio]);
+    lista[posicao] = ultimo;
+    mapa->posicaoFronteira[ultimo] = posicao;
+    mapa->posicaoFronteira[territorio] = -1;
+}
+
+/**
+ * recalcularContagens()
+ * Refaz do zero, com uma passada pelo mapa e pelas fronteiras, os contadores
+ * de territórios por cor, as listas de territórios de fronteira de cada cor
+ * (territórios com pelo menos um vizinho inimigo) e as contagens por região.
+ * Só é necessária depois de preencher o mapa; durante a partida tudo é
+ * mantido por transferirTerritorio(). Os instantâneos do mapa deixam de valer.
+ * Parâmetros:
+ *   - mapa: mapa cujos contadores serão recalculados
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de falha de memória
+ */
+int recalcularContagens(Mapa *mapa) {
+    int n = mapa->quantidade;
     
-    // Simula lançamento dos dados
-    int dadoAtacante = (rand() % 6) + 1;  // Dado de 1 a 6
-    int dadoDefensor = (rand() % 6) + 1;  // Dado de 1 a 6
-    
-    printf("🎲 Lançando os dados...\n\n");
-    printf("   Dado do ATACANTE: 🎲 %d\n", dadoAtacante);
-    printf("   Dado do DEFENSOR: 🎲 %d\n\n", dadoDefensor);
+    // Os vetores do estado derivado nunca ficam no arquivo mapeado
+    if (mapa->vizinhosInimigos == NULL) {
+        mapa->vizinhosInimigos = (int32_t*) malloc(n * sizeof(int32_t));
+        mapa->posicaoFronteira = (int32_t*) malloc(n * sizeof(int32_t));
+        mapa->fronteiras = (int32_t*) malloc((size_t) (mapa->cores->quantidade ? mapa->cores->quantidade : 1)
+                                             * n * sizeof(int32_t));
+        if (mapa->vizinhosInimigos == NULL || mapa->posicaoFronteira == NULL || mapa->fronteiras == NULL) {
+            return 1;
+        }
+    }
+    if (mapa->numRegioes > 0 && mapa->territoriosPorRegiao == NULL) {
+        mapa->territoriosPorRegiao = (int32_t*) malloc((size_t) (mapa->cores->quantidade ? mapa->cores->quantidade : 1)
+                                                       * mapa->numRegioes * sizeof(int32_t));
+        if (mapa->territoriosPorRegiao == NULL) {
+            return 1;
+        }
+    }
     
-    // Determina o vencedor da batalha
-    if (dadoAtacante > dadoDefensor) {
-        printf("✅ O ATACANTE venceu a batalha!\n");
-        territorios[defensor].numTropas--;
-        printf("   → O defensor perdeu 1 tropa. Tropas restantes: %d\n", 
-               territorios[defensor].numTropas);
+    memset(mapa->territoriosPorCor, 0, sizeof(mapa->territoriosPorCor));
+    memset(mapa->numFronteiras, 0, sizeof(mapa->numFronteiras));
+    for (int i = 0; i < n; i++) {
+        mapa->territoriosPorCor[mapa->cor[i]]++;
         
-        // Verifica se o território foi conquistado
-        if (territorios[defensor].numTropas == 0) {
-            printf("\n🏴 TERRITÓRIO CONQUISTADO!\n");
-            printf("   %s agora pertence ao exército %s!\n",
-                   territorios[defensor].nome,
-                   territorios[atacante].corExercito);
-            
-            // Atualiza a cor do exército e move uma tropa
-            strcpy(territorios[defensor].corExercito, territorios[atacante].corExercito);
-            territorios[defensor].numTropas = 1;
-            territorios[atacante].numTropas--;
+        int32_t inimigos = 0;
+        for (uint32_t v = mapa->inicioVizinhos[i]; v < mapa->inicioVizinhos[i + 1]; v++) {
+            inimigos += (mapa->cor[mapa->vizinhos[v]] != mapa->cor[i]);
+        }
+        mapa->vizinhosInimigos[i] = inimigos;
+        mapa->posicaoFronteira[i] = -1;
+        if (inimigos > 0) {
+            adicionarFronteira(mapa, i);
         }
-    } else {
-        printf("✅ O DEFENSOR resistiu ao ataque!\n");
-        printf("   → Nenhuma tropa foi perdida.\n");
-        printf("   (Empates e vitórias do defensor favorecem a defesa)\n");
     }
     
-    printf("\n════════════════════════════════════════════════════════════════\n");
+    memset(mapa->regioesPorCor, 0, sizeof(mapa->regioesPorCor));
+    memset(mapa->bonusPorCor, 0, sizeof(mapa->bonusPorCor));
+    if (mapa->numRegioes > 0) {
+        int r = mapa->numRegioes;
+        memset(mapa->territoriosPorRegiao, 0, (size_t) mapa->cores->quantidade * r * sizeof(int32_t));
+        for (int i = 0; i < n; i++) {
+            if (mapa->regiaoDe[i] >= 0) {
+                mapa->territoriosPorRegiao[mapa->cor[i] * r + mapa->regiaoDe[i]]++;
+            }
+        }
+        for (int c = 0; c < mapa->cores->quantidade; c++) {
+            for (int regiao = 0; regiao < r; regiao++) {
+                if (mapa->territoriosPorRegiao[c * r + regiao] == mapa->tamanhoRegiao[regiao]) {
+                    mapa->regioesPorCor[c]++;
+                    mapa->bonusPorCor[c] += mapa->bonusRegiao[regiao];
+                }
+            }
+        }
+    }
+    invalidarDiario(mapa);
+    return 0;
 }
 
 /**
- * liberarMemoria()
- * Libera a memória previamente alocada para o mapa usando free.
+ * definirRegiao()
+ * Acrescenta uma região (continente) ao mapa. Só vale durante a montagem
+ * do mapa: recalcularContagens() precisa ser chamada depois.
  * Parâmetros:
- *   - territorios: ponteiro para a memória a ser liberada
+ *   - mapa: mapa original (não um clone)
+ *   - nome: nome da região
+ *   - bonus: tropas extras de reforço para quem dominar a região inteira
+ *   - territorios[]: índices dos territórios da região
+ *   - quantidade: número de territórios (pelo menos 1)
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de falha de memória, 2 se algum
+ *     território já pertence a outra região, 3 se já existe uma região com
+ *     esse nome (nos dois últimos casos o mapa não é alterado)
  */
-void liberarMemoria(Territorio *territorios) {
-    free(territorios);
+int definirRegiao(Mapa *mapa, const char *nome, int32_t bonus, const int32_t territorios[], int quantidade) {
+    if (buscarRegiao(mapa, nome) >= 0) {
+        return 3;
+    }
+    if (mapa->regiaoDe == NULL) {
+        mapa->regiaoDe = (int32_t*) malloc((size_t) mapa->quantidade * sizeof(int32_t));
+        if (mapa->regiaoDe == NULL) {
+            return 1;
+        }
+        memset(mapa->regiaoDe, 0xFF, (size_t) mapa->quantidade * sizeof(int32_t));
+    }
+    
+    // Marca os territórios; um território já marcado (em outra região ou
+    // repetido na lista) desfaz as marcas
+    int r = mapa->numRegioes;
+    int marcados = 0;
+    int status = 0;
+    while (marcados < quantidade && status == 0) {
+        if (mapa->regiaoDe[territorios[marcados]] >= 0) {
+            status = 2;
+        } else {
+            mapa->regiaoDe[territorios[marcados++]] = r;
+        }
+    }
+    
+    if (status == 0) {
+        int32_t *tamanhos = (int32_t*) realloc(mapa->tamanhoRegiao, (size_t) (r + 1) * sizeof(int32_t));
+        if (tamanhos != NULL) {
+            mapa->tamanhoRegiao = tamanhos;
+        }
+        int32_t *bonusRegioes = (int32_t*) realloc(mapa->bonusRegiao, (size_t) (r + 1) * sizeof(int32_t));
+        if (bonusRegioes != NULL) {
+            mapa->bonusRegiao = bonusRegioes;
+        }
+        if (tamanhos == NULL || bonusRegioes == NULL || adicionarTexto(mapa->regioes, nome) != r) {
+            status = 1;
+        }
+    }
+    if (status != 0) {
+        for (int i = 0; i < marcados; i++) {
+            mapa->regiaoDe[territorios[i]] = -1;
+        }
+        return status;
+    }
+    
+    mapa->tamanhoRegiao[r] = quantidade;
+    mapa->bonusRegiao[r] = bonus;
+    mapa->numRegioes = r + 1;
+    
+    // O tamanho das contagens por região mudou: recalcularContagens() refaz o vetor
+    free(mapa->territoriosPorRegiao);
+    mapa->territoriosPorRegiao = NULL;
+    return 0;
 }
 
 /**
- * sortearMissao()
- * Sorteia e retorna um ID de missão aleatório para o jogador.
+ * definirFronteiras()
+ * Monta o grafo de fronteiras em CSR (compressed sparse rows) a partir de
+ * uma lista de pares. Cada par vale nos dois sentidos.
+ * Parâmetros:
+ *   - mapa: mapa cujas fronteiras serão definidas
+ *   - pares[][2]: índices dos territórios de cada fronteira
+ *   - numPares: número de fronteiras
  * Retorna:
- *   - 1: Destruir o exército Verde
- *   - 2: Conquistar 3 territórios
+ *   - 0 em caso de sucesso, 1 em caso de falha de memória
  */
-int sortearMissao() {
-    return (rand() % 2) + 1;  // Retorna 1 ou 2
+int definirFronteiras(Mapa *mapa, const uint32_t pares[][2], int numPares) {
+    int n = mapa->quantidade;
+    uint32_t *proxima = (uint32_t*) malloc(n * sizeof(uint32_t));
+    uint32_t *vizinhos = (uint32_t*) malloc((2 * (size_t) numPares + 1) * sizeof(uint32_t));
+    if (proxima == NULL || vizinhos == NULL) {
+        free(proxima);
+        free(vizinhos);
+        return 1;
+    }
+    
+    // Soma de prefixos dos graus dá o início de cada linha
+    memset(mapa->inicioVizinhos, 0, (n + 1) * sizeof(uint32_t));
+    for (int f = 0; f < numPares; f++) {
+        mapa->inicioVizinhos[pares[f][0] + 1]++;
+        mapa->inicioVizinhos[pares[f][1] + 1]++;
+    }
+    for (int i = 0; i < n; i++) {
+        mapa->inicioVizinhos[i + 1] += mapa->inicioVizinhos[i];
+        proxima[i] = mapa->inicioVizinhos[i];
+    }
+    for (int f = 0; f < numPares; f++) {
+        uint32_t a = pares[f][0], b = pares[f][1];
+        vizinhos[proxima[a]++] = b;
+        vizinhos[proxima[b]++] = a;
+    }
+    
+    free(proxima);
+    free(mapa->vizinhos);
+    mapa->vizinhos = vizinhos;
+    return 0;
 }
 
 /**
- * verificarVitoria()
- * Verifica se o jogador cumpriu os requisitos de sua missão atual.
- * Implementa a lógica para cada tipo de missão.
+ * inicializarTerritorios()
+ * Preenche os dados iniciais de cada território no mapa automaticamente.
+ * Esta função modifica o mapa passado por referência (ponteiro).
  * Parâmetros:
- *   - territorios[]: vetor de territórios (const - apenas leitura)
- *   - quantidade: número de territórios
- *   - idMissao: identificador da missão (1 ou 2)
- *   - corJogador: cor do exército do jogador
+ *   - mapa: mapa a ser preenchido
  * Retorna:
- *   - 1 (verdadeiro) se a missão foi cumprida
- *   - 0 (falso) caso contrário
+ *   - 0 em caso de sucesso, 1 em caso de erro (o mapa fica incompleto e
+ *     deve ser liberado)
  */
-int verificarVitoria(const Territorio territorios[], int quantidade, int idMissao, const char *corJogador) {
-    if (idMissao == 1) {
-        // Missão 1: Destruir o exército Verde
-        // Verifica se não existe nenhum território verde
-        int existeVerde = 0;
-        for (int i = 0; i < quantidade; i++) {
-            if (strcmp(territorios[i].corExercito, "Verde") == 0) {
-                existeVerde = 1;
-                break;
-            }
-        }
-        return !existeVerde;  // Retorna 1 se NÃO existir verde (missão cumprida)
-        
-    } else if (idMissao == 2) {
-        // Missão 2: Conquistar 3 territórios
-        // Conta quantos territórios pertencem ao jogador
-        int territoriosDoJogador = 0;
-        for (int i = 0; i < quantidade; i++) {
-            if (strcmp(territorios[i].corExercito, corJogador) == 0) {
-                territoriosDoJogador++;
-            }
+int inicializarTerritorios(Mapa *mapa) {
+    // Dados predefinidos dos territórios
+    const char* nomes[] = {"Brasil", "Argentina", "Peru", "Colômbia", "Chile"};
+    const char* cores[] = {"Azul", "Verde", "Vermelho", "Verde", "Amarelo"};
+    const int tropas[] = {5, 3, 4, 2, 3};
+    const uint32_t fronteiras[][2] = {{0, 1}, {0, 2}, {0, 3}, {1, 4}, {2, 4}, {2, 3}};
+    const int32_t andes[] = {2, 3};      // Peru e Colômbia
+    const int32_t coneSul[] = {1, 4};    // Argentina e Chile
+    
+    for (int i = 0; i < mapa->quantidade && i < 5; i++) {
+        int cor = internarTexto(mapa->cores, cores[i]);
+        if (adicionarTexto(mapa->nomes, nomes[i]) < 0 || cor < 0) {
+            return 1;
         }
-        return territoriosDoJogador >= 3;  // Retorna 1 se tiver 3 ou mais territórios
+        mapa->cor[i] = (IdCor) cor;
+        mapa->tropas[i] = tropas[i];
     }
+    if (mapa->quantidade >= 5
+        && (definirFronteiras(mapa, fronteiras, 6) != 0
+            || definirRegiao(mapa, "Andes", 2, andes, 2) != 0
+            || definirRegiao(mapa, "Cone Sul", 2, coneSul, 2) != 0)) {
+        return 1;
+    }
+    return recalcularContagens(mapa);
+}
+
+/**
+ * liberarMemoria()
+ * Libera a memória previamente alocada para o mapa usando free.
+ * As tabelas de textos e o catálogo de missões só são liberados pelo mapa
+ * original, não pelos clones.
+ * Um clone de arena apenas devolve a sua fatia para ser reaproveitada (o
+ * diário, se houver, é liberado em todos os casos).
+ * Parâmetros:
+ *   - mapa: ponteiro para o mapa a ser liberado
+ */
+void liberarMemoria(Mapa *mapa) {
+    if (mapa == NULL) {
+        return;
+    }
+    if (mapa->diario != NULL) {
+        free(mapa->diario->escritas);
+        free(mapa->diario);
+    }
+    
+    if (mapa->arena != NULL) {
+        ArenaMapas *arena = mapa->arena;
+        *(void**) mapa = arena->livres;
+        arena->livres = mapa;
+        arena->fatiasEmUso--;
+        return;
+    }
+    
+    if (mapa->original == NULL) {
+        liberarMissoes((CatalogoMissoes*) mapa->missoes);
+        TabelaTextos *tabelas[] = {mapa->nomes, mapa->cores, mapa->regioes};
+        for (int i = 0; i < 3; i++) {
+            if (tabelas[i] != NULL) {
+                // Em mapas mapeados de arquivo os textos pertencem ao mapeamento
+                if (mapa->arquivo == NULL) {
+                    free(tabelas[i]->caracteres);
+                    free(tabelas[i]->inicio);
+                }
+                free(tabelas[i]);
+            }
+        }
+        
+        if (mapa->arquivo != NULL) {
+            munmap(mapa->arquivo, mapa->tamanhoArquivo);
+            free(mapa->vizinhosInimigos);
+            free(mapa->posicaoFronteira);
+            free(mapa->fronteiras);
+            free(mapa->territoriosPorRegiao);
+            free(mapa);
+            return;
+        }
+        free(mapa->inicioVizinhos);
+        free(mapa->vizinhos);
+        free(mapa->regiaoDe);
+        free(mapa->tamanhoRegiao);
+        free(mapa->bonusRegiao);
+    }
+    free(mapa->cor);
+    free(mapa->tropas);
+    free(mapa->vizinhosInimigos);
+    free(mapa->posicaoFronteira);
+    free(mapa->fronteiras);
+    free(mapa->territoriosPorRegiao);
+    free(mapa);
+}
+
+// Arredonda um tamanho para o alinhamento das fatias do arena.
+static size_t alinharArena(size_t bytes) {
+    return (bytes + ALINHAMENTO_ARENA - 1) & ~((size_t) ALINHAMENTO_ARENA - 1);
+}
+
+/**
+ * criarArena()
+ * Prepara um arena para clones de um mapa. A fatia de cada clone tem a
+ * estrutura Mapa e os vetores de estado (cor, tropas, fronteiras por cor e
+ * contagens por região), cada um começando em uma nova linha de cache.
+ * Parâmetros:
+ *   - modelo: mapa a ser clonado (deve existir enquanto o arena existir)
+ * Retorna:
+ *   - Ponteiro para o arena, ou NULL em caso de erro
+ */
+ArenaMapas* criarArena(const Mapa *modelo) {
+    ArenaMapas *arena = (ArenaMapas*) calloc(1, sizeof(ArenaMapas));
+    if (arena == NULL) {
+        return NULL;
+    }
+    size_t n = (size_t) modelo->quantidade;
+    arena->modelo = modelo;
+    arena->tamanhoFatia = alinharArena(sizeof(Mapa))
+                        + alinharArena(n * sizeof(IdCor))
+                        + 3 * alinharArena(n * sizeof(int32_t))
+                        + alinharArena((size_t) modelo->cores->quantidade * n * sizeof(int32_t))
+                        + alinharArena((size_t) modelo->cores->quantidade * modelo->numRegioes * sizeof(int32_t));
+    return arena;
+}
+
+/**
+ * reservarFatia()
+ * Retira uma fatia da lista de livres, reservando um novo bloco de
+ * FATIAS_POR_BLOCO_ARENA fatias quando ela está vazia.
+ */
+static void* reservarFatia(ArenaMapas *arena) {
+    if (arena->livres == NULL) {
+        if (arena->numBlocos == arena->capacidadeBlocos) {
+            int capacidade = arena->capacidadeBlocos ? arena->capacidadeBlocos * 2 : 16;
+            char **blocos = (char**) realloc(arena->blocos, (size_t) capacidade * sizeof(char*));
+            if (blocos == NULL) {
+                return NULL;
+            }
+            arena->blocos = blocos;
+            arena->capacidadeBlocos = capacidade;
+        }
+        char *bloco = (char*) aligned_alloc(ALINHAMENTO_ARENA, arena->tamanhoFatia * FATIAS_POR_BLOCO_ARENA);
+        if (bloco == NULL) {
+            return NULL;
+        }
+        arena->blocos[arena->numBlocos++] = bloco;
+        
+        // Encadeia as fatias do bloco novo na lista de livres, na ordem do bloco
+        for (int i = FATIAS_POR_BLOCO_ARENA - 1; i >= 0; i--) {
+            void *fatia = bloco + (size_t) i * arena->tamanhoFatia;
+            *(void**) fatia = arena->livres;
+            arena->livres = fatia;
+        }
+    }
+    
+    void *fatia = arena->livres;
+    arena->livres = *(void**) fatia;
+    arena->fatiasEmUso++;
+    return fatia;
+}
+
+/**
+ * clonarMapaNaArena()
+ * Como clonarMapa(), mas a estrutura e os vetores do clone ocupam uma fatia
+ * do arena: nenhuma chamada a malloc enquanto houver fatias livres.
+ * O clone é liberado normalmente com liberarMemoria().
+ * Parâmetros:
+ *   - arena: arena criado para o mapa original
+ *   - original: mapa a ser copiado (o modelo do arena ou um clone dele)
+ * Retorna:
+ *   - Ponteiro para o clone ou NULL em caso de falha
+ */
+Mapa* clonarMapaNaArena(ArenaMapas *arena, const Mapa *original) {
+    if (original->quantidade != arena->modelo->quantidade
+        || original->cores->quantidade != arena->modelo->cores->quantidade
+        || original->numRegioes != arena->modelo->numRegioes) {
+        return NULL;
+    }
+    char *fatia = (char*) reservarFatia(arena);
+    if (fatia == NULL) {
+        return NULL;
+    }
+    
+    size_t n = (size_t) original->quantidade;
+    Mapa *clone = (Mapa*) fatia;
+    memset(clone, 0, sizeof(Mapa));
+    char *cursor = fatia + alinharArena(sizeof(Mapa));
+    clone->cor = (IdCor*) cursor;
+    cursor += alinharArena(n * sizeof(IdCor));
+    clone->tropas = (int32_t*) cursor;
+    cursor += alinharArena(n * sizeof(int32_t));
+    clone->vizinhosInimigos = (int32_t*) cursor;
+    cursor += alinharArena(n * sizeof(int32_t));
+    clone->posicaoFronteira = (int32_t*) cursor;
+    cursor += alinharArena(n * sizeof(int32_t));
+    clone->fronteiras = (int32_t*) cursor;
+    if (original->numRegioes > 0) {
+        cursor += alinharArena((size_t) original->cores->quantidade * n * sizeof(int32_t));
+        clone->territoriosPorRegiao = (int32_t*) cursor;
+    }
+    
+    clone->quantidade = original->quantidade;
+    clone->nomes = original->nomes;
+    clone->cores = original->cores;
+    clone->regioes = original->regioes;
+    clone->inicioVizinhos = original->inicioVizinhos;
+    clone->vizinhos = original->vizinhos;
+    clone->numRegioes = original->numRegioes;
+    clone->regiaoDe = original->regiaoDe;
+    clone->tamanhoRegiao = original->tamanhoRegiao;
+    clone->bonusRegiao = original->bonusRegiao;
+    clone->missoes = original->missoes;
+    clone->original = original;
+    clone->arena = arena;
+    copiarEstadoMapa(clone, original);
+    return clone;
+}
+
+/**
+ * destruirArena()
+ * Libera todos os blocos do arena. Os clones tirados dele deixam de valer.
+ * Parâmetros:
+ *   - arena: arena a destruir (pode ser NULL)
+ */
+void destruirArena(ArenaMapas *arena) {
+    if (arena == NULL) {
+        return;
+    }
+    for (int i = 0; i < arena->numBlocos; i++) {
+        free(arena->blocos[i]);
+    }
+    free(arena->blocos);
+    free(arena);
+}
+
+/**
+ * adicionarTexto()
+ * Acrescenta um texto à tabela e retorna o ID atribuído a ele.
+ * Parâmetros:
+ *   - tabela: tabela de textos
+ *   - texto: texto a ser copiado para a tabela
+ * Retorna:
+ *   - ID do texto (posição na tabela) ou -1 em caso de falha de memória
+ */
+int adicionarTexto(TabelaTextos *tabela, const char *texto) {
+    size_t tamanhoTexto = strlen(texto) + 1;
+    
+    if (tabela->quantidade == tabela->capacidade) {
+        int novaCapacidade = tabela->capacidade ? tabela->capacidade * 2 : 16;
+        uint32_t *inicio = (uint32_t*) realloc(tabela->inicio, novaCapacidade * sizeof(uint32_t));
+        if (inicio == NULL) {
+            return -1;
+        }
+        tabela->inicio = inicio;
+        tabela->capacidade = novaCapacidade;
+    }
+    
+    if (tabela->tamanho + tamanhoTexto > tabela->capacidadeCaracteres) {
+        size_t novaCapacidade = tabela->capacidadeCaracteres ? tabela->capacidadeCaracteres * 2 : 256;
+        while (novaCapacidade < tabela->tamanho + tamanhoTexto) {
+            novaCapacidade *= 2;
+        }
+        char *caracteres = (char*) realloc(tabela->caracteres, novaCapacidade);
+        if (caracteres == NULL) {
+            return -1;
+        }
+        tabela->caracteres = caracteres;
+        tabela->capacidadeCaracteres = novaCapacidade;
+    }
+    
+    memcpy(tabela->caracteres + tabela->tamanho, texto, tamanhoTexto);
+    tabela->inicio[tabela->quantidade] = (uint32_t) tabela->tamanho;
+    tabela->tamanho += tamanhoTexto;
+    return tabela->quantidade++;
+}
+
+/**
+ * internarTexto()
+ * Retorna o ID de um texto, acrescentando-o à tabela só se ainda não existir.
+ * A busca é linear, adequada para tabelas pequenas como a de cores.
+ * Parâmetros:
+ *   - tabela: tabela de textos
+ *   - texto: texto procurado
+ * Retorna:
+ *   - ID do texto ou -1 em caso de falha de memória
+ */
+int internarTexto(TabelaTextos *tabela, const char *texto) {
+    for (int id = 0; id < tabela->quantidade; id++) {
+        if (strcmp(textoDe(tabela, id), texto) == 0) {
+            return id;
+        }
+    }
+    return adicionarTexto(tabela, texto);
+}
+
+/**
+ * textoDe()
+ * Retorna o texto correspondente a um ID da tabela.
+ */
+const char* textoDe(const TabelaTextos *tabela, int id) {
+    return tabela->caracteres + tabela->inicio[id];
+}
+
+/**
+ * nomeTerritorio()
+ * Retorna o nome de um território do mapa.
+ */
+const char* nomeTerritorio(const Mapa *mapa, int territorio) {
+    return textoDe(mapa->nomes, territorio);
+}
+
+/**
+ * nomeCor()
+ * Retorna o nome de uma cor de exército do mapa.
+ */
+const char* nomeCor(const Mapa *mapa, IdCor cor) {
+    return textoDe(mapa->cores, cor);
+}
+
+/**
+ * buscarCor()
+ * Procura o ID de uma cor de exército pelo nome.
+ * Parâmetros:
+ *   - mapa: mapa cujas cores serão consultadas
+ *   - nome: nome da cor (ex.: "Verde")
+ * Retorna:
+ *   - ID da cor ou COR_INVALIDA se nenhuma cor tiver esse nome
+ */
+IdCor buscarCor(const Mapa *mapa, const char *nome) {
+    for (int id = 0; id < mapa->cores->quantidade; id++) {
+        if (strcmp(textoDe(mapa->cores, id), nome) == 0) {
+            return (IdCor) id;
+        }
+    }
+    return COR_INVALIDA;
+}
+
+/**
+ * buscarRegiao()
+ * Procura o ID de uma região do mapa pelo nome. A busca é linear, como a
+ * das cores: regiões são poucas e só são procuradas no carregamento.
+ * Parâmetros:
+ *   - mapa: mapa cujas regiões serão consultadas
+ *   - nome: nome da região (ex.: "Andes")
+ * Retorna:
+ *   - ID da região ou -1 se nenhuma região tiver esse nome
+ */
+int buscarRegiao(const Mapa *mapa, const char *nome) {
+    for (int r = 0; r < mapa->numRegioes; r++) {
+        if (strcmp(textoDe(mapa->regioes, r), nome) == 0) {
+            return r;
+        }
+    }
+    return -1;
+}
+
+/**
+ * carregarMapa()
+ * Carrega um mapa de arquivo, reconhecendo o formato pelo conteúdo:
+ * arquivos que começam com a assinatura binária são mapeados em memória,
+ * os demais são lidos como texto.
+ * Parâmetros:
+ *   - caminho: caminho do arquivo de mapa
+ * Retorna:
+ *   - Ponteiro para o mapa carregado ou NULL em caso de erro (já informado)
+ */
+Mapa* carregarMapa(const char *caminho) {
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        printf("❌ Não foi possível abrir o mapa %s!\n", caminho);
+        return NULL;
+    }
+    
+    char assinatura[8] = {0};
+    size_t lidos = fread(assinatura, 1, sizeof(assinatura), arquivo);
+    fclose(arquivo);
+    
+    if (lidos == sizeof(assinatura) && memcmp(assinatura, ASSINATURA_MAPA, sizeof(assinatura)) == 0) {
+        return mapearMapaBinario(caminho);
+    }
+    return carregarMapaTexto(caminho);
+}
+
+/**
+ * proximoCampo()
+ * Separa o próximo campo de uma linha do mapa de texto (separador ';'),
+ * removendo espaços das pontas. Modifica a linha no próprio lugar.
+ * Parâmetros:
+ *   - cursor: posição atual na linha (é avançada para depois do campo)
+ * Retorna:
+ *   - O campo, ou NULL se a linha já terminou
+ */
+static char* proximoCampo(char **cursor) {
+    char *inicio = *cursor;
+    if (inicio == NULL) {
+        return NULL;
+    }
+    
+    char *separador = strchr(inicio, ';');
+    if (separador != NULL) {
+        *separador = '\0';
+        *cursor = separador + 1;
+    } else {
+        *cursor = NULL;
+    }
+    
+    while (*inicio == ' ' || *inicio == '\t') {
+        inicio++;
+    }
+    char *fim = inicio + strlen(inicio);
+    while (fim > inicio && (fim[-1] == ' ' || fim[-1] == '\t' || fim[-1] == '\r')) {
+        *--fim = '\0';
+    }
+    return inicio;
+}
+
+/**
+ * proximoItemLista()
+ * Separa o próximo item de uma lista "A,B,C" guardada em um campo, removendo
+ * espaços das pontas. Modifica o campo no próprio lugar.
+ * Parâmetros:
+ *   - cursor: posição atual na lista (é avançada para depois do item)
+ * Retorna:
+ *   - O item, ou NULL se a lista já terminou
+ */
+static char* proximoItemLista(char **cursor) {
+    char *item = *cursor;
+    if (item == NULL) {
+        return NULL;
+    }
+    
+    char *separador = strchr(item, ',');
+    if (separador != NULL) {
+        *separador = '\0';
+        *cursor = separador + 1;
+    } else {
+        *cursor = NULL;
+    }
+    
+    while (*item == ' ' || *item == '\t') {
+        item++;
+    }
+    char *fim = item + strlen(item);
+    while (fim > item && (fim[-1] == ' ' || fim[-1] == '\t')) {
+        *--fim = '\0';
+    }
+    return item;
+}
+
+/**
+ * registroDoTipo()
+ * Diz se o primeiro campo de uma linha do mapa de texto é o tipo pedido,
+ * com os mesmos espaços das pontas que proximoCampo() ignora, mas sem
+ * modificar a linha (usada na contagem da 1ª passada).
+ * Parâmetros:
+ *   - linha: início da linha (terminada em '\n' ou '\0')
+ *   - tipo: tipo de registro procurado ("territorio", "fronteira", ...)
+ * Retorna:
+ *   - 1 se a linha é um registro desse tipo, 0 caso contrário
+ */
+static int registroDoTipo(const char *linha, const char *tipo) {
+    while (*linha == ' ' || *linha == '\t') {
+        linha++;
+    }
+    size_t tamanho = strlen(tipo);
+    if (strncmp(linha, tipo, tamanho) != 0) {
+        return 0;
+    }
+    linha += tamanho;
+    while (*linha == ' ' || *linha == '\t' || *linha == '\r') {
+        linha++;
+    }
+    return *linha == ';' || *linha == '\n' || *linha == '\0';
+}
+
+/**
+ * espalharTexto()
+ * Função de espalhamento FNV-1a, usada no índice de nomes do carregador.
+ */
+static uint32_t espalharTexto(const char *texto) {
+    uint32_t h = 2166136261u;
+    for (; *texto; texto++) {
+        h = (h ^ (unsigned char) *texto) * 16777619u;
+    }
+    return h;
+}
+
+/**
+ * buscarIndiceTexto()
+ * Procura um texto no índice por espalhamento de uma tabela de textos.
+ * Parâmetros:
+ *   - tabela: tabela cujos IDs estão guardados no índice
+ *   - indice: tabela de endereçamento aberto (-1 = posição livre)
+ *   - mascara: tamanho da tabela menos 1 (tamanho potência de 2)
+ *   - texto: texto procurado
+ * Retorna:
+ *   - Posição em indice[] onde o texto está ou deve ser inserido
+ */
+static uint32_t buscarIndiceTexto(const TabelaTextos *tabela, const int32_t indice[], uint32_t mascara,
+                                  const char *texto) {
+    uint32_t posicao = espalharTexto(texto) & mascara;
+    while (indice[posicao] >= 0 && strcmp(textoDe(tabela, indice[posicao]), texto) != 0) {
+        posicao = (posicao + 1) & mascara;
+    }
+    return posicao;
+}
+
+/**
+ * buscarIndiceNome()
+ * Procura um território pelo nome no índice por espalhamento do carregador.
+ * Parâmetros:
+ *   - mapa: mapa sendo carregado
+ *   - indice: tabela de endereçamento aberto (-1 = posição livre)
+ *   - mascara: tamanho da tabela menos 1 (tamanho potência de 2)
+ *   - nome: nome procurado
+ * Retorna:
+ *   - Posição em indice[] onde o nome está ou deve ser inserido
+ */
+static uint32_t buscarIndiceNome(const Mapa *mapa, const int32_t indice[], uint32_t mascara, const char *nome) {
+    return buscarIndiceTexto(mapa->nomes, indice, mascara, nome);
+}
+
+/**
+ * buscarIndicePar()
+ * Procura uma fronteira no índice por espalhamento de pares do carregador.
+ * Parâmetros:
+ *   - pares: tabela de endereçamento aberto (UINT64_MAX = posição livre)
+ *   - mascara: tamanho da tabela menos 1 (tamanho potência de 2)
+ *   - par: territórios da fronteira, o menor nos 32 bits altos
+ * Retorna:
+ *   - Posição em pares[] onde o par está ou deve ser inserido
+ */
+static uint32_t buscarIndicePar(const uint64_t pares[], uint32_t mascara, uint64_t par) {
+    uint32_t posicao = (uint32_t) ((par * 0x9E3779B97F4A7C15u) >> 32) & mascara;
+    while (pares[posicao] != UINT64_MAX && pares[posicao] != par) {
+        posicao = (posicao + 1) & mascara;
+    }
+    return posicao;
+}
+
+/**
+ * textosRepetidos()
+ * Diz se uma tabela de textos tem algum texto repetido (em tempo linear,
+ * com um índice por espalhamento temporário).
+ * Parâmetros:
+ *   - tabela: tabela verificada
+ * Retorna:
+ *   - 0 se todos os textos são distintos, 1 em falha de memória, 2 se há repetição
+ */
+static int textosRepetidos(const TabelaTextos *tabela) {
+    size_t tamanhoIndice = 1;
+    while (tamanhoIndice < 2 * (size_t) tabela->quantidade) {
+        tamanhoIndice <<= 1;
+    }
+    int32_t *indice = (int32_t*) malloc(tamanhoIndice * sizeof(int32_t));
+    if (indice == NULL) {
+        return 1;
+    }
+    memset(indice, 0xFF, tamanhoIndice * sizeof(int32_t));
+    
+    int status = 0;
+    for (int id = 0; id < tabela->quantidade && status == 0; id++) {
+        uint32_t posicao = buscarIndiceTexto(tabela, indice, (uint32_t) (tamanhoIndice - 1), textoDe(tabela, id));
+        if (indice[posicao] >= 0) {
+            status = 2;
+        } else {
+            indice[posicao] = id;
+        }
+    }
+    free(indice);
+    return status;
+}
+
+/**
+ * carregarMapaTexto()
+ * Lê um mapa no formato de texto. Cada linha é um registro com campos
+ * separados por ';' (linhas vazias e iniciadas por '#' são ignoradas):
+ *   territorio;Nome;Cor;Tropas
+ *   fronteira;Nome A;Nome B
+ *   regiao;Nome;Bônus;Território A,Território B,...
+ * As fronteiras valem nos dois sentidos e são guardadas em CSR; só
+ * territórios vizinhos podem se atacar. Cada território fica em no máximo
+ * uma região, e quem domina a região inteira ganha o bônus no reforço.
+ * Parâmetros:
+ *   - caminho: caminho do arquivo de texto
+ * Retorna:
+ *   - Ponteiro para o mapa carregado ou NULL em caso de erro (já informado)
+ */
+Mapa* carregarMapaTexto(const char *caminho) {
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        printf("❌ Não foi possível abrir o mapa %s!\n", caminho);
+        return NULL;
+    }
+    // O tamanho vem de fseek()/ftell(): um pipe (ex.: /dev/stdin) não serve
+    long tamanho = (fseek(arquivo, 0, SEEK_END) == 0) ? ftell(arquivo) : -1;
+    if (tamanho < 0 || fseek(arquivo, 0, SEEK_SET) != 0) {
+        printf("❌ O mapa %s precisa ser um arquivo comum (não é possível medir o seu tamanho)!\n", caminho);
+        fclose(arquivo);
+        return NULL;
+    }
+    
+    char *conteudo = (char*) malloc((size_t) tamanho + 1);
+    if (conteudo == NULL || fread(conteudo, 1, (size_t) tamanho, arquivo) != (size_t) tamanho) {
+        printf("❌ Erro ao ler o mapa %s!\n", caminho);
+        free(conteudo);
+        fclose(arquivo);
+        return NULL;
+    }
+    fclose(arquivo);
+    conteudo[tamanho] = '\0';
+    
+    // 1ª passada: conta territórios e fronteiras para alocar tudo de uma vez.
+    // Reconhece os tipos como a 2ª passada (com espaços nas pontas), senão
+    // uma linha indentada seria gravada sem ter sido contada.
+    int numTerritorios = 0, numFronteiras = 0;
+    for (char *linha = conteudo; linha != NULL && *linha; ) {
+        if (registroDoTipo(linha, "territorio")) {
+            numTerritorios++;
+        } else if (registroDoTipo(linha, "fronteira")) {
+            numFronteiras++;
+        }
+        if (numTerritorios > MAX_TERRITORIOS || numFronteiras > MAX_FRONTEIRAS) {
+            break;
+        }
+        linha = strchr(linha, '\n');
+        linha = linha ? linha + 1 : NULL;
+    }
+    
+    if (numTerritorios == 0 || numTerritorios > MAX_TERRITORIOS || numFronteiras > MAX_FRONTEIRAS) {
+        if (numTerritorios == 0) {
+            printf("❌ O mapa %s não tem nenhum território!\n", caminho);
+        } else {
+            printf("❌ O mapa %s passa do limite de %d territórios ou %d fronteiras!\n",
+                   caminho, MAX_TERRITORIOS, MAX_FRONTEIRAS);
+        }
+        free(conteudo);
+        return NULL;
+    }
+    
+    Mapa *mapa = alocarMapa(numTerritorios);
+    size_t tamanhoIndice = 1;
+    while (tamanhoIndice < 2 * (size_t) numTerritorios) {
+        tamanhoIndice <<= 1;
+    }
+    // Índice das fronteiras já lidas, para recusar pares repetidos (A;B duas vezes ou A;B e B;A)
+    size_t tamanhoPares = 1;
+    while (tamanhoPares < 2 * (size_t) numFronteiras) {
+        tamanhoPares <<= 1;
+    }
+    int32_t *indice = (int32_t*) malloc(tamanhoIndice * sizeof(int32_t));
+    uint64_t *pares = (uint64_t*) malloc(tamanhoPares * sizeof(uint64_t));
+    uint32_t (*fronteiras)[2] = (uint32_t(*)[2]) malloc(((size_t) numFronteiras + 1) * sizeof(*fronteiras));
+    int32_t *membros = (int32_t*) malloc((size_t) numTerritorios * sizeof(int32_t));
+    if (mapa == NULL || indice == NULL || pares == NULL || fronteiras == NULL || membros == NULL) {
+        printf("❌ Erro ao alocar memória para o mapa!\n");
+        liberarMemoria(mapa);
+        free(indice);
+        free(pares);
+        free(fronteiras);
+        free(membros);
+        free(conteudo);
+        return NULL;
+    }
+    memset(indice, 0xFF, tamanhoIndice * sizeof(int32_t));
+    memset(pares, 0xFF, tamanhoPares * sizeof(uint64_t));
+    
+    // 2ª passada: territórios e fronteiras, na ordem do arquivo
+    int territorio = 0, fronteira = 0, numeroLinha = 0, erro = 0;
+    char *linha = conteudo;
+    while (!erro && linha != NULL && *linha) {
+        char *fimLinha = strchr(linha, '\n');
+        if (fimLinha != NULL) {
+            *fimLinha = '\0';
+        }
+        numeroLinha++;
+        
+        char *cursor = linha;
+        char *tipo = proximoCampo(&cursor);
+        if (tipo[0] == '\0' || tipo[0] == '#') {
+            // Linha vazia ou comentário
+        } else if (strcmp(tipo, "territorio") == 0) {
+            char *nome = proximoCampo(&cursor);
+            char *cor = proximoCampo(&cursor);
+            char *tropas = proximoCampo(&cursor);
+            uint32_t posicao = nome ? buscarIndiceNome(mapa, indice, tamanhoIndice - 1, nome) : 0;
+            
+            if (territorio >= numTerritorios) {
+                printf("❌ %s:%d: território além dos contados na leitura do mapa!\n", caminho, numeroLinha);
+                erro = 1;
+            } else if (tropas == NULL || nome[0] == '\0' || cor[0] == '\0' || atoi(tropas) < 1) {
+                printf("❌ %s:%d: use territorio;Nome;Cor;Tropas (tropas >= 1)\n", caminho, numeroLinha);
+                erro = 1;
+            } else if (indice[posicao] >= 0) {
+                printf("❌ %s:%d: território %s repetido!\n", caminho, numeroLinha, nome);
+                erro = 1;
+            } else {
+                int idCor = internarTexto(mapa->cores, cor);
+                if (idCor < 0 || idCor >= MAX_CORES || adicionarTexto(mapa->nomes, nome) < 0) {
+                    printf("❌ %s:%d: limite de %d cores excedido ou memória insuficiente!\n",
+                           caminho, numeroLinha, MAX_CORES);
+                    erro = 1;
+                } else {
+                    indice[posicao] = territorio;
+                    mapa->cor[territorio] = (IdCor) idCor;
+                    mapa->tropas[territorio] = atoi(tropas);
+                    territorio++;
+                }
+            }
+        } else if (strcmp(tipo, "fronteira") == 0) {
+            char *nomeA = proximoCampo(&cursor);
+            char *nomeB = proximoCampo(&cursor);
+            int32_t a = nomeA ? indice[buscarIndiceNome(mapa, indice, tamanhoIndice - 1, nomeA)] : -1;
+            int32_t b = nomeB ? indice[buscarIndiceNome(mapa, indice, tamanhoIndice - 1, nomeB)] : -1;
+            
+            if (fronteira >= numFronteiras) {
+                printf("❌ %s:%d: fronteira além das contadas na leitura do mapa!\n", caminho, numeroLinha);
+                erro = 1;
+            } else if (a < 0 || b < 0 || a == b) {
+                printf("❌ %s:%d: fronteira entre territórios inexistentes ou iguais!\n", caminho, numeroLinha);
+                erro = 1;
+            } else {
+                uint64_t par = (a < b) ? ((uint64_t) a << 32 | (uint32_t) b) : ((uint64_t) b << 32 | (uint32_t) a);
+                uint32_t posicao = buscarIndicePar(pares, (uint32_t) (tamanhoPares - 1), par);
+                if (pares[posicao] == par) {
+                    printf("❌ %s:%d: fronteira entre %s e %s repetida!\n", caminho, numeroLinha, nomeA, nomeB);
+                    erro = 1;
+                } else {
+                    pares[posicao] = par;
+                    fronteiras[fronteira][0] = (uint32_t) a;
+                    fronteiras[fronteira][1] = (uint32_t) b;
+                    fronteira++;
+                }
+            }
+        } else if (strcmp(tipo, "regiao") == 0) {
+            char *nome = proximoCampo(&cursor);
+            char *bonus = proximoCampo(&cursor);
+            char *lista = proximoCampo(&cursor);
+            
+            if (lista == NULL || nome[0] == '\0' || lista[0] == '\0' || atoi(bonus) < 0) {
+                printf("❌ %s:%d: use regiao;Nome;Bônus;Território A,Território B,... (bônus >= 0)\n",
+                       caminho, numeroLinha);
+                erro = 1;
+            }
+            int numMembros = 0;
+            char *item;
+            while (!erro && (item = proximoItemLista(&lista)) != NULL) {
+                int32_t membro = indice[buscarIndiceNome(mapa, indice, tamanhoIndice - 1, item)];
+                if (membro < 0) {
+                    printf("❌ %s:%d: o território \"%s\" não existe neste mapa\n", caminho, numeroLinha, item);
+                    erro = 1;
+                } else if (numMembros == numTerritorios) {
+                    printf("❌ %s:%d: território repetido na região %s!\n", caminho, numeroLinha, nome);
+                    erro = 1;
+                } else {
+                    membros[numMembros++] = membro;
+                }
+            }
+            if (!erro) {
+                int status = definirRegiao(mapa, nome, atoi(bonus), membros, numMembros);
+                if (status == 2) {
+                    printf("❌ %s:%d: território repetido ou já em outra região (região %s)!\n",
+                           caminho, numeroLinha, nome);
+                } else if (status == 3) {
+                    printf("❌ %s:%d: região %s repetida!\n", caminho, numeroLinha, nome);
+                } else if (status != 0) {
+                    printf("❌ Erro ao alocar memória para as regiões!\n");
+                }
+                erro = (status != 0);
+            }
+        } else {
+            printf("❌ %s:%d: tipo de registro desconhecido: %s\n", caminho, numeroLinha, tipo);
+            erro = 1;
+        }
+        
+        linha = fimLinha ? fimLinha + 1 : NULL;
+    }
+    free(indice);
+    free(pares);
+    free(membros);
+    free(conteudo);
+    
+    if (!erro && (definirFronteiras(mapa, (const uint32_t (*)[2]) fronteiras, fronteira) != 0
+                  || recalcularContagens(mapa) != 0)) {
+        printf("❌ Erro ao alocar memória para as fronteiras!\n");
+        erro = 1;
+    }
+    free(fronteiras);
+    
+    if (erro) {
+        liberarMemoria(mapa);
+        return NULL;
+    }
+    return mapa;
+}
+
+/**
+ * verificarInvariantes()
+ * Confere num mapa binário as regras que o carregador de texto garante ao
+ * ler cada linha: tropas >= 1, nenhuma fronteira de um território consigo
+ * mesmo nem repetida, bônus >= 0, cada região com o tamanho declarado e
+ * nomes de territórios e de regiões sem repetição. Os IDs já foram validados.
+ * Parâmetros:
+ *   - mapa: mapa recém-mapeado
+ * Retorna:
+ *   - 0 se o mapa é consistente, 1 em falha de memória, 2 se não é
+ */
+static int verificarInvariantes(const Mapa *mapa) {
+    // visto[v] = último território em cuja lista v apareceu (acha vizinhos repetidos em O(fronteiras))
+    int32_t *visto = (int32_t*) malloc((size_t) mapa->quantidade * sizeof(int32_t));
+    if (visto == NULL) {
+        return 1;
+    }
+    memset(visto, 0xFF, (size_t) mapa->quantidade * sizeof(int32_t));
+    int consistente = 1;
+    for (int i = 0; consistente && i < mapa->quantidade; i++) {
+        consistente = mapa->tropas[i] >= 1;
+        for (uint32_t v = mapa->inicioVizinhos[i]; consistente && v < mapa->inicioVizinhos[i + 1]; v++) {
+            uint32_t vizinho = mapa->vizinhos[v];
+            consistente = vizinho != (uint32_t) i && visto[vizinho] != i;
+            visto[vizinho] = i;
+        }
+    }
+    free(visto);
+    
+    if (consistente && mapa->numRegioes > 0) {
+        int32_t *membros = (int32_t*) calloc((size_t) mapa->numRegioes, sizeof(int32_t));
+        if (membros == NULL) {
+            return 1;
+        }
+        for (int i = 0; i < mapa->quantidade; i++) {
+            if (mapa->regiaoDe[i] >= 0) {
+                membros[mapa->regiaoDe[i]]++;
+            }
+        }
+        for (int r = 0; consistente && r < mapa->numRegioes; r++) {
+            consistente = mapa->bonusRegiao[r] >= 0 && membros[r] == mapa->tamanhoRegiao[r];
+        }
+        free(membros);
+    }
+    if (!consistente) {
+        return 2;
+    }
+    
+    int status = textosRepetidos(mapa->nomes);
+    return (status != 0) ? status : textosRepetidos(mapa->regioes);
+}
+
+/**
+ * mapearMapaBinario()
+ * Mapeia um arquivo de mapa binário em memória e o usa no próprio lugar,
+ * sem copiar os vetores: o carregamento só valida o cabeçalho, os IDs
+ * e os mesmos invariantes do mapa de texto.
+ * O mapeamento é privado, então as mudanças da partida não vão para o arquivo.
+ * Parâmetros:
+ *   - caminho: caminho do arquivo binário
+ * Retorna:
+ *   - Ponteiro para o mapa ou NULL em caso de erro (já informado)
+ */
+Mapa* mapearMapaBinario(const char *caminho) {
+    int descritor = open(caminho, O_RDONLY);
+    struct stat info;
+    if (descritor < 0 || fstat(descritor, &info) != 0) {
+        printf("❌ Não foi possível abrir o mapa %s!\n", caminho);
+        if (descritor >= 0) {
+            close(descritor);
+        }
+        return NULL;
+    }
+    
+    size_t tamanho = (size_t) info.st_size;
+    void *base = (tamanho >= sizeof(CabecalhoMapa))
+               ? mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE, descritor, 0)
+               : MAP_FAILED;
+    close(descritor);
+    if (base == MAP_FAILED) {
+        printf("❌ Não foi possível mapear o mapa %s!\n", caminho);
+        return NULL;
+    }
+    
+    const CabecalhoMapa *cabecalho = (const CabecalhoMapa*) base;
+    uint64_t n = cabecalho->numTerritorios;
+    // Arquivos da versão 1 não têm regiões (nem os campos finais do cabeçalho)
+    uint64_t numRegioes = (cabecalho->versao >= 2) ? cabecalho->numRegioes : 0;
+    
+    // Cada seção precisa caber inteira no arquivo
+    struct { uint64_t deslocamento, bytes; } secoes[] = {
+        {cabecalho->secaoCor, n * sizeof(IdCor)},
+        {cabecalho->secaoTropas, n * sizeof(int32_t)},
+        {cabecalho->secaoNomes, n * sizeof(uint32_t)},
+        {cabecalho->secaoCores, (uint64_t) cabecalho->numCores * sizeof(uint32_t)},
+        {cabecalho->secaoInicioVizinhos, (n + 1) * sizeof(uint32_t)},
+        {cabecalho->secaoVizinhos, (uint64_t) cabecalho->numVizinhos * sizeof(uint32_t)},
+        {cabecalho->secaoTextos, cabecalho->tamanhoTextos},
+        {numRegioes ? cabecalho->secaoRegiaoDe : 0, numRegioes ? n * sizeof(int32_t) : 0},
+        {numRegioes ? cabecalho->secaoTamanhoRegioes : 0, numRegioes * sizeof(int32_t)},
+        {numRegioes ? cabecalho->secaoBonusRegioes : 0, numRegioes * sizeof(int32_t)},
+        {numRegioes ? cabecalho->secaoRegioes : 0, numRegioes * sizeof(uint32_t)},
+    };
+    int valido = (cabecalho->versao == 1 || cabecalho->versao == VERSAO_MAPA) && n > 0 && n <= MAX_TERRITORIOS
+              && cabecalho->numCores <= MAX_CORES && cabecalho->tamanhoTextos > 0 && numRegioes < INT32_MAX;
+    for (size_t i = 0; valido && i < sizeof(secoes) / sizeof(secoes[0]); i++) {
+        valido = secoes[i].deslocamento % 8 == 0 && secoes[i].deslocamento <= tamanho
+              && secoes[i].bytes <= tamanho - secoes[i].deslocamento;
+    }
+    
+    Mapa *mapa = valido ? (Mapa*) calloc(1, sizeof(Mapa)) : NULL;
+    TabelaTextos *nomes = valido ? (TabelaTextos*) calloc(1, sizeof(TabelaTextos)) : NULL;
+    TabelaTextos *cores = valido ? (TabelaTextos*) calloc(1, sizeof(TabelaTextos)) : NULL;
+    TabelaTextos *regioes = valido ? (TabelaTextos*) calloc(1, sizeof(TabelaTextos)) : NULL;
+    if (mapa == NULL || nomes == NULL || cores == NULL || regioes == NULL) {
+        printf("❌ O arquivo %s não é um mapa binário válido (versão %d)!\n", caminho, VERSAO_MAPA);
+        free(mapa);
+        free(nomes);
+        free(cores);
+        free(regioes);
+        munmap(base, tamanho);
+        return NULL;
+    }
+    
+    char *bytes = (char*) base;
+    char *textos = bytes + cabecalho->secaoTextos;
+    nomes->caracteres = textos;
+    nomes->tamanho = cabecalho->tamanhoTextos;
+    nomes->inicio = (uint32_t*) (bytes + cabecalho->secaoNomes);
+    nomes->quantidade = (int) n;
+    cores->caracteres = textos;
+    cores->tamanho = cabecalho->tamanhoTextos;
+    cores->inicio = (uint32_t*) (bytes + cabecalho->secaoCores);
+    cores->quantidade = (int) cabecalho->numCores;
+    if (numRegioes > 0) {
+        regioes->caracteres = textos;
+        regioes->tamanho = cabecalho->tamanhoTextos;
+        regioes->inicio = (uint32_t*) (bytes + cabecalho->secaoRegioes);
+        regioes->quantidade = (int) numRegioes;
+        mapa->numRegioes = (int) numRegioes;
+        mapa->regiaoDe = (int32_t*) (bytes + cabecalho->secaoRegiaoDe);
+        mapa->tamanhoRegiao = (int32_t*) (bytes + cabecalho->secaoTamanhoRegioes);
+        mapa->bonusRegiao = (int32_t*) (bytes + cabecalho->secaoBonusRegioes);
+    }
+    
+    mapa->quantidade = (int) n;
+    mapa->cor = (IdCor*) (bytes + cabecalho->secaoCor);
+    mapa->tropas = (int32_t*) (bytes + cabecalho->secaoTropas);
+    mapa->nomes = nomes;
+    mapa->cores = cores;
+    mapa->regioes = regioes;
+    mapa->inicioVizinhos = (uint32_t*) (bytes + cabecalho->secaoInicioVizinhos);
+    mapa->vizinhos = (uint32_t*) (bytes + cabecalho->secaoVizinhos);
+    mapa->arquivo = base;
+    mapa->tamanhoArquivo = tamanho;
+    
+    // Valida os IDs (um arquivo corrompido não pode gerar acesso fora dos vetores)
+    valido = textos[cabecalho->tamanhoTextos - 1] == '\0';
+    for (uint64_t i = 0; valido && i < n; i++) {
+        valido = mapa->cor[i] < cabecalho->numCores && nomes->inicio[i] < cabecalho->tamanhoTextos;
+    }
+    for (uint32_t c = 0; valido && c < cabecalho->numCores; c++) {
+        valido = cores->inicio[c] < cabecalho->tamanhoTextos;
+    }
+    if (valido) {
+        valido = mapa->inicioVizinhos[0] == 0 && mapa->inicioVizinhos[n] == cabecalho->numVizinhos;
+        for (uint64_t i = 0; valido && i < n; i++) {
+            valido = mapa->inicioVizinhos[i] <= mapa->inicioVizinhos[i + 1];
+        }
+        for (uint32_t v = 0; valido && v < cabecalho->numVizinhos; v++) {
+            valido = mapa->vizinhos[v] < n;
+        }
+    }
+    for (uint64_t i = 0; valido && numRegioes > 0 && i < n; i++) {
+        valido = mapa->regiaoDe[i] >= -1 && mapa->regiaoDe[i] < (int64_t) numRegioes;
+    }
+    for (uint64_t r = 0; valido && r < numRegioes; r++) {
+        valido = regioes->inicio[r] < cabecalho->tamanhoTextos && mapa->tamanhoRegiao[r] > 0;
+    }
+    int status = valido ? verificarInvariantes(mapa) : 2;
+    if (status == 2) {
+        printf("❌ O mapa binário %s está corrompido!\n", caminho);
+        liberarMemoria(mapa);
+        return NULL;
+    }
+    
+    if (status != 0 || recalcularContagens(mapa) != 0) {
+        printf("❌ Erro ao alocar memória para o mapa!\n");
+        liberarMemoria(mapa);
+        return NULL;
+    }
+    return mapa;
+}
+
+/**
+ * escreverSecao()
+ * Escreve uma seção do mapa binário, completando com zeros até múltiplo de 8.
+ * Retorna:
+ *   - Deslocamento da próxima seção
+ */
+static uint64_t escreverSecao(FILE *arquivo, const void *dados, uint64_t bytes, uint64_t deslocamento) {
+    static const char zeros[8] = {0};
+    if (bytes > 0) {
+        fwrite(dados, 1, bytes, arquivo);
+    }
+    uint64_t preenchimento = (8 - bytes % 8) % 8;
+    fwrite(zeros, 1, preenchimento, arquivo);
+    return deslocamento + bytes + preenchimento;
+}
+
+/**
+ * salvarMapaBinario()
+ * Grava o mapa no formato binário descrito em CabecalhoMapa.
+ * Os nomes de territórios, de cores e de regiões vão para um único bloco de
+ * textos.
+ * Parâmetros:
+ *   - mapa: mapa a ser gravado (const - apenas leitura)
+ *   - caminho: arquivo de destino
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro (já informado)
+ */
+int salvarMapaBinario(const Mapa *mapa, const char *caminho) {
+    int n = mapa->quantidade;
+    int numCores = mapa->cores->quantidade;
+    int numRegioes = mapa->numRegioes;
+    uint32_t numVizinhos = mapa->inicioVizinhos[n];
+    
+    // Bloco de textos: nomes dos territórios, das cores e das regiões
+    uint32_t *inicioNomes = (uint32_t*) malloc(n * sizeof(uint32_t));
+    uint32_t *inicioCores = (uint32_t*) malloc((numCores + 1) * sizeof(uint32_t));
+    uint32_t *inicioRegioes = (uint32_t*) malloc((numRegioes + 1) * sizeof(uint32_t));
+    size_t tamanhoTextos = mapa->nomes->tamanho + mapa->cores->tamanho + mapa->regioes->tamanho;
+    char *textos = (char*) malloc(tamanhoTextos);
+    if (inicioNomes == NULL || inicioCores == NULL || inicioRegioes == NULL || textos == NULL) {
+        printf("❌ Erro ao alocar memória para gravar o mapa!\n");
+        free(inicioNomes);
+        free(inicioCores);
+        free(inicioRegioes);
+        free(textos);
+        return 1;
+    }
+    
+    size_t usado = 0;
+    for (int i = 0; i < n; i++) {
+        const char *nome = nomeTerritorio(mapa, i);
+        size_t bytes = strlen(nome) + 1;
+        memcpy(textos + usado, nome, bytes);
+        inicioNomes[i] = (uint32_t) usado;
+        usado += bytes;
+    }
+    for (int c = 0; c < numCores; c++) {
+        const char *cor = nomeCor(mapa, (IdCor) c);
+        size_t bytes = strlen(cor) + 1;
+        memcpy(textos + usado, cor, bytes);
+        inicioCores[c] = (uint32_t) usado;
+        usado += bytes;
+    }
+    for (int r = 0; r < numRegioes; r++) {
+        const char *regiao = textoDe(mapa->regioes, r);
+        size_t bytes = strlen(regiao) + 1;
+        memcpy(textos + usado, regiao, bytes);
+        inicioRegioes[r] = (uint32_t) usado;
+        usado += bytes;
+    }
+    
+    CabecalhoMapa cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.assinatura, ASSINATURA_MAPA, sizeof(cabecalho.assinatura));
+    cabecalho.versao = VERSAO_MAPA;
+    cabecalho.numTerritorios = (uint32_t) n;
+    cabecalho.numCores = (uint32_t) numCores;
+    cabecalho.numVizinhos = numVizinhos;
+    cabecalho.tamanhoTextos = usado;
+    cabecalho.numRegioes = (uint32_t) numRegioes;
+    
+    // Calcula os deslocamentos das seções (todas alinhadas em 8 bytes)
+    enum { NUM_SECOES = 11 };
+    uint64_t deslocamento = (sizeof(CabecalhoMapa) + 7) & ~(uint64_t) 7;
+    uint64_t *secoes[NUM_SECOES] = {&cabecalho.secaoCor, &cabecalho.secaoTropas, &cabecalho.secaoNomes,
+                                    &cabecalho.secaoCores, &cabecalho.secaoInicioVizinhos, &cabecalho.secaoVizinhos,
+                                    &cabecalho.secaoTextos, &cabecalho.secaoRegiaoDe, &cabecalho.secaoTamanhoRegioes,
+                                    &cabecalho.secaoBonusRegioes, &cabecalho.secaoRegioes};
+    uint64_t tamanhos[NUM_SECOES] = {n * sizeof(IdCor), n * sizeof(int32_t), n * sizeof(uint32_t),
+                                     numCores * sizeof(uint32_t), (n + 1) * sizeof(uint32_t),
+                                     numVizinhos * sizeof(uint32_t), usado,
+                                     numRegioes ? n * sizeof(int32_t) : 0, numRegioes * sizeof(int32_t),
+                                     numRegioes * sizeof(int32_t), numRegioes * sizeof(uint32_t)};
+    for (int i = 0; i < NUM_SECOES; i++) {
+        *secoes[i] = deslocamento;
+        deslocamento += (tamanhos[i] + 7) & ~(uint64_t) 7;
+    }
+    
+    FILE *arquivo = fopen(caminho, "wb");
+    int erro = (arquivo == NULL);
+    if (!erro) {
+        const void *dados[NUM_SECOES] = {mapa->cor, mapa->tropas, inicioNomes, inicioCores, mapa->inicioVizinhos,
+                                         mapa->vizinhos, textos, mapa->regiaoDe, mapa->tamanhoRegiao,
+                                         mapa->bonusRegiao, inicioRegioes};
+        deslocamento = escreverSecao(arquivo, &cabecalho, sizeof(cabecalho), 0);
+        for (int i = 0; i < NUM_SECOES; i++) {
+            deslocamento = escreverSecao(arquivo, dados[i], tamanhos[i], deslocamento);
+        }
+        erro = ferror(arquivo);
+        erro |= (fclose(arquivo) != 0);
+    }
+    if (erro) {
+        printf("❌ Erro ao gravar o mapa %s!\n", caminho);
+    }
+    
+    free(inicioNomes);
+    free(inicioCores);
+    free(inicioRegioes);
+    free(textos);
+    return erro ? 1 : 0;
+}
+
+/**
+ * converterMapa()
+ * Converte um mapa de texto para o formato binário mapeável.
+ * Parâmetros:
+ *   - origem: mapa de texto
+ *   - destino: arquivo binário a ser criado
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro
+ */
+int converterMapa(const char *origem, const char *destino) {
+    Mapa *mapa = carregarMapaTexto(origem);
+    if (mapa == NULL) {
+        return 1;
+    }
+    
+    int status = salvarMapaBinario(mapa, destino);
+    if (status == 0) {
+        printf("✓ Mapa convertido: %d territórios, %d cores, %u fronteiras, %d regiões → %s\n",
+               mapa->quantidade, mapa->cores->quantidade,
+               mapa->inicioVizinhos[mapa->quantidade] / 2, mapa->numRegioes, destino);
+    }
+    liberarMemoria(mapa);
+    return status;
+}
+
+/**
+ * criarTela()
+ * Prepara a saída do jogo. Em um terminal onde o mapa cabe, ele fica fixo
+ * no topo (as mensagens rolam em uma região abaixo dele) e cada quadro só
+ * reescreve as linhas que mudaram; fora de um terminal, cada quadro mostra
+ * só os territórios que mudaram desde o anterior.
+ * Parâmetros:
+ *   - silenciosa: 1 para não desenhar nada (sessões automatizadas)
+ * Retorna:
+ *   - Ponteiro para a tela, ou NULL em caso de erro
+ */
+Tela* criarTela(int silenciosa) {
+    Tela *tela = (Tela*) calloc(1, sizeof(Tela));
+    if (tela == NULL) {
+        return NULL;
+    }
+    tela->silenciosa = silenciosa;
+    
+    const char *terminal = getenv("TERM");
+    struct winsize janela;
+    if (!silenciosa && isatty(STDOUT_FILENO) && terminal != NULL && strcmp(terminal, "dumb") != 0 &&
+        ioctl(STDOUT_FILENO, TIOCGWINSZ, &janela) == 0 && janela.ws_row > 0) {
+        tela->linhasTerminal = janela.ws_row;
+    }
+    return tela;
+}
+
+/**
+ * liberarTela()
+ * Devolve o terminal ao modo normal (se o mapa estava fixo) e libera a tela.
+ * Parâmetros:
+ *   - tela: tela a liberar (pode ser NULL)
+ */
+void liberarTela(Tela *tela) {
+    if (tela == NULL) {
+        return;
+    }
+    if (tela->fixa) {
+        escreverTela(tela, "\033[r\033[%d;1H\n", tela->linhasTerminal);
+        descarregarTela(tela);
+    }
+    free(tela->buffer);
+    free(tela->corAnterior);
+    free(tela->tropasAnterior);
+    free(tela);
+}
+
+/**
+ * escreverTela()
+ * Acrescenta texto formatado (como printf) ao quadro em montagem.
+ * Parâmetros:
+ *   - tela: tela do jogo
+ *   - formato: formato do printf, seguido dos valores
+ */
+void escreverTela(Tela *tela, const char *formato, ...) {
+    if (tela->silenciosa) {
+        return;
+    }
+    
+    va_list argumentos;
+    va_start(argumentos, formato);
+    int tamanho = vsnprintf(tela->buffer + tela->usado, tela->capacidade - tela->usado, formato, argumentos);
+    va_end(argumentos);
+    if (tamanho < 0) {
+        return;
+    }
+    
+    if (tela->usado + (size_t) tamanho >= tela->capacidade) {
+        size_t capacidade = tela->capacidade ? tela->capacidade : 4096;
+        while (tela->usado + (size_t) tamanho >= capacidade) {
+            capacidade *= 2;
+        }
+        char *buffer = (char*) realloc(tela->buffer, capacidade);
+        if (buffer == NULL) {
+            return;
+        }
+        tela->buffer = buffer;
+        tela->capacidade = capacidade;
+        
+        va_start(argumentos, formato);
+        vsnprintf(tela->buffer + tela->usado, tela->capacidade - tela->usado, formato, argumentos);
+        va_end(argumentos);
+    }
+    tela->usado += (size_t) tamanho;
+}
+
+/**
+ * descarregarTela()
+ * Envia o quadro montado ao terminal com uma única chamada write().
+ * Parâmetros:
+ *   - tela: tela do jogo
+ */
+void descarregarTela(Tela *tela) {
+    // O que já foi escrito com printf precisa aparecer antes do quadro
+    fflush(stdout);
+    
+    size_t enviado = 0;
+    while (enviado < tela->usado) {
+        ssize_t escrito = write(STDOUT_FILENO, tela->buffer + enviado, tela->usado - enviado);
+        if (escrito <= 0) {
+            break;
+        }
+        enviado += (size_t) escrito;
+    }
+    tela->usado = 0;
+}
+
+/**
+ * escreverLinhaTerritorio()
+ * Acrescenta ao quadro a linha da tabela de um território.
+ */
+static void escreverLinhaTerritorio(Tela *tela, const Mapa *mapa, int i) {
+    escreverTela(tela, "│ %2d │ %-22s │ %-22s │  %5d  │\n",
+                 i + 1,
+                 nomeTerritorio(mapa, i),
+                 nomeCor(mapa, mapa->cor[i]),
+                 mapa->tropas[i]);
+}
+
+/**
+ * exibirMapa()
+ * Exibe o estado atual de todos os territórios formatado como uma tabela.
+ * Só o primeiro quadro desenha a tabela inteira; os seguintes reescrevem
+ * apenas os territórios cujo dono ou tropas mudaram desde o quadro anterior.
+ * Parâmetros:
+ *   - tela: tela do jogo (o quadro só é enviado por descarregarTela())
+ *   - mapa: mapa a ser exibido (const - apenas leitura)
+ */
+void exibirMapa(Tela *tela, const Mapa *mapa) {
+    if (tela->silenciosa) {
+        return;
+    }
+    INICIAR_MEDICAO(inicio);
+    
+    int n = mapa->quantidade;
+    if (tela->corAnterior == NULL || tela->quantidade != n) {
+        free(tela->corAnterior);
+        free(tela->tropasAnterior);
+        tela->corAnterior = (IdCor*) malloc((size_t) n * sizeof(IdCor));
+        tela->tropasAnterior = (int32_t*) malloc((size_t) n * sizeof(int32_t));
+        tela->quantidade = n;
+        tela->desenhada = 0;
+        if (tela->corAnterior == NULL || tela->tropasAnterior == NULL) {
+            free(tela->corAnterior);
+            free(tela->tropasAnterior);
+            tela->corAnterior = NULL;
+            tela->tropasAnterior = NULL;
+        }
+    }
+    
+    if (!tela->desenhada || tela->corAnterior == NULL) {
+        // O mapa fica fixo no topo se couber com folga para as mensagens
+        int alturaMapa = n + LINHAS_MOLDURA_MAPA;
+        tela->fixa = tela->linhasTerminal > 0 && alturaMapa + LINHAS_MINIMAS_ROLAGEM <= tela->linhasTerminal;
+        if (tela->fixa) {
+            escreverTela(tela, "\033[H\033[2J");
+        }
+        
+        escreverTela(tela, "╔════════════════════════════════════════════════════════════════╗\n");
+        escreverTela(tela, "║                    🗺️  MAPA DOS TERRITÓRIOS 🗺️                ║\n");
+        escreverTela(tela, "╚════════════════════════════════════════════════════════════════╝\n\n");
+        
+        escreverTela(tela, "┌────┬────────────────────────┬────────────────────────┬─────────┐\n");
+        escreverTela(tela, "│ Nº │      TERRITÓRIO        │    COR DO EXÉRCITO     │ TROPAS  │\n");
+        escreverTela(tela, "├────┼────────────────────────┼────────────────────────┼─────────┤\n");
+        
+        for (int i = 0; i < n; i++) {
+            escreverLinhaTerritorio(tela, mapa, i);
+        }
+        
+        escreverTela(tela, "└────┴────────────────────────┴────────────────────────┴─────────┘\n");
+        
+        if (tela->fixa) {
+            // As mensagens rolam só nas linhas abaixo do mapa
+            escreverTela(tela, "\033[%d;%dr\033[%d;1H", alturaMapa + 1, tela->linhasTerminal, alturaMapa + 1);
+        }
+        tela->desenhada = (tela->corAnterior != NULL);
+    } else if (tela->fixa) {
+        // Reescreve no lugar só as linhas alteradas, preservando o cursor
+        int alteradas = 0;
+        for (int i = 0; i < n; i++) {
+            if (mapa->cor[i] != tela->corAnterior[i] || mapa->tropas[i] != tela->tropasAnterior[i]) {
+                if (alteradas++ == 0) {
+                    escreverTela(tela, "\0337");
+                }
+                escreverTela(tela, "\033[%d;1H", LINHAS_ANTES_DA_TABELA + i + 1);
+                escreverLinhaTerritorio(tela, mapa, i);
+            }
+        }
+        if (alteradas > 0) {
+            escreverTela(tela, "\0338");
+        }
+    } else {
+        // Sem terminal: lista apenas os territórios que mudaram
+        int alteradas = 0;
+        for (int i = 0; i < n; i++) {
+            if (mapa->cor[i] != tela->corAnterior[i] || mapa->tropas[i] != tela->tropasAnterior[i]) {
+                if (alteradas++ == 0) {
+                    escreverTela(tela, "🗺️  Mudanças no mapa:\n");
+                    escreverTela(tela, "┌────┬────────────────────────┬────────────────────────┬─────────┐\n");
+                }
+                escreverLinhaTerritorio(tela, mapa, i);
+            }
+        }
+        if (alteradas > 0) {
+            escreverTela(tela, "└────┴────────────────────────┴────────────────────────┴─────────┘\n");
+        } else {
+            escreverTela(tela, "🗺️  Nenhuma mudança no mapa.\n");
+        }
+    }
+    
+    if (tela->corAnterior != NULL) {
+        memcpy(tela->corAnterior, mapa->cor, (size_t) n * sizeof(IdCor));
+        memcpy(tela->tropasAnterior, mapa->tropas, (size_t) n * sizeof(int32_t));
+    }
+    ENCERRAR_MEDICAO(TEMPO_EXIBIR_MAPA, inicio);
+}
+
+/**
+ * exibirMenuPrincipal()
+ * Exibe o menu de opções disponíveis para o jogador.
+ * Parâmetros:
+ *   - tela: tela do jogo
+ */
+void exibirMenuPrincipal(Tela *tela) {
+    escreverTela(tela, "\n╔════════════════════════════════════════════════════════════════╗\n");
+    escreverTela(tela, "║                        MENU PRINCIPAL                          ║\n");
+    escreverTela(tela, "╠════════════════════════════════════════════════════════════════╣\n");
+    escreverTela(tela, "║  [1] ⚔️  Fase de Ataque                                        ║\n");
+    escreverTela(tela, "║  [2] 🎯 Verificar Missão                                       ║\n");
+    escreverTela(tela, "║  [3] ↩️  Desfazer Turno                                        ║\n");
+    escreverTela(tela, "║  [0] 🏳️  Sair do Jogo                                          ║\n");
+    escreverTela(tela, "╚════════════════════════════════════════════════════════════════╝\n\n");
+}
+
+/**
+ * escreverCelula()
+ * Escreve um texto alinhado à esquerda em uma coluna de "largura" caracteres,
+ * contando caracteres UTF-8 (e não bytes) para que os acentos não desalinhem
+ * a moldura.
+ */
+static void escreverCelula(Tela *tela, const char *texto, int largura) {
+    int caracteres = 0;
+    for (const char *c = texto; *c; c++) {
+        caracteres += ((unsigned char) *c & 0xC0) != 0x80;
+    }
+    escreverTela(tela, "%s%*s", texto, caracteres < largura ? largura - caracteres : 0, "");
+}
+
+/**
+ * exibirMissao()
+ * Exibe a descrição da missão atual do jogador, tirada do catálogo de
+ * missões do mapa.
+ * Parâmetros:
+ *   - tela: tela do jogo
+ *   - mapa: mapa da partida (de onde vem o catálogo)
+ *   - idMissao: identificador da missão (1 a quantidade do catálogo)
+ */
+void exibirMissao(Tela *tela, const Mapa *mapa, int idMissao) {
+    escreverTela(tela, "┌────────────────────────────────────────────────────────────────┐\n");
+    escreverTela(tela, "│                      📜 MISSÃO SECRETA 📜                       │\n");
+    escreverTela(tela, "├────────────────────────────────────────────────────────────────┤\n");
+    
+    const CatalogoMissoes *catalogo = mapa->missoes;
+    if (catalogo != NULL && idMissao >= 1 && idMissao <= catalogo->quantidade) {
+        const Missao *missao = &catalogo->missoes[idMissao - 1];
+        escreverTela(tela, "│  🎯 Objetivo: ");
+        escreverCelula(tela, textoDe(&catalogo->textos, missao->titulo), 49);
+        escreverTela(tela, "│\n");
+        const char *detalhe = textoDe(&catalogo->textos, missao->detalhe);
+        if (detalhe[0] != '\0') {
+            escreverTela(tela, "│     → ");
+            escreverCelula(tela, detalhe, 56);
+            escreverTela(tela, "│\n");
+        }
+    } else {
+        escreverTela(tela, "│  ⚠️  Missão desconhecida!                                      │\n");
+    }
+    
+    escreverTela(tela, "└────────────────────────────────────────────────────────────────┘\n");
+}
+
+/**
+ * posicionarReforco()
+ * Acrescenta tropas de reforço a um território e as anota no registro.
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 se o território passaria de INT32_MAX tropas
+ */
+static int posicionarReforco(Mapa *mapa, int territorio, int tropas, RegistroEventos *registro) {
+    if (mapa->tropas[territorio] > INT32_MAX - tropas) {
+        return 1;
+    }
+    anotarEscrita(mapa, &mapa->tropas[territorio]);
+    mapa->tropas[territorio] += tropas;
+    registrarTropas(registro, territorio, tropas);
+    return 0;
+}
+
+/**
+ * faseDeReforco()
+ * Início do turno do jogador: mostra as tropas de reforço (por territórios
+ * e por regiões dominadas) e pede ao jogador onde posicioná-las, até que
+ * todas tenham sido colocadas em territórios seus.
+ * Parâmetros:
+ *   - mapa: mapa da partida
+ *   - cor: cor do jogador
+ *   - registro: registro de eventos da partida (pode ser NULL)
+ */
+void faseDeReforco(Mapa *mapa, IdCor cor, RegistroEventos *registro) {
+    int reforcos = calcularReforcos(mapa, cor);
+    if (reforcos == 0) {
+        return;
+    }
+    int quantidade = mapa->quantidade;
+    
+    printf("╔════════════════════════════════════════════════════════════════╗\n");
+    printf("║                   🪖 FASE DE REFORÇO 🪖                        ║\n");
+    printf("╚════════════════════════════════════════════════════════════════╝\n\n");
+    
+    printf("Você recebe %d tropas: %d por dominar %d território(s)", reforcos, reforcos - mapa->bonusPorCor[cor],
+           mapa->territoriosPorCor[cor]);
+    if (mapa->regioesPorCor[cor] > 0) {
+        printf(" e %d pelas regiões dominadas:", mapa->bonusPorCor[cor]);
+        int r = mapa->numRegioes;
+        for (int regiao = 0; regiao < r; regiao++) {
+            if (mapa->territoriosPorRegiao[cor * r + regiao] == mapa->tamanhoRegiao[regiao]) {
+                printf(" %s (+%d)", textoDe(mapa->regioes, regiao), mapa->bonusRegiao[regiao]);
+            }
+        }
+    }
+    printf("\n\n");
+    
+    while (reforcos > 0) {
+        int territorio, tropas;
+        printf("Território que recebe tropas (1 a %d, restam %d): ", quantidade, reforcos);
+        int lidos = scanf("%d", &territorio);
+        limparBufferEntrada();
+        if (lidos == EOF) {
+            return;
+        }
+        if (lidos != 1 || territorio < 1 || territorio > quantidade || mapa->cor[territorio - 1] != cor) {
+            printf("❌ Escolha um território do seu exército (%s).\n", nomeCor(mapa, cor));
+            continue;
+        }
+        
+        printf("Quantas tropas (1 a %d)? ", reforcos);
+        lidos = scanf("%d", &tropas);
+        limparBufferEntrada();
+        if (lidos == EOF) {
+            return;
+        }
+        if (lidos != 1 || tropas < 1 || tropas > reforcos) {
+            printf("❌ Quantidade inválida! Escolha de 1 a %d tropas.\n", reforcos);
+            continue;
+        }
+        
+        if (posicionarReforco(mapa, territorio - 1, tropas, registro) != 0) {
+            printf("❌ %s não comporta mais tropas!\n", nomeTerritorio(mapa, territorio - 1));
+            continue;
+        }
+        reforcos -= tropas;
+        printf("✅ %s agora tem %d tropas.\n", nomeTerritorio(mapa, territorio - 1), mapa->tropas[territorio - 1]);
+    }
+    printf("\n");
+}
+
+/**
+ * faseDeAtaque()
+ * Gerencia a interface para a ação de ataque.
+ * Solicita ao jogador os territórios de origem e destino do ataque.
+ * Parâmetros:
+ *   - mapa: mapa da partida
+ *   - gerador: gerador de números aleatórios da partida
+ *   - objetivo: missão do jogador, avisada assim que for cumprida (pode ser NULL)
+ *   - registro: registro de eventos da partida (pode ser NULL)
+ */
+void faseDeAtaque(Mapa *mapa, GeradorAleatorio *gerador, const Objetivo *objetivo, RegistroEventos *registro) {
+    INICIAR_MEDICAO(inicio);
+    int atacante, defensor;
+    int quantidade = mapa->quantidade;
+    
+    printf("╔════════════════════════════════════════════════════════════════╗\n");
+    printf("║                    ⚔️  FASE DE ATAQUE ⚔️                       ║\n");
+    printf("╚════════════════════════════════════════════════════════════════╝\n\n");
+    
+    // Mostra alguns ataques possíveis do jogador (só territórios de fronteira)
+    if (objetivo != NULL) {
+        Ataque sugestoes[MAX_SUGESTOES_ATAQUE];
+        int total = listarAtaques(mapa, objetivo->corJogador, sugestoes, MAX_SUGESTOES_ATAQUE);
+        printf("Ataques possíveis (%d):\n", total);
+        for (int i = 0; i < total && i < MAX_SUGESTOES_ATAQUE; i++) {
+            printf("   %2d → %-2d  %s → %s\n",
+                   sugestoes[i].atacante + 1, sugestoes[i].defensor + 1,
+                   nomeTerritorio(mapa, sugestoes[i].atacante), nomeTerritorio(mapa, sugestoes[i].defensor));
+        }
+        if (total > MAX_SUGESTOES_ATAQUE) {
+            printf("   ... e mais %d\n", total - MAX_SUGESTOES_ATAQUE);
+        }
+        printf("\n");
+    }
+    
+    printf("Escolha o território ATACANTE (1 a %d): ", quantidade);
+    scanf("%d", &atacante);
+    limparBufferEntrada();
+    
+    printf("Escolha o território DEFENSOR (1 a %d): ", quantidade);
+    scanf("%d", &defensor);
+    limparBufferEntrada();
+    
+    // Validações básicas
+    if (atacante < 1 || atacante > quantidade || defensor < 1 || defensor > quantidade) {
+        printf("\n❌ Território inválido! Os territórios devem estar entre 1 e %d.\n", quantidade);
+    } else if (atacante == defensor) {
+        printf("\n❌ Um território não pode atacar a si mesmo!\n");
+    } else {
+        // Ajusta os índices (de 1-based para 0-based)
+        simularAtaque(mapa, atacante - 1, defensor - 1, gerador, objetivo, registro);
+    }
+    ENCERRAR_MEDICAO(TEMPO_FASE_ATAQUE, inicio);
+}
+
+/**
+ * contarJogada()
+ * Conta os dados e a conquista de um ataque da partida (do jogador ou de
+ * outro exército). As simulações contam à parte, nos contadores simulados,
+ * então as primitivas de dados e de conquista não contam nada.
+ */
+static inline void contarJogada(ResultadoAtaque resultado) {
+    CONTAR(CONTADOR_DADOS_ROLADOS, 2);
+    if (resultado == ATAQUE_CONQUISTA || resultado == ATAQUE_MISSAO_CUMPRIDA) {
+        CONTAR(CONTADOR_CONQUISTAS, 1);
+    }
+}
+
+/**
+ * simularAtaque()
+ * Executa uma batalha entre dois territórios e exibe cada etapa ao jogador.
+ * A regra em si fica em validarAtaque()/resolverAtaque(); esta função
+ * apenas lança os dados e apresenta o resultado.
+ * Parâmetros:
+ *   - mapa: mapa da partida
+ *   - atacante: índice do território atacante
+ *   - defensor: índice do território defensor
+ *   - gerador: gerador de números aleatórios da partida
+ *   - objetivo: missão do jogador, avisada assim que for cumprida (pode ser NULL)
+ *   - registro: registro de eventos da partida (pode ser NULL)
+ */
+void simularAtaque(Mapa *mapa, int atacante, int defensor, GeradorAleatorio *gerador, const Objetivo *objetivo,
+                   RegistroEventos *registro) {
+    INICIAR_MEDICAO(inicio);
+    printf("\n════════════════════════════════════════════════════════════════\n");
+    printf("                      🎲 SIMULAÇÃO DE BATALHA 🎲\n");
+    printf("════════════════════════════════════════════════════════════════\n\n");
+    
+    // Exibe informações dos territórios
+    printf("⚔️  ATACANTE: %s (%s) - %d tropas\n", 
+           nomeTerritorio(mapa, atacante),
+           nomeCor(mapa, mapa->cor[atacante]),
+           mapa->tropas[atacante]);
+    
+    printf("🛡️  DEFENSOR: %s (%s) - %d tropas\n\n",
+           nomeTerritorio(mapa, defensor),
+           nomeCor(mapa, mapa->cor[defensor]),
+           mapa->tropas[defensor]);
+    
+    ResultadoAtaque validacao = validarAtaque(mapa, atacante, defensor);
+    if (validacao != ATAQUE_VALIDO) {
+        if (validacao == ATAQUE_TROPAS_INSUFICIENTES) {
+            printf("❌ O território atacante precisa ter pelo menos 2 tropas para atacar!\n");
+            printf("   (uma tropa deve sempre permanecer no território)\n");
+        } else if (validacao == ATAQUE_MESMA_COR) {
+            printf("❌ Você não pode atacar um território da mesma cor!\n");
+        } else {
+            printf("❌ Os territórios não fazem fronteira!\n");
+            printf("   (só é possível atacar um território vizinho)\n");
+        }
+        ENCERRAR_MEDICAO(TEMPO_SIMULAR_ATAQUE, inicio);
+        return;
+    }
+    
+    // Previsão exata da batalha, tirada da tabela de probabilidades
+    printf("📈 Previsão: %.1f rodadas em média para conquistar; %.1f%% de chance em %d rodadas\n\n",
+           rodadasEsperadasConquista(mapa->tropas[defensor]),
+           100.0 * chanceConquista(mapa->tropas[defensor], RODADAS_PREVISAO), RODADAS_PREVISAO);
+    
+    // Simula lançamento dos dados
+    int dadoAtacante = rolarDado(gerador);
+    int dadoDefensor = rolarDado(gerador);
+    
+    printf("🎲 Lançando os dados...\n\n");
+    printf("   Dado do ATACANTE: 🎲 %d\n", dadoAtacante);
+    printf("   Dado do DEFENSOR: 🎲 %d\n\n", dadoDefensor);
+    
+    ResultadoAtaque resultado = resolverAtaque(mapa, atacante, defensor, dadoAtacante, dadoDefensor, objetivo);
+    registrarAtaque(registro, atacante, defensor, dadoAtacante, dadoDefensor, resultado);
+    contarJogada(resultado);
+    int conquistou = (resultado == ATAQUE_CONQUISTA || resultado == ATAQUE_MISSAO_CUMPRIDA);
+    
+    if (resultado == ATAQUE_DEFENSOR_RESISTIU) {
+        printf("✅ O DEFENSOR resistiu ao ataque!\n");
+        printf("   → Nenhuma tropa foi perdida.\n");
+        printf("   (Empates e vitórias do defensor favorecem a defesa)\n");
+    } else {
+        printf("✅ O ATACANTE venceu a batalha!\n");
+        printf("   → O defensor perdeu 1 tropa. Tropas restantes: %d\n", 
+               conquistou ? 0 : mapa->tropas[defensor]);
+        
+        if (conquistou) {
+            printf("\n🏴 TERRITÓRIO CONQUISTADO!\n");
+            printf("   %s agora pertence ao exército %s!\n",
+                   nomeTerritorio(mapa, defensor),
+                   nomeCor(mapa, mapa->cor[atacante]));
+        }
+        if (resultado == ATAQUE_MISSAO_CUMPRIDA) {
+            printf("\n🎯 Com esta conquista a sua missão foi cumprida!\n");
+            printf("   Use a opção [2] no menu para confirmar a vitória.\n");
+        }
+    }
+    
+    printf("\n════════════════════════════════════════════════════════════════\n");
+    ENCERRAR_MEDICAO(TEMPO_SIMULAR_ATAQUE, inicio);
+}
+
+/**
+ * validarAtaque()
+ * Verifica se um ataque é permitido pelas regras, sem alterar o mapa.
+ * Parâmetros:
+ *   - mapa: mapa da partida (const - apenas leitura)
+ *   - atacante: índice do território atacante
+ *   - defensor: índice do território defensor
+ * Retorna:
+ *   - ATAQUE_VALIDO ou o motivo da rejeição
+ */
+ResultadoAtaque validarAtaque(const Mapa *mapa, int atacante, int defensor) {
+    CONTAR(CONTADOR_ATAQUES_TENTADOS, 1);
+    
+    // Validação: atacante precisa ter pelo menos 2 tropas (1 fica no território)
+    if (mapa->tropas[atacante] < 2) {
+        CONTAR(CONTADOR_RECUSA_TROPAS, 1);
+        return ATAQUE_TROPAS_INSUFICIENTES;
+    }
+    
+    // Validação: não pode atacar território da mesma cor
+    if (mapa->cor[atacante] == mapa->cor[defensor]) {
+        CONTAR(CONTADOR_RECUSA_MESMA_COR, 1);
+        return ATAQUE_MESMA_COR;
+    }
+    
+    // Validação: só é possível atacar um território vizinho
+    if (!saoVizinhos(mapa, atacante, defensor)) {
+        CONTAR(CONTADOR_RECUSA_NAO_ADJACENTE, 1);
+        return ATAQUE_NAO_ADJACENTE;
+    }
+    
+    return ATAQUE_VALIDO;
+}
+
+static ResultadoAtaque conquistarTerritorio(Mapa *mapa, int atacante, int defensor, const Objetivo *objetivo);
+
+/**
+ * resolverAtaque()
+ * Aplica ao mapa o resultado de uma rodada de dados já validada.
+ * Não faz nenhuma entrada/saída, podendo ser usada no motor em lote.
+ * Parâmetros:
+ *   - mapa: mapa da partida
+ *   - atacante: índice do território atacante
+ *   - defensor: índice do território defensor
+ *   - dadoAtacante, dadoDefensor: valores sorteados (1 a 6)
+ *   - objetivo: missão a verificar após uma conquista (pode ser NULL)
+ * Retorna:
+ *   - ATAQUE_DEFENSOR_RESISTIU, ATAQUE_ATACANTE_VENCEU, ATAQUE_CONQUISTA ou
+ *     ATAQUE_MISSAO_CUMPRIDA (conquista do jogador que completou o objetivo)
+ */
+ResultadoAtaque resolverAtaque(Mapa *mapa, int atacante, int defensor, int dadoAtacante, int dadoDefensor,
+                               const Objetivo *objetivo) {
+    // Empates e vitórias do defensor favorecem a defesa
+    if (dadoAtacante <= dadoDefensor) {
+        return ATAQUE_DEFENSOR_RESISTIU;
+    }
+    
+    anotarEscrita(mapa, &mapa->tropas[defensor]);
+    mapa->tropas[defensor]--;
+    if (mapa->tropas[defensor] > 0) {
+        return ATAQUE_ATACANTE_VENCEU;
+    }
+    return conquistarTerritorio(mapa, atacante, defensor, objetivo);
+}
+
+/**
+ * conquistarTerritorio()
+ * Passa um defensor sem tropas para a cor do atacante, movendo uma tropa.
+ * Parâmetros:
+ *   - mapa: mapa da partida
+ *   - atacante: índice do território atacante
+ *   - defensor: índice do território conquistado
+ *   - objetivo: missão a verificar após a conquista (pode ser NULL)
+ * Retorna:
+ *   - ATAQUE_MISSAO_CUMPRIDA se a conquista é do jogador e a missão passou
+ *     de pendente a cumprida com ela; ATAQUE_CONQUISTA caso contrário
+ */
+static ResultadoAtaque conquistarTerritorio(Mapa *mapa, int atacante, int defensor, const Objetivo *objetivo) {
+    // Só a conquista do próprio jogador que completa a missão é anunciada,
+    // não cada conquista seguinte nem a de outro exército
+    int doJogador = objetivo != NULL && mapa->cor[atacante] == objetivo->corJogador;
+    int cumpridaAntes = doJogador && verificarVitoria(mapa, objetivo);
+    
+    // Território conquistado: atualiza a cor do exército e move uma tropa
+    transferirTerritorio(mapa, defensor, mapa->cor[atacante]);
+    anotarEscrita(mapa, &mapa->tropas[defensor]);
+    anotarEscrita(mapa, &mapa->tropas[atacante]);
+    mapa->tropas[defensor] = 1;
+    mapa->tropas[atacante]--;
+    
+    // Só uma conquista pode mudar o estado de uma missão
+    if (doJogador && !cumpridaAntes && verificarVitoria(mapa, objetivo)) {
+        return ATAQUE_MISSAO_CUMPRIDA;
+    }
+    return ATAQUE_CONQUISTA;
+}
+
+// Chance de o atacante vencer uma rodada: 15 dos 36 pares de dados têm o dado
+// do atacante maior (empates favorecem a defesa).
+#define CHANCE_RODADA (15.0 / 36.0)
+
+static TabelaBatalha tabelaGlobal;
+static pthread_once_t tabelaMontada = PTHREAD_ONCE_INIT;
+
+/**
+ * montarTabelaBatalha()
+ * Calcula as distribuições binomiais de todas as batalhas de até
+ * MAX_RODADAS_BATALHA rodadas pela recorrência de Pascal
+ * P(r, k) = P(r - 1, k) * q + P(r - 1, k - 1) * p. Roda uma única vez.
+ */
+static void montarTabelaBatalha(void) {
+    static double massa[MAX_RODADAS_BATALHA + 1][MAX_RODADAS_BATALHA + 1];
+    TabelaBatalha *tabela = &tabelaGlobal;
+    const double p = CHANCE_RODADA;
+    const double q = 1.0 - p;
+    
+    massa[0][0] = 1.0;
+    for (int r = 1; r <= MAX_RODADAS_BATALHA; r++) {
+        massa[r][0] = massa[r - 1][0] * q;
+        for (int k = 1; k <= r; k++) {
+            massa[r][k] = (k < r ? massa[r - 1][k] * q : 0.0) + massa[r - 1][k - 1] * p;
+        }
+    }
+    
+    for (int r = 0; r <= MAX_RODADAS_BATALHA; r++) {
+        double acumulada = 0.0;
+        double media = 0.0;  // Soma de k * P(k) para k < d
+        for (int k = 0; k <= MAX_RODADAS_BATALHA; k++) {
+            // E[min(perdas, k)] = soma(j * P(j), j < k) + k * P(perdas >= k)
+            tabela->perdasMedias[r][k] = media + k * (1.0 - acumulada);
+            
+            if (k <= r) {
+                acumulada += massa[r][k];
+                media += k * massa[r][k];
+            }
+            if (k >= r || acumulada >= 1.0) {
+                acumulada = 1.0;
+            }
+            tabela->acumulada[r][k] = acumulada;
+            tabela->limiar[r][k] = acumulada >= 1.0 ? UINT64_MAX : (uint64_t) (acumulada * 18446744073709551616.0);
+        }
+    }
+}
+
+/**
+ * tabelaBatalha()
+ * Retorna a tabela de probabilidades de batalha, montando-a na primeira
+ * chamada. Depois de montada é só leitura e pode ser usada por qualquer thread.
+ * Retorna:
+ *   - Ponteiro para a tabela compartilhada
+ */
+const TabelaBatalha* tabelaBatalha(void) {
+    pthread_once(&tabelaMontada, montarTabelaBatalha);
+    return &tabelaGlobal;
+}
+
+/**
+ * chanceConquista()
+ * Probabilidade exata de o atacante conquistar o defensor em no máximo
+ * "rodadas" rodadas (limitadas a MAX_RODADAS_BATALHA).
+ * Parâmetros:
+ *   - tropasDefensor: tropas atuais do defensor
+ *   - rodadas: número de rodadas que o atacante está disposto a lutar
+ * Retorna:
+ *   - Probabilidade entre 0 e 1
+ */
+double chanceConquista(int tropasDefensor, int rodadas) {
+    if (tropasDefensor <= 0) {
+        return 1.0;
+    }
+    if (rodadas > MAX_RODADAS_BATALHA) {
+        rodadas = MAX_RODADAS_BATALHA;
+    }
+    if (rodadas < tropasDefensor) {
+        return 0.0;
+    }
+    return 1.0 - tabelaBatalha()->acumulada[rodadas][tropasDefensor - 1];
+}
+
+/**
+ * perdasEsperadas()
+ * Número esperado de tropas que o defensor perde em uma batalha de
+ * "rodadas" rodadas (limitadas a MAX_RODADAS_BATALHA), contando que ele
+ * não perde mais do que as tropas que tem.
+ * Parâmetros:
+ *   - tropasDefensor: tropas atuais do defensor
+ *   - rodadas: número de rodadas da batalha
+ * Retorna:
+ *   - Perda média do defensor
+ */
+double perdasEsperadas(int tropasDefensor, int rodadas) {
+    if (tropasDefensor <= 0 || rodadas <= 0) {
+        return 0.0;
+    }
+    if (rodadas > MAX_RODADAS_BATALHA) {
+        rodadas = MAX_RODADAS_BATALHA;
+    }
+    if (tropasDefensor > rodadas) {
+        return rodadas * CHANCE_RODADA;  // O limite de tropas nunca é atingido
+    }
+    return tabelaBatalha()->perdasMedias[rodadas][tropasDefensor];
+}
+
+/**
+ * rodadasEsperadasConquista()
+ * Número médio de rodadas até a conquista sem limite de rodadas: a espera
+ * por d sucessos de chance p tem média d / p (binomial negativa).
+ * Parâmetros:
+ *   - tropasDefensor: tropas atuais do defensor
+ * Retorna:
+ *   - Média de rodadas até a conquista
+ */
+double rodadasEsperadasConquista(int tropasDefensor) {
+    return tropasDefensor > 0 ? tropasDefensor / CHANCE_RODADA : 0.0;
+}
+
+/**
+ * resolverBatalha()
+ * Resolve uma batalha validada de até "rodadas" rodadas de uma só vez:
+ * um único número aleatório é comparado com a distribuição acumulada da
+ * tabela para obter as perdas do defensor, em vez de lançar os dados de cada
+ * rodada. A batalha para assim que o defensor é conquistado. Batalhas com
+ * mais de MAX_RODADAS_BATALHA rodadas são resolvidas em blocos, com um
+ * sorteio por bloco.
+ * Parâmetros:
+ *   - mapa: mapa da partida
+ *   - atacante: índice do território atacante
+ *   - defensor: índice do território defensor
+ *   - rodadas: número máximo de rodadas da batalha
+ *   - gerador: gerador de números aleatórios da partida
+ *   - objetivo: missão a verificar após uma conquista (pode ser NULL)
+ * Retorna:
+ *   - ATAQUE_DEFENSOR_RESISTIU (nenhuma perda), ATAQUE_ATACANTE_VENCEU,
+ *     ATAQUE_CONQUISTA ou ATAQUE_MISSAO_CUMPRIDA
+ */
+ResultadoAtaque resolverBatalha(Mapa *mapa, int atacante, int defensor, int rodadas, GeradorAleatorio *gerador,
+                                const Objetivo *objetivo) {
+    const TabelaBatalha *tabela = tabelaBatalha();
+    int perdasTotais = 0;
+    
+    while (rodadas > 0) {
+        int bloco = rodadas < MAX_RODADAS_BATALHA ? rodadas : MAX_RODADAS_BATALHA;
+        int limite = mapa->tropas[defensor] < bloco ? mapa->tropas[defensor] : bloco;
+        const uint64_t *limiar = tabela->limiar[bloco];
+        uint64_t sorteio = proximoAleatorio(gerador);
+        
+        // Menor k com P(perdas <= k) > sorteio, parando no total de tropas
+        int perdas = 0;
+        while (perdas < limite && sorteio >= limiar[perdas]) {
+            perdas++;
+        }
+        
+        anotarEscrita(mapa, &mapa->tropas[defensor]);
+        mapa->tropas[defensor] -= perdas;
+        perdasTotais += perdas;
+        if (mapa->tropas[defensor] == 0) {
+            return conquistarTerritorio(mapa, atacante, defensor, objetivo);
+        }
+        rodadas -= bloco;
+    }
+    
+    return perdasTotais > 0 ? ATAQUE_ATACANTE_VENCEU : ATAQUE_DEFENSOR_RESISTIU;
+}
+
+/**
+ * transferirTerritorio()
+ * Troca o dono de um território mantendo os contadores de territórios por cor,
+ * as listas de fronteira e as contagens da sua região. Custa O(vizinhos do
+ * território): só ele e os seus vizinhos podem entrar ou sair da fronteira, e
+ * só a região dele pode mudar de dono.
+ * Toda mudança de dono durante a partida deve passar por aqui (e toda
+ * escrita no estado vai antes para o diário, se o mapa tiver um).
+ * Parâmetros:
+ *   - mapa: mapa da partida
+ *   - territorio: índice do território
+ *   - novaCor: cor do novo dono
+ */
+void transferirTerritorio(Mapa *mapa, int territorio, IdCor novaCor) {
+    IdCor antiga = mapa->cor[territorio];
+    if (antiga == novaCor) {
+        return;
+    }
+    
+    if (mapa->posicaoFronteira[territorio] >= 0) {
+        removerFronteira(mapa, territorio);
+    }
+    anotarEscrita(mapa, &mapa->territoriosPorCor[antiga]);
+    anotarEscrita(mapa, &mapa->territoriosPorCor[novaCor]);
+    anotarCor(mapa, territorio);
+    mapa->territoriosPorCor[antiga]--;
+    mapa->territoriosPorCor[novaCor]++;
+    mapa->cor[territorio] = novaCor;
+    
+    if (mapa->regiaoDe != NULL && mapa->regiaoDe[territorio] >= 0) {
+        // A cor antiga deixa de dominar a região inteira; a nova pode completá-la
+        int32_t regiao = mapa->regiaoDe[territorio];
+        int32_t *porRegiao = mapa->territoriosPorRegiao + regiao;
+        int r = mapa->numRegioes;
+        anotarEscrita(mapa, &porRegiao[antiga * r]);
+        anotarEscrita(mapa, &porRegiao[novaCor * r]);
+        if (porRegiao[antiga * r]-- == mapa->tamanhoRegiao[regiao]) {
+            anotarEscrita(mapa, &mapa->regioesPorCor[antiga]);
+            anotarEscrita(mapa, &mapa->bonusPorCor[antiga]);
+            mapa->regioesPorCor[antiga]--;
+            mapa->bonusPorCor[antiga] -= mapa->bonusRegiao[regiao];
+        }
+        if (++porRegiao[novaCor * r] == mapa->tamanhoRegiao[regiao]) {
+            anotarEscrita(mapa, &mapa->regioesPorCor[novaCor]);
+            anotarEscrita(mapa, &mapa->bonusPorCor[novaCor]);
+            mapa->regioesPorCor[novaCor]++;
+            mapa->bonusPorCor[novaCor] += mapa->bonusRegiao[regiao];
+        }
+    }
+    
+    int32_t inimigos = 0;
+    for (uint32_t v = mapa->inicioVizinhos[territorio]; v < mapa->inicioVizinhos[territorio + 1]; v++) {
+        uint32_t vizinho = mapa->vizinhos[v];
+        IdCor corVizinho = mapa->cor[vizinho];
+        
+        if (corVizinho == antiga) {
+            // Era aliado e passou a ser inimigo
+            anotarEscrita(mapa, &mapa->vizinhosInimigos[vizinho]);
+            if (mapa->vizinhosInimigos[vizinho]++ == 0) {
+                adicionarFronteira(mapa, vizinho);
+            }
+        } else if (corVizinho == novaCor) {
+            // Era inimigo e passou a ser aliado
+            anotarEscrita(mapa, &mapa->vizinhosInimigos[vizinho]);
+            if (--mapa->vizinhosInimigos[vizinho] == 0) {
+                removerFronteira(mapa, vizinho);
+            }
+        }
+        inimigos += (corVizinho != novaCor);
+    }
+    
+    anotarEscrita(mapa, &mapa->vizinhosInimigos[territorio]);
+    mapa->vizinhosInimigos[territorio] = inimigos;
+    if (inimigos > 0) {
+        adicionarFronteira(mapa, territorio);
+    }
+}
+
+/**
+ * saoVizinhos()
+ * Verifica se dois territórios fazem fronteira, percorrendo a linha CSR
+ * do primeiro.
+ * Retorna:
+ *   - 1 se fazem fronteira, 0 caso contrário
+ */
+int saoVizinhos(const Mapa *mapa, int a, int b) {
+    for (uint32_t v = mapa->inicioVizinhos[a]; v < mapa->inicioVizinhos[a + 1]; v++) {
+        if (mapa->vizinhos[v] == (uint32_t) b) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * listarAtaques()
+ * Enumera os ataques válidos de uma cor. Percorre apenas a lista de
+ * territórios de fronteira da cor e os vizinhos de cada um, nunca todos os
+ * pares de territórios do mapa.
+ * Parâmetros:
+ *   - mapa: mapa da partida (const - apenas leitura)
+ *   - cor: cor que vai atacar
+ *   - ataques[]: recebe até "capacidade" ataques (pode ser NULL se capacidade = 0)
+ *   - capacidade: tamanho do vetor ataques[]
+ * Retorna:
+ *   - Número total de ataques válidos (pode ser maior que a capacidade)
+ */
+int listarAtaques(const Mapa *mapa, IdCor cor, Ataque ataques[], int capacidade) {
+    const int32_t *lista = mapa->fronteiras + (size_t) cor * mapa->quantidade;
+    int total = 0;
+    
+    for (int32_t k = 0; k < mapa->numFronteiras[cor]; k++) {
+        int32_t atacante = lista[k];
+        if (mapa->tropas[atacante] < 2) {
+            continue;
+        }
+        for (uint32_t v = mapa->inicioVizinhos[atacante]; v < mapa->inicioVizinhos[atacante + 1]; v++) {
+            int32_t defensor = (int32_t) mapa->vizinhos[v];
+            if (mapa->cor[defensor] != cor) {
+                if (total < capacidade) {
+                    ataques[total].atacante = atacante;
+                    ataques[total].defensor = defensor;
+                }
+                total++;
+            }
+        }
+    }
+    return total;
+}
+
+/**
+ * limiteAtaques()
+ * Retorna o maior número de ataques que listarAtaques() pode encontrar
+ * neste mapa (o total de entradas do CSR), útil para dimensionar vetores.
+ */
+int limiteAtaques(const Mapa *mapa) {
+    return (int) mapa->inicioVizinhos[mapa->quantidade];
+}
+
+/**
+ * calcularReforcos()
+ * Tropas de reforço de uma cor no início do turno: uma a cada
+ * TERRITORIOS_POR_REFORCO territórios (no mínimo REFORCO_MINIMO) mais o bônus
+ * de cada região dominada por inteiro. Custa O(1): os contadores por cor e
+ * por região são mantidos por transferirTerritorio() a cada conquista, então
+ * o custo por turno é o das conquistas do turno, não o do tamanho do mapa.
+ * Parâmetros:
+ *   - mapa: mapa da partida (const - apenas leitura)
+ *   - cor: cor do exército
+ * Retorna:
+ *   - Número de tropas de reforço (0 para uma cor sem territórios)
+ */
+int calcularReforcos(const Mapa *mapa, IdCor cor) {
+    int32_t territorios = mapa->territoriosPorCor[cor];
+    if (territorios == 0) {
+        return 0;
+    }
+    int32_t porTerritorios = territorios / TERRITORIOS_POR_REFORCO;
+    if (porTerritorios < REFORCO_MINIMO) {
+        porTerritorios = REFORCO_MINIMO;
+    }
+    return porTerritorios + mapa->bonusPorCor[cor];
+}
+
+/**
+ * rolarDado()
+ * Sorteia o valor de um dado de seis faces, sem viés.
+ * Parâmetros:
+ *   - gerador: gerador de números aleatórios da partida
+ * Retorna:
+ *   - Valor de 1 a 6
+ */
+int rolarDado(GeradorAleatorio *gerador) {
+    return (int) sortearIntervalo(gerador, 6) + 1;
+}
+
+/**
+ * misturarSemente()
+ * Passo do splitmix64, usado para espalhar sementes pequenas ou parecidas
+ * por todo o estado de 256 bits do xoshiro.
+ * Parâmetros:
+ *   - estado: contador do splitmix64 (é avançado)
+ * Retorna:
+ *   - Próximo valor de 64 bits da sequência
+ */
+static uint64_t misturarSemente(uint64_t *estado) {
+    uint64_t z = (*estado += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotacionar(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * semearGerador()
+ * Inicializa o gerador a partir de uma semente de 64 bits.
+ * Parâmetros:
+ *   - gerador: gerador a inicializar
+ *   - semente: qualquer valor (a mesma semente gera a mesma sequência)
+ */
+void semearGerador(GeradorAleatorio *gerador, uint64_t semente) {
+    for (int i = 0; i < 4; i++) {
+        gerador->s[i] = misturarSemente(&semente);
+    }
+}
+
+/**
+ * proximoAleatorio()
+ * Avança o xoshiro256** e retorna 64 bits aleatórios.
+ * Parâmetros:
+ *   - gerador: gerador da partida
+ * Retorna:
+ *   - Valor de 64 bits uniformemente distribuído
+ */
+uint64_t proximoAleatorio(GeradorAleatorio *gerador) {
+    uint64_t *s = gerador->s;
+    uint64_t resultado = rotacionar(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotacionar(s[3], 45);
+    
+    return resultado;
+}
+
+/**
+ * sortearIntervalo()
+ * Sorteia um inteiro uniforme em [0, limite) pelo método de Lemire
+ * (multiplicação com rejeição), sem o viés de "rand() % limite".
+ * Parâmetros:
+ *   - gerador: gerador da partida
+ *   - limite: tamanho do intervalo (maior que zero)
+ * Retorna:
+ *   - Valor de 0 a limite - 1
+ */
+uint32_t sortearIntervalo(GeradorAleatorio *gerador, uint32_t limite) {
+    uint64_t m = (proximoAleatorio(gerador) >> 32) * limite;
+    uint32_t baixo = (uint32_t) m;
+    
+    if (baixo < limite) {
+        uint32_t limiar = (uint32_t) -limite % limite;
+        while (baixo < limiar) {
+            m = (proximoAleatorio(gerador) >> 32) * limite;
+            baixo = (uint32_t) m;
+        }
+    }
+    
+    return (uint32_t) (m >> 32);
+}
+
+/**
+ * rolarDados()
+ * Preenche um vetor inteiro de dados de seis faces (valores 1 a 6).
+ * Para lotes grandes, avança quatro fluxos xoshiro independentes em paralelo
+ * e extrai dois dados de cada valor de 64 bits; o laço não tem desvios e é
+ * vetorizado pelo compilador quando a CPU oferece SIMD. Os raros valores
+ * rejeitados (4 em 2^32) são sorteados de novo no fluxo principal, então o
+ * resultado continua sem viés e reproduzível pela semente.
+ * Parâmetros:
+ *   - gerador: gerador da partida
+ *   - dados[]: vetor que recebe os valores
+ *   - quantidade: número de dados a lançar
+ */
+void rolarDados(GeradorAleatorio *gerador, uint8_t dados[], int quantidade) {
+    enum { FLUXOS = 4, DADOS_POR_BLOCO = 2 * FLUXOS, LIMIAR_D6 = 4 };  // LIMIAR_D6 = 2^32 % 6
+    int i = 0;
+    
+    if (quantidade >= 4 * DADOS_POR_BLOCO) {
+        // Estado dos fluxos em forma de estrutura de vetores: s0[f], s1[f], ...
+        uint64_t s0[FLUXOS], s1[FLUXOS], s2[FLUXOS], s3[FLUXOS];
+        for (int f = 0; f < FLUXOS; f++) {
+            uint64_t semente = proximoAleatorio(gerador);
+            s0[f] = misturarSemente(&semente);
+            s1[f] = misturarSemente(&semente);
+            s2[f] = misturarSemente(&semente);
+            s3[f] = misturarSemente(&semente);
+        }
+        
+        for (; i + DADOS_POR_BLOCO <= quantidade; i += DADOS_POR_BLOCO) {
+            uint32_t rejeitados = 0;
+            
+            for (int f = 0; f < FLUXOS; f++) {
+                uint64_t x = rotacionar(s1[f] * 5, 7) * 9;
+                uint64_t t = s1[f] << 17;
+                s2[f] ^= s0[f];
+                s3[f] ^= s1[f];
+                s1[f] ^= s2[f];
+                s0[f] ^= s3[f];
+                s2[f] ^= t;
+                s3[f] = rotacionar(s3[f], 45);
+                
+                uint64_t alto = (x >> 32) * 6;
+                uint64_t baixo = (x & 0xFFFFFFFFu) * 6;
+                dados[i + 2 * f] = (uint8_t) ((alto >> 32) + 1);
+                dados[i + 2 * f + 1] = (uint8_t) ((baixo >> 32) + 1);
+                rejeitados |= (uint32_t) ((uint32_t) alto < LIMIAR_D6) << (2 * f);
+                rejeitados |= (uint32_t) ((uint32_t) baixo < LIMIAR_D6) << (2 * f + 1);
+            }
+            
+            while (rejeitados) {
+                int j = __builtin_ctz(rejeitados);
+                dados[i + j] = (uint8_t) (sortearIntervalo(gerador, 6) + 1);
+                rejeitados &= rejeitados - 1;
+            }
+        }
+    }
+    
+    for (; i < quantidade; i++) {
+        dados[i] = (uint8_t) (sortearIntervalo(gerador, 6) + 1);
+    }
+}
+
+// Catálogo padrão, usado sem --missoes: as duas missões clássicas do jogo.
+static const char *MISSOES_PADRAO =
+    "missao;eliminar;Verde;Destruir o exército VERDE;Todos os territórios verdes devem ser conquistados.\n"
+    "missao;territorios;3;Conquistar 3 TERRITÓRIOS;Domine pelo menos 3 territórios com seu exército.\n";
+
+/**
+ * compilarRegiao()
+ * Traduz a lista "Nome A,Nome B,..." de uma missão de região para índices
+ * de território, acrescentados a catalogo->territoriosRegioes. Os nomes são
+ * procurados no mesmo índice por espalhamento usado pelo carregador de mapas.
+ * Retorna:
+ *   - 0 em caso de sucesso, ou 1 se algum nome não existe (já informado)
+ */
+static int compilarRegiao(CatalogoMissoes *catalogo, Missao *missao, const Mapa *mapa, const int32_t indice[],
+                          uint32_t mascara, char *lista, const char *caminho, int numeroLinha) {
+    missao->inicioRegiao = catalogo->numTerritoriosRegioes;
+    missao->tamanhoRegiao = 0;
+    
+    char *cursor = lista;
+    char *nome;
+    while ((nome = proximoItemLista(&cursor)) != NULL) {
+        int territorio = indice[buscarIndiceNome(mapa, indice, mascara, nome)];
+        if (territorio < 0) {
+            printf("❌ %s:%d: o território \"%s\" não existe neste mapa\n", caminho, numeroLinha, nome);
+            return 1;
+        }
+        
+        if (catalogo->numTerritoriosRegioes % 64 == 0) {
+            int32_t *territorios = (int32_t*) realloc(catalogo->territoriosRegioes,
+                                                      (catalogo->numTerritoriosRegioes + 64) * sizeof(int32_t));
+            if (territorios == NULL) {
+                printf("❌ Erro ao alocar memória para as missões!\n");
+                return 1;
+            }
+            catalogo->territoriosRegioes = territorios;
+        }
+        catalogo->territoriosRegioes[catalogo->numTerritoriosRegioes++] = territorio;
+        missao->tamanhoRegiao++;
+    }
+    return 0;
+}
+
+static int compilarCatalogo(Mapa *mapa, const char *texto, const char *origem, int padrao);
+
+/**
+ * compilarMissoes()
+ * Lê um arquivo de missões e o compila para o mapa com compilarMissoesTexto().
+ * Parâmetros:
+ *   - mapa: mapa que recebe o catálogo (compartilhado pelos seus clones)
+ *   - caminho: arquivo de missões, ou NULL para o catálogo padrão
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro (já informado)
+ */
+int compilarMissoes(Mapa *mapa, const char *caminho) {
+    if (caminho == NULL) {
+        return compilarCatalogo(mapa, MISSOES_PADRAO, "missões padrão", 1);
+    }
+    
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        printf("❌ Não foi possível abrir as missões %s!\n", caminho);
+        return 1;
+    }
+    fseek(arquivo, 0, SEEK_END);
+    long tamanho = ftell(arquivo);
+    fseek(arquivo, 0, SEEK_SET);
+    char *conteudo = (tamanho >= 0) ? (char*) malloc(tamanho + 1) : NULL;
+    if (conteudo == NULL || fread(conteudo, 1, tamanho, arquivo) != (size_t) tamanho) {
+        printf("❌ Erro ao ler as missões %s!\n", caminho);
+        free(conteudo);
+        fclose(arquivo);
+        return 1;
+    }
+    fclose(arquivo);
+    conteudo[tamanho] = '\0';
+    
+    int status = compilarMissoesTexto(mapa, conteudo, caminho);
+    free(conteudo);
+    return status;
+}
+
+/**
+ * compilarCatalogo()
+ * Faz o trabalho de compilarMissoesTexto(). Uma cor que não existe no mapa
+ * é um erro nas missões do usuário; no catálogo padrão, feito para o mapa
+ * padrão, a missão de eliminar essa cor só fica de fora (não há como
+ * cumpri-la nem como falhar nela em um mapa sem a cor).
+ * Parâmetros:
+ *   - padrao: 1 para o catálogo padrão
+ */
+static int compilarCatalogo(Mapa *mapa, const char *texto, const char *origem, int padrao) {
+    char *conteudo = strdup(texto);
+    CatalogoMissoes *catalogo = (CatalogoMissoes*) calloc(1, sizeof(CatalogoMissoes));
+    if (conteudo == NULL || catalogo == NULL) {
+        printf("❌ Erro ao alocar memória para as missões!\n");
+        free(conteudo);
+        free(catalogo);
+        return 1;
+    }
+    // Índice dos nomes de território, montado só se alguma missão for de região
+    int32_t *indice = NULL;
+    size_t tamanhoIndice = 1;
+    while (tamanhoIndice < 2 * (size_t) mapa->quantidade) {
+        tamanhoIndice <<= 1;
+    }
+    
+    int numeroLinha = 0, erro = 0;
+    char *linha = conteudo;
+    while (!erro && linha != NULL && *linha) {
+        char *fimLinha = strchr(linha, '\n');
+        if (fimLinha != NULL) {
+            *fimLinha = '\0';
+        }
+        numeroLinha++;
+        
+        char *cursor = linha;
+        char *registro = proximoCampo(&cursor);
+        char *tipo = proximoCampo(&cursor);
+        char *parametro = proximoCampo(&cursor);
+        char *titulo = proximoCampo(&cursor);
+        char *detalhe = proximoCampo(&cursor);
+        Missao *missao = &catalogo->missoes[catalogo->quantidade];
+        int ignorada = 0;
+        
+        if (registro[0] == '\0' || registro[0] == '#') {
+            // Linha vazia ou comentário
+        } else if (strcmp(registro, "missao") != 0 || titulo == NULL || titulo[0] == '\0') {
+            printf("❌ %s:%d: use missao;Tipo;Parâmetro;Título;Detalhe\n", origem, numeroLinha);
+            erro = 1;
+        } else if (catalogo->quantidade == MAX_MISSOES) {
+            printf("❌ %s:%d: limite de %d missões excedido!\n", origem, numeroLinha, MAX_MISSOES);
+            erro = 1;
+        } else {
+            missao->regiaoMapa = -1;
+            if (strcmp(tipo, "regiao") == 0 && indice == NULL && buscarRegiao(mapa, parametro) < 0) {
+                indice = (int32_t*) malloc(tamanhoIndice * sizeof(int32_t));
+                if (indice != NULL) {
+                    memset(indice, 0xFF, tamanhoIndice * sizeof(int32_t));
+                    for (int i = 0; i < mapa->quantidade; i++) {
+                        indice[buscarIndiceNome(mapa, indice, tamanhoIndice - 1, nomeTerritorio(mapa, i))] = i;
+                    }
+                }
+            }
+            
+            if (strcmp(tipo, "eliminar") == 0 && parametro[0] != '\0') {
+                missao->tipo = MISSAO_ELIMINAR;
+                missao->corAlvo = buscarCor(mapa, parametro);
+                if (missao->corAlvo == COR_INVALIDA && padrao) {
+                    ignorada = 1;
+                } else if (missao->corAlvo == COR_INVALIDA) {
+                    printf("❌ %s:%d: a cor \"%s\" não existe neste mapa\n", origem, numeroLinha, parametro);
+                    erro = 1;
+                }
+            } else if (strcmp(tipo, "territorios") == 0 && atoi(parametro) >= 1) {
+                missao->tipo = MISSAO_TERRITORIOS;
+                missao->territoriosMinimos = atoi(parametro);
+            } else if (strcmp(tipo, "regiao") == 0 && parametro[0] != '\0') {
+                missao->tipo = MISSAO_REGIAO;
+                // Um nome de região do mapa vale mais que um território de mesmo nome
+                missao->regiaoMapa = buscarRegiao(mapa, parametro);
+                if (missao->regiaoMapa >= 0) {
+                    missao->tamanhoRegiao = mapa->tamanhoRegiao[missao->regiaoMapa];
+                } else if (indice == NULL) {
+                    printf("❌ Erro ao alocar memória para as missões!\n");
+                    erro = 1;
+                } else {
+                    erro = compilarRegiao(catalogo, missao, mapa, indice, tamanhoIndice - 1, parametro,
+                                          origem, numeroLinha);
+                }
+            } else {
+                printf("❌ %s:%d: tipo de missão inválido (use eliminar;Cor, territorios;N ou regiao;Região ou A,B,...)\n",
+                       origem, numeroLinha);
+                erro = 1;
+            }
+            if (!ignorada) {
+                missao->titulo = adicionarTexto(&catalogo->textos, titulo);
+                missao->detalhe = adicionarTexto(&catalogo->textos, detalhe != NULL ? detalhe : "");
+                if (!erro && (missao->titulo < 0 || missao->detalhe < 0)) {
+                    printf("❌ Erro ao alocar memória para as missões!\n");
+                    erro = 1;
+                }
+                catalogo->quantidade++;
+            }
+        }
+        linha = fimLinha ? fimLinha + 1 : NULL;
+    }
+    free(conteudo);
+    free(indice);
+    
+    if (!erro && catalogo->quantidade == 0) {
+        printf("❌ %s não define nenhuma missão!\n", origem);
+        erro = 1;
+    }
+    if (erro) {
+        liberarMissoes(catalogo);
+        return 1;
+    }
+    liberarMissoes((CatalogoMissoes*) mapa->missoes);
+    mapa->missoes = catalogo;
+    return 0;
+}
+
+/**
+ * compilarMissoesTexto()
+ * Compila definições de missão para o mapa: nomes de cor e de território
+ * viram IDs e índices uma única vez, no carregamento. Cada linha é um
+ * registro separado por ';', como nos arquivos de mapa:
+ *   missao;eliminar;Cor;Título;Detalhe
+ *   missao;territorios;N;Título;Detalhe
+ *   missao;regiao;Território A,Território B,...;Título;Detalhe
+ *   missao;regiao;Nome da região do mapa;Título;Detalhe
+ * A ordem das linhas define os IDs das missões (1, 2, ...). O catálogo
+ * anterior do mapa só é trocado se todas as linhas forem válidas.
+ * Parâmetros:
+ *   - mapa: mapa que recebe o catálogo (compartilhado pelos seus clones)
+ *   - texto: definições das missões
+ *   - origem: nome do arquivo, usado nas mensagens de erro
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro (já informado)
+ */
+int compilarMissoesTexto(Mapa *mapa, const char *texto, const char *origem) {
+    return compilarCatalogo(mapa, texto, origem, 0);
+}
+
+/**
+ * liberarMissoes()
+ * Libera um catálogo de missões.
+ * Parâmetros:
+ *   - catalogo: catálogo a liberar (pode ser NULL)
+ */
+void liberarMissoes(CatalogoMissoes *catalogo) {
+    if (catalogo == NULL) {
+        return;
+    }
+    free(catalogo->textos.caracteres);
+    free(catalogo->textos.inicio);
+    free(catalogo->territoriosRegioes);
+    free(catalogo);
+}
+
+/**
+ * sortearMissao()
+ * Sorteia e retorna um ID de missão aleatório do catálogo do mapa.
+ * Parâmetros:
+ *   - mapa: mapa da partida (de onde vem o catálogo)
+ *   - gerador: gerador de números aleatórios da partida
+ * Retorna:
+ *   - ID da missão (1 a quantidade do catálogo), ou 0 se o mapa não tem missões
+ */
+int sortearMissao(const Mapa *mapa, GeradorAleatorio *gerador) {
+    if (mapa->missoes == NULL) {
+        return 0;
+    }
+    return (int) sortearIntervalo(gerador, (uint32_t) mapa->missoes->quantidade) + 1;
+}
+
+/**
+ * prepararObjetivo()
+ * Copia a missão compilada do catálogo para o objetivo do jogador, para que
+ * verificarVitoria() não precise procurar nomes nem consultar o catálogo.
+ * Parâmetros:
+ *   - mapa: mapa da partida (const - apenas leitura)
+ *   - idMissao: identificador da missão (1 a quantidade do catálogo)
+ *   - corJogador: cor do exército do jogador
+ * Retorna:
+ *   - Objetivo pronto para ser verificado (idMissao 0 se o ID não existe)
+ */
+Objetivo prepararObjetivo(const Mapa *mapa, int idMissao, IdCor corJogador) {
+    Objetivo objetivo;
+    memset(&objetivo, 0, sizeof(objetivo));
+    objetivo.corJogador = corJogador;
+    
+    const CatalogoMissoes *catalogo = mapa->missoes;
+    if (catalogo == NULL || idMissao < 1 || idMissao > catalogo->quantidade) {
+        return objetivo;
+    }
+    const Missao *missao = &catalogo->missoes[idMissao - 1];
+    objetivo.idMissao = idMissao;
+    objetivo.tipo = missao->tipo;
+    objetivo.corAlvo = missao->corAlvo;
+    objetivo.territoriosMinimos = missao->territoriosMinimos;
+    objetivo.regiao = catalogo->territoriosRegioes + missao->inicioRegiao;
+    objetivo.tamanhoRegiao = missao->tamanhoRegiao;
+    objetivo.regiaoMapa = missao->regiaoMapa;
+    return objetivo;
+}
+
+/**
+ * donoDaRegiao()
+ * Retorna a cor que domina todos os territórios de uma região, ou
+ * COR_INVALIDA se ela estiver dividida. Para no primeiro território de
+ * outra cor.
+ */
+static IdCor donoDaRegiao(const Mapa *mapa, const int32_t regiao[], int tamanho) {
+    if (tamanho == 0) {
+        return COR_INVALIDA;
+    }
+    IdCor dono = mapa->cor[regiao[0]];
+    for (int i = 1; i < tamanho; i++) {
+        if (mapa->cor[regiao[i]] != dono) {
+            return COR_INVALIDA;
+        }
+    }
+    return dono;
+}
+
+/**
+ * verificarVitoria()
+ * Verifica se o jogador cumpriu os requisitos de sua missão atual.
+ * Eliminar uma cor e dominar N territórios usam os contadores de
+ * territórios por cor e custam O(1), assim como dominar uma região do
+ * mapa (contagem por cor e região); uma lista de territórios olha só os
+ * territórios dela.
+ * Parâmetros:
+ *   - mapa: mapa da partida (const - apenas leitura)
+ *   - objetivo: missão do jogador, preparada por prepararObjetivo()
+ * Retorna:
+ *   - 1 (verdadeiro) se a missão foi cumprida
+ *   - 0 (falso) caso contrário
+ */
+int verificarVitoria(const Mapa *mapa, const Objetivo *objetivo) {
+    INICIAR_MEDICAO(inicio);
+    int cumprida = 0;  // Nenhuma missão
+    switch (objetivo->tipo) {
+        case MISSAO_ELIMINAR:
+            // Cumprida quando não resta nenhum território da cor alvo
+            cumprida = objetivo->corAlvo == COR_INVALIDA || mapa->territoriosPorCor[objetivo->corAlvo] == 0;
+            break;
+            
+        case MISSAO_TERRITORIOS:
+            cumprida = mapa->territoriosPorCor[objetivo->corJogador] >= objetivo->territoriosMinimos;
+            break;
+            
+        case MISSAO_REGIAO:
+            if (objetivo->regiaoMapa >= 0) {
+                // Região do mapa: a contagem por cor e região já diz se ela é toda do jogador
+                cumprida = mapa->territoriosPorRegiao[objetivo->corJogador * mapa->numRegioes + objetivo->regiaoMapa]
+                        == mapa->tamanhoRegiao[objetivo->regiaoMapa];
+            } else {
+                cumprida = donoDaRegiao(mapa, objetivo->regiao, objetivo->tamanhoRegiao) == objetivo->corJogador;
+            }
+            break;
+    }
+    ENCERRAR_MEDICAO(TEMPO_VERIFICAR_VITORIA, inicio);
+    return cumprida;
+}
+
+/**
+ * verificarMissoes()
+ * Verifica as missões de vários jogadores de uma vez. Cada região do
+ * catálogo é percorrida no máximo uma vez, não importa quantos jogadores a
+ * tenham como missão; as demais missões custam O(1). Com regiões disjuntas,
+ * o custo total não passa de uma passada pelo mapa.
+ * Parâmetros:
+ *   - mapa: mapa da partida (const - apenas leitura)
+ *   - objetivos: missões dos jogadores
+ *   - quantidade: número de jogadores
+ *   - cumpridas: recebe 1 ou 0 para cada jogador
+ * Retorna:
+ *   - Quantos jogadores cumpriram a missão
+ */
+int verificarMissoes(const Mapa *mapa, const Objetivo objetivos[], int quantidade, int cumpridas[]) {
+    IdCor donos[MAX_MISSOES + 1];
+    uint8_t calculado[MAX_MISSOES + 1];
+    memset(calculado, 0, sizeof(calculado));
+    
+    int total = 0;
+    for (int j = 0; j < quantidade; j++) {
+        const Objetivo *objetivo = &objetivos[j];
+        int id = objetivo->idMissao;
+        if (objetivo->tipo == MISSAO_REGIAO && objetivo->regiaoMapa < 0 && id >= 1 && id <= MAX_MISSOES) {
+            if (!calculado[id]) {
+                donos[id] = donoDaRegiao(mapa, objetivo->regiao, objetivo->tamanhoRegiao);
+                calculado[id] = 1;
+            }
+            cumpridas[j] = (donos[id] == objetivo->corJogador);
+        } else {
+            cumpridas[j] = verificarVitoria(mapa, objetivo);
+        }
+        total += cumpridas[j];
+    }
+    return total;
+}
+
+/**
+ * contarTerritoriosDaCor()
+ * Retorna quantos territórios pertencem a uma determinada cor, em O(1).
+ * Parâmetros:
+ *   - mapa: mapa da partida (const - apenas leitura)
+ *   - cor: cor do exército procurado
+ * Retorna:
+ *   - Número de territórios daquela cor
+ */
+int contarTerritoriosDaCor(const Mapa *mapa, IdCor cor) {
+    return mapa->territoriosPorCor[cor];
+}
+
+/**
+ * jogarPartidaAutomatica()
+ * Joga uma partida completa sem nenhuma entrada/saída.
+ * As cores jogam em rodízio (na ordem dos seus IDs) e cada uma faz um ataque válido sorteado por turno.
+ * Com uma rodada por ataque os dados são lançados como no jogo interativo;
+ * com mais, cada ataque é uma batalha inteira resolvida por resolverBatalha().
+ * A partida termina quando o jogador cumpre a missão, perde todos os seus
+ * territórios, ninguém mais consegue atacar ou o limite de turnos é atingido.
+ * Parâmetros:
+ *   - mapa: mapa da partida (já inicializado; é modificado)
+ *   - idMissao: missão sorteada para o jogador
+ *   - corJogador: cor do exército do jogador
+ *   - rodadasPorAtaque: rodadas de cada batalha (1 = uma rodada de dados)
+ *   - gerador: gerador de números aleatórios da partida
+ *   - ataques[]: vetor de trabalho com limiteAtaques(mapa) posições
+ *   - turnos: recebe o número de turnos jogados
+ * Retorna:
+ *   - 1 se o jogador cumpriu a missão, 0 caso contrário
+ */
+int jogarPartidaAutomatica(Mapa *mapa, int idMissao, IdCor corJogador, int rodadasPorAtaque,
+                           GeradorAleatorio *gerador, Ataque ataques[], int *turnos) {
+    Objetivo objetivo = prepararObjetivo(mapa, idMissao, corJogador);
+    int numCores = mapa->cores->quantidade;
+    int coresSemAtaque = 0;  // Cores seguidas que não tinham nenhum ataque possível
+    
+    // Os dados são lançados em lote e consumidos dois a dois
+    uint8_t dados[TAM_RESERVA_DADOS];
+    int proximoDado = TAM_RESERVA_DADOS;
+    
+    for (int turno = 0; turno < MAX_TURNOS_SIMULACAO; turno++) {
+        IdCor cor = (IdCor) (turno % numCores);
+        
+        // Lista os ataques válidos da cor da vez (só territórios de fronteira)
+        int candidatos = listarAtaques(mapa, cor, ataques, limiteAtaques(mapa));
+        
+        if (candidatos == 0) {
+            if (++coresSemAtaque >= numCores) {
+                *turnos = turno + 1;
+                return 0;  // Ninguém mais consegue atacar
+            }
+            continue;
+        }
+        coresSemAtaque = 0;
+        
+        // Sorteia um dos ataques válidos
+        const Ataque *escolhido = &ataques[sortearIntervalo(gerador, (uint32_t) candidatos)];
+        int atacante = escolhido->atacante;
+        int defensor = escolhido->defensor;
+        
+        ResultadoAtaque resultado;
+        if (rodadasPorAtaque > 1) {
+            resultado = resolverBatalha(mapa, atacante, defensor, rodadasPorAtaque, gerador, NULL);
+        } else {
+            if (proximoDado + 2 > TAM_RESERVA_DADOS) {
+                rolarDados(gerador, dados, TAM_RESERVA_DADOS);
+                CONTAR(CONTADOR_DADOS_SIMULADOS, TAM_RESERVA_DADOS);
+                proximoDado = 0;
+            }
+            int dadoAtacante = dados[proximoDado++];
+            int dadoDefensor = dados[proximoDado++];
+            resultado = resolverAtaque(mapa, atacante, defensor, dadoAtacante, dadoDefensor, NULL);
+        }
+        if (resultado != ATAQUE_CONQUISTA) {
+            continue;
+        }
+        CONTAR(CONTADOR_CONQUISTAS_SIMULADAS, 1);
+        
+        // Só uma conquista pode mudar o resultado da partida
+        if (mapa->territoriosPorCor[corJogador] == 0) {
+            *turnos = turno + 1;
+            return 0;
+        }
+        // A missão pode ser cumprida pela conquista de qualquer exército
+        // (outro exército pode eliminar a cor alvo, por exemplo)
+        if (verificarVitoria(mapa, &objetivo)) {
+            *turnos = turno + 1;
+            return 1;
+        }
+    }
+    
+    *turnos = MAX_TURNOS_SIMULACAO;
+    return 0;
+}
+
+/**
+ * executarTrabalhoSimulacao()
+ * Função de entrada de cada thread da simulação em lote.
+ * Cada thread usa seu próprio mapa e acumula as estatísticas localmente,
+ * publicando-as em TrabalhoSimulacao apenas ao final.
+ * Parâmetros:
+ *   - argumento: ponteiro para o TrabalhoSimulacao da thread
+ * Retorna:
+ *   - NULL
+ */
+void* executarTrabalhoSimulacao(void *argumento) {
+    TrabalhoSimulacao *trabalho = (TrabalhoSimulacao*) argumento;
+    EstatisticaMissao local[MAX_MISSOES + 1];
+    memset(local, 0, sizeof(local));
+    
+    Mapa *mapa = clonarMapa(trabalho->modelo);
+    Ataque *ataques = (Ataque*) malloc((limiteAtaques(trabalho->modelo) + 1) * sizeof(Ataque));
+    if (mapa == NULL || ataques == NULL) {
+        liberarMemoria(mapa);
+        free(ataques);
+        trabalho->falhou = 1;
+        return NULL;
+    }
+    
+    for (long long partida = trabalho->primeiraPartida; partida < trabalho->ultimaPartida; partida++) {
+        // A semente depende só do número da partida: o resultado não muda
+        // com a quantidade de threads.
+        GeradorAleatorio gerador;
+        semearGerador(&gerador, trabalho->sementeBase ^ ((uint64_t) partida * 0x9E3779B97F4A7C15ULL));
+        copiarEstadoMapa(mapa, trabalho->modelo);
+        
+        int missao = sortearMissao(mapa, &gerador);
+        int turnos;
+        int venceu = jogarPartidaAutomatica(mapa, missao, trabalho->corJogador, trabalho->rodadasPorAtaque,
+                                            &gerador, ataques, &turnos);
+        
+        local[missao].partidas++;
+        local[missao].vitorias += venceu;
+        local[missao].turnos += turnos;
+    }
+    
+    memcpy(trabalho->porMissao, local, sizeof(local));
+    liberarMemoria(mapa);
+    free(ataques);
+    return NULL;
+}
+
+/**
+ * executarSimulacao()
+ * Roda várias partidas automáticas distribuídas entre threads e exibe
+ * a taxa de vitória por missão.
+ * Parâmetros:
+ *   - modelo: mapa inicial, copiado por cada thread no início de cada partida
+ *   - numPartidas: total de partidas a simular
+ *   - semente: semente base (a mesma semente reproduz o mesmo relatório)
+ *   - numThreads: número de threads de trabalho
+ *   - rodadasPorAtaque: rodadas de cada batalha (1 = uma rodada de dados por ataque)
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro
+ */
+int executarSimulacao(const Mapa *modelo, long long numPartidas, uint64_t semente, int numThreads,
+                      int rodadasPorAtaque) {
+    if (numPartidas < 1) {
+        printf("❌ O número de partidas deve ser positivo!\n");
+        return 1;
+    }
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    if (rodadasPorAtaque < 1) {
+        rodadasPorAtaque = 1;
+    }
+    if (numThreads > MAX_THREADS) {
+        numThreads = MAX_THREADS;
+    }
+    if (numThreads > numPartidas) {
+        numThreads = (int) numPartidas;
+    }
+    
+    // Cor do jogador simulado (a primeira cor do mapa, se não houver Azul)
+    IdCor corJogador = buscarCor(modelo, "Azul");
+    if (corJogador == COR_INVALIDA) {
+        corJogador = 0;
+    }
+    
+    TrabalhoSimulacao trabalhos[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    
+    int iniciadas = 0;
+    for (int t = 0; t < numThreads; t++) {
+        TrabalhoSimulacao *trabalho = &trabalhos[t];
+        memset(trabalho, 0, sizeof(*trabalho));
+        trabalho->primeiraPartida = numPartidas * t / numThreads;
+        trabalho->ultimaPartida = numPartidas * (t + 1) / numThreads;
+        trabalho->sementeBase = semente;
+        trabalho->modelo = modelo;
+        trabalho->corJogador = corJogador;
+        trabalho->rodadasPorAtaque = rodadasPorAtaque;
+        
+        if (pthread_create(&threads[t], NULL, executarTrabalhoSimulacao, trabalho) != 0) {
+            trabalho->falhou = 1;
+            break;
+        }
+        iniciadas++;
+    }
+    
+    int numMissoes = modelo->missoes != NULL ? modelo->missoes->quantidade : 0;
+    EstatisticaMissao total[MAX_MISSOES + 1];
+    memset(total, 0, sizeof(total));
+    int falhou = (iniciadas < numThreads);
+    for (int t = 0; t < iniciadas; t++) {
+        pthread_join(threads[t], NULL);
+        falhou |= trabalhos[t].falhou;
+        for (int m = 0; m <= numMissoes; m++) {
+            total[m].partidas += trabalhos[t].porMissao[m].partidas;
+            total[m].vitorias += trabalhos[t].porMissao[m].vitorias;
+            total[m].turnos += trabalhos[t].porMissao[m].turnos;
+        }
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    
+    if (falhou) {
+        printf("❌ Erro ao executar as threads da simulação!\n");
+        return 1;
+    }
+    
+    double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    
+    printf("╔════════════════════════════════════════════════════════════════╗\n");
+    printf("║                 📊 RESULTADO DA SIMULAÇÃO 📊                   ║\n");
+    printf("╚════════════════════════════════════════════════════════════════╝\n\n");
+    printf("Partidas: %lld | Threads: %d | Semente: %" PRIu64 " | Rodadas por ataque: %d\n",
+           numPartidas, numThreads, semente, rodadasPorAtaque);
+    printf("Tempo: %.3f s (%.0f partidas/s)\n\n", segundos, segundos > 0 ? numPartidas / segundos : 0.0);
+    
+    printf("┌────────┬──────────────┬──────────────┬──────────┬──────────────┐\n");
+    printf("│ Missão │   PARTIDAS   │   VITÓRIAS   │   TAXA   │ TURNOS MÉDIOS│\n");
+    printf("├────────┼──────────────┼──────────────┼──────────┼──────────────┤\n");
+    for (int m = 1; m <= numMissoes; m++) {
+        double taxa = total[m].partidas ? 100.0 * total[m].vitorias / total[m].partidas : 0.0;
+        double turnosMedios = total[m].partidas ? (double) total[m].turnos / total[m].partidas : 0.0;
+        printf("│ %6d │ %12lld │ %12lld │ %7.2f%% │ %12.1f │\n",
+               m, total[m].partidas, total[m].vitorias, taxa, turnosMedios);
+    }
+    printf("└────────┴──────────────┴──────────────┴──────────┴──────────────┘\n");
+    
+    return 0;
+}
+
+// Índice do trabalhador que executa a thread atual (-1 fora do pool), usado
+// para que tarefas criadas dentro de outra tarefa fiquem na fila local.
+static _Thread_local int trabalhadorAtual = -1;
+
+/**
+ * empilharTarefa()
+ * Coloca uma tarefa no fim da fila de um trabalhador, aumentando-a se preciso.
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 se faltou memória
+ */
+static int empilharTarefa(FilaTarefas *fila, Tarefa tarefa) {
+    pthread_mutex_lock(&fila->trava);
+    if (fila->fim == fila->capacidade) {
+        // Reaproveita o espaço já consumido no começo antes de crescer
+        int ocupadas = fila->fim - fila->inicio;
+        if (fila->inicio > 0) {
+            memmove(fila->itens, fila->itens + fila->inicio, ocupadas * sizeof(Tarefa));
+        }
+        fila->inicio = 0;
+        fila->fim = ocupadas;
+        if (fila->fim == fila->capacidade) {
+            int novaCapacidade = fila->capacidade ? fila->capacidade * 2 : 64;
+            Tarefa *itens = (Tarefa*) realloc(fila->itens, novaCapacidade * sizeof(Tarefa));
+            if (itens == NULL) {
+                pthread_mutex_unlock(&fila->trava);
+                return 1;
+            }
+            fila->itens = itens;
+            fila->capacidade = novaCapacidade;
+        }
+    }
+    fila->itens[fila->fim++] = tarefa;
+    pthread_mutex_unlock(&fila->trava);
+    return 0;
+}
+
+/**
+ * retirarTarefa()
+ * Retira uma tarefa da fila: o dono pega a mais recente (fim, ainda quente
+ * no cache) e os ladrões pegam a mais antiga (início), longe do dono.
+ * Retorna:
+ *   - 1 se conseguiu uma tarefa, 0 se a fila estava vazia
+ */
+static int retirarTarefa(FilaTarefas *fila, int roubo, Tarefa *tarefa) {
+    int conseguiu = 0;
+    pthread_mutex_lock(&fila->trava);
+    if (fila->inicio < fila->fim) {
+        *tarefa = roubo ? fila->itens[fila->inicio++] : fila->itens[--fila->fim];
+        conseguiu = 1;
+        if (fila->inicio == fila->fim) {
+            fila->inicio = fila->fim = 0;
+        }
+    }
+    pthread_mutex_unlock(&fila->trava);
+    return conseguiu;
+}
+
+/**
+ * executarTrabalhador()
+ * Laço de cada thread do pool: esvazia a própria fila, rouba das vizinhas
+ * quando ela acaba e dorme quando não há mais nada na fila de ninguém.
+ * Parâmetros:
+ *   - argumento: ponteiro para o CabecaTrabalhador da thread
+ * Retorna:
+ *   - NULL
+ */
+static void* executarTrabalhador(void *argumento) {
+    CabecaTrabalhador *cabeca = (CabecaTrabalhador*) argumento;
+    PoolTrabalho *pool = cabeca->pool;
+    int id = cabeca->id;
+    trabalhadorAtual = id;
+    
+    for (;;) {
+        Tarefa tarefa;
+        int conseguiu = retirarTarefa(&pool->filas[id], 0, &tarefa);
+        for (int k = 1; !conseguiu && k < pool->numTrabalhadores; k++) {
+            conseguiu = retirarTarefa(&pool->filas[(id + k) % pool->numTrabalhadores], 1, &tarefa);
+        }
+        
+        if (conseguiu) {
+            pthread_mutex_lock(&pool->trava);
+            pool->naFila--;
+            pthread_mutex_unlock(&pool->trava);
+            
+            tarefa.funcao(tarefa.argumento, id);
+            
+            pthread_mutex_lock(&pool->trava);
+            if (--pool->pendentes == 0) {
+                pthread_cond_broadcast(&pool->terminou);
+            }
+            pthread_mutex_unlock(&pool->trava);
+            continue;
+        }
+        
+        pthread_mutex_lock(&pool->trava);
+        while (pool->naFila == 0 && !pool->encerrando) {
+            pthread_cond_wait(&pool->temTrabalho, &pool->trava);
+        }
+        int sair = pool->encerrando && pool->naFila == 0;
+        pthread_mutex_unlock(&pool->trava);
+        if (sair) {
+            return NULL;
+        }
+    }
+}
+
+/**
+ * criarPool()
+ * Cria um pool fixo de threads, cada uma com sua fila de tarefas.
+ * Parâmetros:
+ *   - numTrabalhadores: número de threads (limitado a 1..MAX_THREADS)
+ * Retorna:
+ *   - Ponteiro para o pool, ou NULL em caso de erro
+ */
+PoolTrabalho* criarPool(int numTrabalhadores) {
+    if (numTrabalhadores < 1) {
+        numTrabalhadores = 1;
+    }
+    if (numTrabalhadores > MAX_THREADS) {
+        numTrabalhadores = MAX_THREADS;
+    }
+    
+    PoolTrabalho *pool = (PoolTrabalho*) calloc(1, sizeof(PoolTrabalho));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->filas = (FilaTarefas*) calloc(numTrabalhadores, sizeof(FilaTarefas));
+    pool->cabecas = (CabecaTrabalhador*) calloc(numTrabalhadores, sizeof(CabecaTrabalhador));
+    pool->threads = (pthread_t*) calloc(numTrabalhadores, sizeof(pthread_t));
+    if (pool->filas == NULL || pool->cabecas == NULL || pool->threads == NULL) {
+        free(pool->filas);
+        free(pool->cabecas);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+    
+    pthread_mutex_init(&pool->trava, NULL);
+    pthread_cond_init(&pool->temTrabalho, NULL);
+    pthread_cond_init(&pool->terminou, NULL);
+    for (int t = 0; t < numTrabalhadores; t++) {
+        pthread_mutex_init(&pool->filas[t].trava, NULL);
+    }
+    
+    // O tamanho é fixado antes de criar as threads, que o leem ao roubar tarefas
+    pool->numTrabalhadores = numTrabalhadores;
+    int criadas = 0;
+    for (int t = 0; t < numTrabalhadores; t++) {
+        pool->cabecas[t].pool = pool;
+        pool->cabecas[t].id = t;
+        if (pthread_create(&pool->threads[t], NULL, executarTrabalhador, &pool->cabecas[t]) != 0) {
+            break;
+        }
+        criadas++;
+    }
+    
+    if (criadas < numTrabalhadores) {
+        // Encerra só as threads que chegaram a ser criadas
+        pthread_mutex_lock(&pool->trava);
+        pool->encerrando = 1;
+        pthread_cond_broadcast(&pool->temTrabalho);
+        pthread_mutex_unlock(&pool->trava);
+        for (int t = 0; t < criadas; t++) {
+            pthread_join(pool->threads[t], NULL);
+        }
+        pool->numTrabalhadores = 0;
+        destruirPool(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/**
+ * enviarTarefa()
+ * Agenda uma tarefa. Dentro do pool ela vai para a fila do próprio
+ * trabalhador; fora dele, as filas são usadas em rodízio.
+ * Parâmetros:
+ *   - pool: pool de threads
+ *   - funcao: função a executar, que recebe o argumento e o índice do trabalhador
+ *   - argumento: dado repassado à função
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 se faltou memória
+ */
+int enviarTarefa(PoolTrabalho *pool, FuncaoTarefa funcao, void *argumento) {
+    Tarefa tarefa = { funcao, argumento };
+    int fila = trabalhadorAtual;
+    if (fila < 0 || fila >= pool->numTrabalhadores) {
+        pthread_mutex_lock(&pool->trava);
+        fila = pool->proximaFila;
+        pool->proximaFila = (pool->proximaFila + 1) % pool->numTrabalhadores;
+        pthread_mutex_unlock(&pool->trava);
+    }
+    
+    // Conta a tarefa antes de publicá-la, para aguardarPool() não retornar cedo
+    pthread_mutex_lock(&pool->trava);
+    pool->pendentes++;
+    pool->naFila++;
+    pthread_mutex_unlock(&pool->trava);
+    
+    if (empilharTarefa(&pool->filas[fila], tarefa) != 0) {
+        pthread_mutex_lock(&pool->trava);
+        pool->naFila--;
+        if (--pool->pendentes == 0) {
+            pthread_cond_broadcast(&pool->terminou);
+        }
+        pthread_mutex_unlock(&pool->trava);
+        return 1;
+    }
+    
+    pthread_mutex_lock(&pool->trava);
+    pthread_cond_signal(&pool->temTrabalho);
+    pthread_mutex_unlock(&pool->trava);
+    return 0;
+}
+
+/**
+ * aguardarPool()
+ * Bloqueia até que todas as tarefas enviadas (inclusive as criadas por
+ * outras tarefas) tenham terminado. Não deve ser chamada de dentro do pool.
+ * Parâmetros:
+ *   - pool: pool de threads
+ */
+void aguardarPool(PoolTrabalho *pool) {
+    pthread_mutex_lock(&pool->trava);
+    while (pool->pendentes > 0) {
+        pthread_cond_wait(&pool->terminou, &pool->trava);
+    }
+    pthread_mutex_unlock(&pool->trava);
+}
+
+/**
+ * destruirPool()
+ * Termina as tarefas pendentes, encerra as threads e libera o pool.
+ * Parâmetros:
+ *   - pool: pool de threads (pode ser NULL)
+ */
+void destruirPool(PoolTrabalho *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    
+    pthread_mutex_lock(&pool->trava);
+    pool->encerrando = 1;
+    pthread_cond_broadcast(&pool->temTrabalho);
+    pthread_mutex_unlock(&pool->trava);
+    for (int t = 0; t < pool->numTrabalhadores; t++) {
+        pthread_join(pool->threads[t], NULL);
+    }
+    
+    for (int t = 0; t < pool->numTrabalhadores; t++) {
+        pthread_mutex_destroy(&pool->filas[t].trava);
+        free(pool->filas[t].itens);
+    }
+    pthread_mutex_destroy(&pool->trava);
+    pthread_cond_destroy(&pool->temTrabalho);
+    pthread_cond_destroy(&pool->terminou);
+    free(pool->filas);
+    free(pool->cabecas);
+    free(pool->threads);
+    free(pool);
+}
+
+/**
+ * segundosDesde()
+ * Tempo decorrido desde um instante de CLOCK_MONOTONIC, em segundos.
+ */
+static double segundosDesde(const struct timespec *inicio) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (agora.tv_sec - inicio->tv_sec) + (agora.tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+/**
+ * criarMotorIA()
+ * Prepara o pool de threads e um mapa de trabalho (com diário) por thread
+ * para as buscas dos jogadores controlados pelo computador.
+ * Parâmetros:
+ *   - mapa: mapa da partida (os mapas de trabalho são clones dele)
+ *   - numThreads: número de threads da busca
+ *   - orcamentoMs: tempo máximo de busca por jogada, em milissegundos
+ *   - semente: semente das simulações da busca
+ * Retorna:
+ *   - Ponteiro para o motor, ou NULL em caso de erro
+ */
+MotorIA* criarMotorIA(const Mapa *mapa, int numThreads, int orcamentoMs, uint64_t semente) {
+    MotorIA *motor = (MotorIA*) calloc(1, sizeof(MotorIA));
+    if (motor == NULL) {
+        return NULL;
+    }
+    motor->pool = criarPool(numThreads);
+    if (motor->pool == NULL) {
+        free(motor);
+        return NULL;
+    }
+    
+    int numTrabalhadores = motor->pool->numTrabalhadores;
+    motor->rascunhos = (Mapa**) calloc(numTrabalhadores, sizeof(Mapa*));
+    motor->ataques = (Ataque**) calloc(numTrabalhadores, sizeof(Ataque*));
+    motor->buscaDoRascunho = (uint64_t*) calloc(numTrabalhadores, sizeof(uint64_t));
+    if (motor->rascunhos == NULL || motor->ataques == NULL || motor->buscaDoRascunho == NULL) {
+        destruirMotorIA(motor);
+        return NULL;
+    }
+    for (int t = 0; t < numTrabalhadores; t++) {
+        motor->rascunhos[t] = clonarMapa(mapa);
+        motor->ataques[t] = (Ataque*) malloc((limiteAtaques(mapa) + 1) * sizeof(Ataque));
+        if (motor->rascunhos[t] == NULL || motor->ataques[t] == NULL || iniciarDiario(motor->rascunhos[t]) != 0) {
+            destruirMotorIA(motor);
+            return NULL;
+        }
+    }
+    
+    motor->orcamentoMs = orcamentoMs;
+    semearGerador(&motor->gerador, semente ^ 0xA1A1A1A1A1A1A1A1ULL);
+    return motor;
+}
+
+/**
+ * destruirMotorIA()
+ * Encerra o pool e libera os mapas de trabalho.
+ * Parâmetros:
+ *   - motor: motor a liberar (pode ser NULL)
+ */
+void destruirMotorIA(MotorIA *motor) {
+    if (motor == NULL) {
+        return;
+    }
+    int numTrabalhadores = motor->pool->numTrabalhadores;
+    destruirPool(motor->pool);
+    for (int t = 0; t < numTrabalhadores; t++) {
+        if (motor->rascunhos != NULL) {
+            liberarMemoria(motor->rascunhos[t]);
+        }
+        if (motor->ataques != NULL) {
+            free(motor->ataques[t]);
+        }
+    }
+    free(motor->rascunhos);
+    free(motor->ataques);
+    free(motor->buscaDoRascunho);
+    free(motor);
+}
+
+/**
+ * simularContinuacao()
+ * Uma simulação da busca: aplica a jogada candidata com dados sorteados e
+ * joga PROFUNDIDADE_IA voltas completas de ataques aleatórios válidos.
+ * Parâmetros:
+ *   - mapa: mapa de trabalho, já com o estado da raiz (é modificado)
+ *   - candidato: jogada a avaliar
+ *   - cor: cor que está decidindo
+ *   - gerador: gerador desta simulação
+ *   - ataques[]: vetor de trabalho com limiteAtaques(mapa) posições
+ * Retorna:
+ *   - Territórios da cor ao final da simulação
+ */
+static int simularContinuacao(Mapa *mapa, const Ataque *candidato, IdCor cor, GeradorAleatorio *gerador,
+                              Ataque ataques[]) {
+    int numCores = mapa->cores->quantidade;
+    int ataquesFeitos = 1;
+    int conquistas = resolverAtaque(mapa, candidato->atacante, candidato->defensor, rolarDado(gerador),
+                                    rolarDado(gerador), NULL) == ATAQUE_CONQUISTA;
+    
+    for (int turno = 1; turno <= PROFUNDIDADE_IA * numCores; turno++) {
+        IdCor vez = (IdCor) ((cor + turno) % numCores);
+        if (mapa->territoriosPorCor[cor] == 0) {
+            break;
+        }
+        int candidatos = listarAtaques(mapa, vez, ataques, limiteAtaques(mapa));
+        if (candidatos == 0) {
+            continue;
+        }
+        const Ataque *escolhido = &ataques[sortearIntervalo(gerador, (uint32_t) candidatos)];
+        ataquesFeitos++;
+        conquistas += resolverAtaque(mapa, escolhido->atacante, escolhido->defensor, rolarDado(gerador),
+                                     rolarDado(gerador), NULL) == ATAQUE_CONQUISTA;
+    }
+    CONTAR(CONTADOR_DADOS_SIMULADOS, 2 * ataquesFeitos);
+    CONTAR(CONTADOR_CONQUISTAS_SIMULADAS, conquistas);
+    return mapa->territoriosPorCor[cor];
+}
+
+/**
+ * executarLoteIA()
+ * Tarefa do pool: roda um lote de simulações de uma jogada candidata no
+ * mapa de trabalho do trabalhador, parando no prazo da jogada. O mapa de
+ * trabalho só copia a raiz no primeiro lote de cada busca; entre uma
+ * simulação e outra ele volta ao instantâneo da raiz, desfazendo só o que a
+ * simulação mudou.
+ * Parâmetros:
+ *   - argumento: ponteiro para o LoteIA
+ *   - trabalhador: índice do trabalhador que executa a tarefa
+ */
+static void executarLoteIA(void *argumento, int trabalhador) {
+    LoteIA *lote = (LoteIA*) argumento;
+    const BuscaIA *busca = lote->busca;
+    Mapa *mapa = busca->motor->rascunhos[trabalhador];
+    Ataque *ataques = busca->motor->ataques[trabalhador];
+    GeradorAleatorio gerador;
+    semearGerador(&gerador, lote->semente);
+    
+    // Cada trabalhador só escreve no seu próprio mapa e na sua própria posição
+    if (busca->motor->buscaDoRascunho[trabalhador] != busca->numero) {
+        copiarEstadoMapa(mapa, busca->raiz);
+        busca->motor->buscaDoRascunho[trabalhador] = busca->numero;
+    }
+    Instantaneo raiz = tirarInstantaneo(mapa);
+    
+    // Acumula localmente para não disputar a linha de cache com os lotes vizinhos
+    double soma = 0.0;
+    int simulacoes = 0;
+    for (; simulacoes < lote->quantidade; simulacoes++) {
+        if (segundosDesde(&busca->inicio) >= busca->prazo) {
+            break;
+        }
+        soma += simularContinuacao(mapa, &busca->candidatos[lote->candidato], busca->cor, &gerador, ataques);
+        if (restaurarInstantaneo(mapa, raiz) != 0) {
+            // Faltou memória para o diário: volta pela cópia completa
+            copiarEstadoMapa(mapa, busca->raiz);
+            raiz = tirarInstantaneo(mapa);
+        }
+    }
+    lote->soma = soma;
+    lote->simulacoes = simulacoes;
+}
+
+/**
+ * escolherJogadaIA()
+ * Escolhe o ataque de uma cor controlada pelo computador. Os ataques válidos
+ * são pré-ordenados pela chance exata de conquista (tabela de batalha) e os
+ * MAX_CANDIDATOS_IA melhores disputam por eliminação sucessiva: a cada etapa
+ * todos os sobreviventes recebem o mesmo número de simulações, executadas em
+ * paralelo no pool, e a metade pior é descartada, até sobrar um ou o tempo
+ * acabar.
+ * Parâmetros:
+ *   - motor: motor de IA da partida
+ *   - mapa: mapa atual (const - apenas leitura)
+ *   - cor: cor que vai jogar
+ *   - escolhida: recebe o ataque escolhido
+ * Retorna:
+ *   - Número de simulações feitas (0 se a escolha foi direta),
+ *     ou -1 se a cor não tem nenhum ataque válido
+ */
+long long escolherJogadaIA(MotorIA *motor, const Mapa *mapa, IdCor cor, Ataque *escolhida) {
+    Ataque *ataques = motor->ataques[0];
+    int total = listarAtaques(mapa, cor, ataques, limiteAtaques(mapa));
+    if (total == 0) {
+        return -1;
+    }
+    
+    // Pré-seleção: guarda os candidatos com maior chance de conquista
+    BuscaIA busca;
+    memset(&busca, 0, sizeof(busca));
+    double nota[MAX_CANDIDATOS_IA];
+    for (int i = 0; i < total; i++) {
+        double chance = chanceConquista(mapa->tropas[ataques[i].defensor], RODADAS_PREVISAO);
+        if (busca.numCandidatos == MAX_CANDIDATOS_IA && chance <= nota[busca.numCandidatos - 1]) {
+            continue;
+        }
+        int j = busca.numCandidatos < MAX_CANDIDATOS_IA ? busca.numCandidatos++ : MAX_CANDIDATOS_IA - 1;
+        while (j > 0 && nota[j - 1] < chance) {
+            nota[j] = nota[j - 1];
+            busca.candidatos[j] = busca.candidatos[j - 1];
+            j--;
+        }
+        nota[j] = chance;
+        busca.candidatos[j] = ataques[i];
+    }
+    
+    *escolhida = busca.candidatos[0];
+    if (busca.numCandidatos == 1 || motor->orcamentoMs <= 0) {
+        return 0;
+    }
+    
+    busca.motor = motor;
+    busca.raiz = mapa;
+    busca.numero = ++motor->numBuscas;
+    busca.cor = cor;
+    busca.prazo = motor->orcamentoMs / 1000.0;
+    clock_gettime(CLOCK_MONOTONIC, &busca.inicio);
+    
+    int vivos[MAX_CANDIDATOS_IA];
+    double soma[MAX_CANDIDATOS_IA];
+    long long visitas[MAX_CANDIDATOS_IA];
+    for (int i = 0; i < busca.numCandidatos; i++) {
+        vivos[i] = i;
+        soma[i] = 0.0;
+        visitas[i] = 0;
+    }
+    int numVivos = busca.numCandidatos;
+    long long simulacoes = 0;
+    LoteIA lotes[SIMULACOES_POR_ETAPA_IA / TAM_LOTE_IA + MAX_CANDIDATOS_IA];
+    
+    while (numVivos > 1 && segundosDesde(&busca.inicio) < busca.prazo) {
+        // Cada etapa tem o mesmo total de simulações, dividido entre os
+        // sobreviventes em lotes para o pool
+        int porCandidato = SIMULACOES_POR_ETAPA_IA / numVivos;
+        int numLotes = 0;
+        for (int v = 0; v < numVivos; v++) {
+            for (int feitas = 0; feitas < porCandidato; feitas += TAM_LOTE_IA) {
+                LoteIA *lote = &lotes[numLotes++];
+                memset(lote, 0, sizeof(*lote));
+                lote->busca = &busca;
+                lote->candidato = vivos[v];
+                lote->quantidade = porCandidato - feitas < TAM_LOTE_IA ? porCandidato - feitas : TAM_LOTE_IA;
+                lote->semente = proximoAleatorio(&motor->gerador);
+                if (enviarTarefa(motor->pool, executarLoteIA, lote) != 0) {
+                    numLotes--;
+                }
+            }
+        }
+        aguardarPool(motor->pool);
+        
+        for (int l = 0; l < numLotes; l++) {
+            soma[lotes[l].candidato] += lotes[l].soma;
+            visitas[lotes[l].candidato] += lotes[l].simulacoes;
+            simulacoes += lotes[l].simulacoes;
+        }
+        
+        // Ordena os sobreviventes pela média e descarta a metade pior
+        for (int a = 1; a < numVivos; a++) {
+            int atual = vivos[a];
+            double media = visitas[atual] ? soma[atual] / visitas[atual] : -1.0;
+            int b = a;
+            while (b > 0) {
+                int anterior = vivos[b - 1];
+                double mediaAnterior = visitas[anterior] ? soma[anterior] / visitas[anterior] : -1.0;
+                if (mediaAnterior >= media) {
+                    break;
+                }
+                vivos[b] = anterior;
+                b--;
+            }
+            vivos[b] = atual;
+        }
+        numVivos = (numVivos + 1) / 2;
+    }
+    
+    *escolhida = busca.candidatos[vivos[0]];
+    return simulacoes;
+}
+
+/**
+ * jogarTurnosIA()
+ * Cada cor controlada pelo computador (todas menos a do jogador), em ordem
+ * de ID, recebe os seus reforços e escolhe e faz um ataque, exibindo uma
+ * linha por jogada. Os reforços vão todos para o território de fronteira
+ * mais forte da cor, de onde partem os ataques mais prováveis.
+ * Parâmetros:
+ *   - motor: motor de IA da partida
+ *   - mapa: mapa da partida
+ *   - corJogador: cor do jogador humano (não joga aqui)
+ *   - gerador: gerador de números aleatórios da partida (dados das jogadas)
+ *   - registro: registro de eventos da partida (pode ser NULL)
+ */
+void jogarTurnosIA(MotorIA *motor, Mapa *mapa, IdCor corJogador, GeradorAleatorio *gerador,
+                   RegistroEventos *registro) {
+    printf("\n🤖 Turno dos outros exércitos:\n");
+    
+    for (int c = 0; c < mapa->cores->quantidade; c++) {
+        IdCor cor = (IdCor) c;
+        if (cor == corJogador || mapa->territoriosPorCor[cor] == 0) {
+            continue;
+        }
+        
+        // A lista de fronteira da cor basta: um território interior não ataca
+        const int32_t *fronteira = mapa->fronteiras + (size_t) cor * mapa->quantidade;
+        int destino = -1;
+        for (int32_t f = 0; f < mapa->numFronteiras[cor]; f++) {
+            if (destino < 0 || mapa->tropas[fronteira[f]] > mapa->tropas[destino]) {
+                destino = fronteira[f];
+            }
+        }
+        int reforcos = calcularReforcos(mapa, cor);
+        if (destino >= 0 && posicionarReforco(mapa, destino, reforcos, registro) == 0) {
+            printf("   %-10s 🪖 +%d tropas em %s\n", nomeCor(mapa, cor), reforcos, nomeTerritorio(mapa, destino));
+        }
+        
+        struct timespec inicio;
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        Ataque jogada;
+        long long simulacoes = escolherJogadaIA(motor, mapa, cor, &jogada);
+        double milissegundos = segundosDesde(&inicio) * 1e3;
+        if (simulacoes < 0) {
+            printf("   %-10s sem ataques possíveis\n", nomeCor(mapa, cor));
+            continue;
+        }
+        
+        int dadoAtacante = rolarDado(gerador);
+        int dadoDefensor = rolarDado(gerador);
+        IdCor corDefensor = mapa->cor[jogada.defensor];
+        ResultadoAtaque resultado = resolverAtaque(mapa, jogada.atacante, jogada.defensor,
+                                                   dadoAtacante, dadoDefensor, NULL);
+        registrarAtaque(registro, jogada.atacante, jogada.defensor, dadoAtacante, dadoDefensor, resultado);
+        contarJogada(resultado);
+        
+        const char *desfecho = "o defensor resistiu";
+        if (resultado == ATAQUE_CONQUISTA) {
+            desfecho = "🏴 território conquistado!";
+        } else if (resultado == ATAQUE_ATACANTE_VENCEU) {
+            desfecho = "o defensor perdeu 1 tropa";
+        }
+        printf("   %-10s %s → %s (%s): 🎲 %d x %d, %s  [%lld simulações, %.1f ms]\n",
+               nomeCor(mapa, cor), nomeTerritorio(mapa, jogada.atacante), nomeTerritorio(mapa, jogada.defensor),
+               nomeCor(mapa, corDefensor), dadoAtacante, dadoDefensor, desfecho, simulacoes, milissegundos);
+    }
+}
+
+/**
+ * descarregarRegistro()
+ * Grava no arquivo o que está acumulado no buffer do registro.
+ * Parâmetros:
+ *   - registro: registro de eventos
+ */
+static void descarregarRegistro(RegistroEventos *registro) {
+    if (registro->usado > 0 && fwrite(registro->buffer, 1, registro->usado, registro->arquivo) != registro->usado) {
+        registro->falhou = 1;
+    }
+    registro->usado = 0;
+}
+
+/**
+ * anotarEvento()
+ * Acrescenta um evento ao buffer; o arquivo só é tocado quando o buffer enche.
+ */
+static inline void anotarEvento(RegistroEventos *registro, const EventoJogo *evento) {
+    if (registro->usado + sizeof(EventoJogo) > TAM_BUFFER_REGISTRO) {
+        descarregarRegistro(registro);
+    }
+    memcpy(registro->buffer + registro->usado, evento, sizeof(EventoJogo));
+    registro->usado += sizeof(EventoJogo);
+    registro->eventos++;
+    registro->eventosDesdeCheckpoint++;
+}
+
+/**
+ * gravarCheckpoint()
+ * Grava uma cópia dos donos e das tropas de todos os territórios, a partir
+ * da qual a reprodução pode começar sem voltar ao turno 0.
+ * Parâmetros:
+ *   - registro: registro de eventos
+ *   - mapa: estado atual da partida
+ *   - tipo: EVENTO_CHECKPOINT ou EVENTO_RESTAURACAO
+ */
+static void gravarCheckpoint(RegistroEventos *registro, const Mapa *mapa, TipoEvento tipo) {
+    static const uint8_t zeros[4] = { 0 };
+    size_t bytesCor = (size_t) mapa->quantidade;
+    size_t preenchimento = (4 - bytesCor % 4) % 4;
+    size_t bytesTropas = (size_t) mapa->quantidade * sizeof(int32_t);
+    
+    EventoJogo evento;
+    memset(&evento, 0, sizeof(evento));
+    evento.tipo = (uint8_t) tipo;
+    evento.a = registro->turno;
+    evento.b = (int32_t) (bytesCor + preenchimento + bytesTropas);
+    anotarEvento(registro, &evento);
+    
+    // O conteúdo do checkpoint vai direto para o arquivo, sem passar pelo buffer
+    descarregarRegistro(registro);
+    if (fwrite(mapa->cor, 1, bytesCor, registro->arquivo) != bytesCor ||
+        fwrite(zeros, 1, preenchimento, registro->arquivo) != preenchimento ||
+        fwrite(mapa->tropas, 1, bytesTropas, registro->arquivo) != bytesTropas) {
+        registro->falhou = 1;
+    }
+    registro->eventosDesdeCheckpoint = 0;
+}
+
+/**
+ * abrirRegistro()
+ * Cria um arquivo de registro de eventos e grava o checkpoint do turno 0.
+ * Parâmetros:
+ *   - caminho: arquivo a criar
+ *   - mapa: mapa da partida, no estado inicial
+ *   - semente: semente da partida (guardada no cabeçalho)
+ * Retorna:
+ *   - Ponteiro para o registro, ou NULL em caso de erro
+ */
+RegistroEventos* abrirRegistro(const char *caminho, const Mapa *mapa, uint64_t semente) {
+    RegistroEventos *registro = (RegistroEventos*) calloc(1, sizeof(RegistroEventos));
+    if (registro == NULL) {
+        return NULL;
+    }
+    registro->buffer = (uint8_t*) malloc(TAM_BUFFER_REGISTRO);
+    registro->arquivo = fopen(caminho, "wb");
+    if (registro->buffer == NULL || registro->arquivo == NULL) {
+        printf("❌ Não foi possível criar o registro %s\n", caminho);
+        if (registro->arquivo != NULL) {
+            fclose(registro->arquivo);
+        }
+        free(registro->buffer);
+        free(registro);
+        return NULL;
+    }
+    
+    CabecalhoRegistro cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.assinatura, ASSINATURA_REGISTRO, sizeof(ASSINATURA_REGISTRO));
+    cabecalho.versao = VERSAO_REGISTRO;
+    cabecalho.numTerritorios = (uint32_t) mapa->quantidade;
+    cabecalho.semente = semente;
+    memcpy(registro->buffer, &cabecalho, sizeof(cabecalho));
+    registro->usado = sizeof(cabecalho);
+    
+    gravarCheckpoint(registro, mapa, EVENTO_CHECKPOINT);
+    return registro;
+}
+
+/**
+ * registrarMissao()
+ * Anota a missão sorteada para o jogador.
+ * Parâmetros:
+ *   - registro: registro de eventos (NULL = partida sem registro)
+ *   - idMissao: missão sorteada
+ *   - corJogador: cor do jogador
+ */
+void registrarMissao(RegistroEventos *registro, int idMissao, IdCor corJogador) {
+    if (registro == NULL) {
+        return;
+    }
+    EventoJogo evento;
+    memset(&evento, 0, sizeof(evento));
+    evento.tipo = EVENTO_MISSAO;
+    evento.a = idMissao;
+    evento.b = corJogador;
+    anotarEvento(registro, &evento);
+}
+
+/**
+ * registrarAtaque()
+ * Anota uma rodada de ataque já resolvida: territórios, dados e resultado.
+ * A perda de tropa e a conquista decorrem dos dados e ficam no resultado,
+ * então cada rodada ocupa um único evento de 12 bytes.
+ * Parâmetros:
+ *   - registro: registro de eventos (NULL = partida sem registro)
+ *   - atacante, defensor: territórios do ataque
+ *   - dadoAtacante, dadoDefensor: dados sorteados
+ *   - resultado: retorno de resolverAtaque()
+ */
+void registrarAtaque(RegistroEventos *registro, int atacante, int defensor, int dadoAtacante, int dadoDefensor,
+                     ResultadoAtaque resultado) {
+    if (registro == NULL) {
+        return;
+    }
+    EventoJogo evento;
+    evento.tipo = EVENTO_ATAQUE;
+    evento.dadoAtacante = (uint8_t) dadoAtacante;
+    evento.dadoDefensor = (uint8_t) dadoDefensor;
+    // A missão é do jogador, não do mapa: na reprodução vale só a conquista
+    evento.resultado = (uint8_t) (resultado == ATAQUE_MISSAO_CUMPRIDA ? ATAQUE_CONQUISTA : resultado);
+    evento.a = atacante;
+    evento.b = defensor;
+    anotarEvento(registro, &evento);
+}
+
+/**
+ * registrarTropas()
+ * Anota uma mudança de tropas fora de um ataque (reforços, por exemplo).
+ * Parâmetros:
+ *   - registro: registro de eventos (NULL = partida sem registro)
+ *   - territorio: território alterado
+ *   - variacao: tropas acrescentadas (negativo para retiradas)
+ */
+void registrarTropas(RegistroEventos *registro, int territorio, int32_t variacao) {
+    if (registro == NULL) {
+        return;
+    }
+    EventoJogo evento;
+    memset(&evento, 0, sizeof(evento));
+    evento.tipo = EVENTO_TROPAS;
+    evento.a = territorio;
+    evento.b = variacao;
+    anotarEvento(registro, &evento);
+}
+
+/**
+ * registrarFimTurno()
+ * Marca o fim de um turno e, se já houver eventos suficientes desde o
+ * último checkpoint, grava um novo. O intervalo cresce com o mapa para que
+ * os checkpoints não ocupem mais espaço que os próprios eventos.
+ * Parâmetros:
+ *   - registro: registro de eventos (NULL = partida sem registro)
+ *   - mapa: estado da partida ao fim do turno
+ */
+void registrarFimTurno(RegistroEventos *registro, const Mapa *mapa) {
+    if (registro == NULL) {
+        return;
+    }
+    registro->turno++;
+    EventoJogo evento;
+    memset(&evento, 0, sizeof(evento));
+    evento.tipo = EVENTO_FIM_TURNO;
+    evento.a = registro->turno;
+    anotarEvento(registro, &evento);
+    
+    long long intervalo = mapa->quantidade > EVENTOS_POR_CHECKPOINT ? mapa->quantidade : EVENTOS_POR_CHECKPOINT;
+    if (registro->eventosDesdeCheckpoint >= intervalo) {
+        gravarCheckpoint(registro, mapa, EVENTO_CHECKPOINT);
+    }
+}
+
+/**
+ * registrarRestauracao()
+ * Anota que a partida voltou a um estado anterior (desfazer). O estado
+ * inteiro é gravado, como em um checkpoint: a reprodução o carrega em vez de
+ * tentar desfazer os eventos, e pode começar a partir dele.
+ * Parâmetros:
+ *   - registro: registro de eventos (NULL = partida sem registro)
+ *   - mapa: estado da partida já restaurado
+ *   - turno: turno terminado no estado restaurado
+ */
+void registrarRestauracao(RegistroEventos *registro, const Mapa *mapa, int32_t turno) {
+    if (registro == NULL) {
+        return;
+    }
+    registro->turno = turno;
+    gravarCheckpoint(registro, mapa, EVENTO_RESTAURACAO);
+}
+
+/**
+ * fecharRegistro()
+ * Grava o que falta no buffer, fecha o arquivo e libera o registro.
+ * Parâmetros:
+ *   - registro: registro de eventos (pode ser NULL)
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 se alguma escrita falhou
+ */
+int fecharRegistro(RegistroEventos *registro) {
+    if (registro == NULL) {
+        return 0;
+    }
+    descarregarRegistro(registro);
+    int falhou = registro->falhou;
+    if (fclose(registro->arquivo) != 0) {
+        falhou = 1;
+    }
+    free(registro->buffer);
+    free(registro);
+    return falhou;
+}
+
+/**
+ * carregarCheckpoint()
+ * Copia para o mapa o conteúdo de um checkpoint (ou de uma restauração) e
+ * reconstrói os contadores e as fronteiras.
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro (mensagem já exibida)
+ */
+static int carregarCheckpoint(Mapa *mapa, const uint8_t *conteudo, const char *caminho, int32_t turno) {
+    size_t bytesCor = (size_t) mapa->quantidade;
+    size_t preenchimento = (4 - bytesCor % 4) % 4;
+    for (int i = 0; i < mapa->quantidade; i++) {
+        if (conteudo[i] >= mapa->cores->quantidade) {
+            printf("❌ %s: checkpoint do turno %d está corrompido\n", caminho, turno);
+            return 1;
+        }
+    }
+    memcpy(mapa->cor, conteudo, bytesCor);
+    memcpy(mapa->tropas, conteudo + bytesCor + preenchimento, (size_t) mapa->quantidade * sizeof(int32_t));
+    if (recalcularContagens(mapa) != 0) {
+        printf("❌ Erro ao alocar memória para o mapa!\n");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * aplicarRegistro()
+ * Corpo de reproduzirRegistro(), já com o arquivo mapeado em memória.
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro (mensagem já exibida)
+ */
+static int aplicarRegistro(Mapa *mapa, const uint8_t *dados, size_t tamanho, const char *caminho,
+                           int32_t turnoAlvo, ResumoReproducao *resumo) {
+    const CabecalhoRegistro *cabecalho = (const CabecalhoRegistro*) dados;
+    if (memcmp(cabecalho->assinatura, ASSINATURA_REGISTRO, sizeof(ASSINATURA_REGISTRO)) != 0 ||
+        cabecalho->versao < 1 || cabecalho->versao > VERSAO_REGISTRO) {
+        printf("❌ %s não é um registro de partida válido\n", caminho);
+        return 1;
+    }
+    if (cabecalho->numTerritorios != (uint32_t) mapa->quantidade) {
+        printf("❌ O registro é de um mapa com %u territórios, mas o mapa atual tem %d\n",
+               cabecalho->numTerritorios, mapa->quantidade);
+        return 1;
+    }
+    resumo->semente = cabecalho->semente;
+    
+    size_t bytesCor = (size_t) mapa->quantidade;
+    size_t preenchimento = (4 - bytesCor % 4) % 4;
+    size_t bytesCheckpoint = bytesCor + preenchimento + (size_t) mapa->quantidade * sizeof(int32_t);
+    
+    // 1ª passada: acha o último checkpoint até o turno pedido, sem aplicar nada.
+    // Depois de uma restauração (desfazer) os turnos recomeçam de um número
+    // menor, então a busca vai até o fim em vez de parar no primeiro turno maior.
+    size_t posicao = sizeof(CabecalhoRegistro);
+    size_t inicioReproducao = 0;
+    while (posicao + sizeof(EventoJogo) <= tamanho) {
+        const EventoJogo *evento = (const EventoJogo*) (dados + posicao);
+        posicao += sizeof(EventoJogo);
+        if (evento->tipo == EVENTO_MISSAO) {
+            resumo->idMissao = evento->a;
+            resumo->corJogador = (IdCor) evento->b;
+        } else if (evento->tipo == EVENTO_CHECKPOINT || evento->tipo == EVENTO_RESTAURACAO) {
+            if ((size_t) evento->b != bytesCheckpoint || bytesCheckpoint > tamanho - posicao) {
+                break;  // Checkpoint truncado (partida interrompida) ou corrompido
+            }
+            if (turnoAlvo < 0 || evento->a <= turnoAlvo) {
+                inicioReproducao = posicao - sizeof(EventoJogo);
+            }
+            posicao += bytesCheckpoint;
+        }
+    }
+    if (inicioReproducao == 0) {
+        printf("❌ %s não tem nenhum checkpoint utilizável\n", caminho);
+        return 1;
+    }
+    
+    // Carrega o checkpoint e reconstrói os contadores e as fronteiras
+    const EventoJogo *checkpoint = (const EventoJogo*) (dados + inicioReproducao);
+    posicao = inicioReproducao + sizeof(EventoJogo);
+    if (carregarCheckpoint(mapa, dados + posicao, caminho, checkpoint->a) != 0) {
+        return 1;
+    }
+    resumo->turnoCheckpoint = checkpoint->a;
+    resumo->turno = checkpoint->a;
+    posicao += bytesCheckpoint;
+    
+    // 2ª passada: reaplica as rodadas a partir do checkpoint
+    while (posicao + sizeof(EventoJogo) <= tamanho && (turnoAlvo < 0 || resumo->turno < turnoAlvo)) {
+        const EventoJogo *evento = (const EventoJogo*) (dados + posicao);
+        posicao += sizeof(EventoJogo);
+        
+        if (evento->tipo == EVENTO_ATAQUE) {
+            int atacante = evento->a;
+            int defensor = evento->b;
+            if (atacante < 0 || atacante >= mapa->quantidade || defensor < 0 || defensor >= mapa->quantidade ||
+                evento->dadoAtacante < 1 || evento->dadoAtacante > 6 ||
+                evento->dadoDefensor < 1 || evento->dadoDefensor > 6 ||
+                validarAtaque(mapa, atacante, defensor) != ATAQUE_VALIDO ||
+                resolverAtaque(mapa, atacante, defensor, evento->dadoAtacante, evento->dadoDefensor, NULL)
+                    != (ResultadoAtaque) evento->resultado) {
+                printf("❌ %s: evento %lld não confere com o estado do mapa\n", caminho, resumo->eventos);
+                return 1;
+            }
+            resumo->ataques++;
+        } else if (evento->tipo == EVENTO_TROPAS) {
+            int territorio = evento->a;
+            if (territorio < 0 || territorio >= mapa->quantidade ||
+                (int64_t) mapa->tropas[territorio] + evento->b < 1 ||
+                (int64_t) mapa->tropas[territorio] + evento->b > INT32_MAX) {
+                printf("❌ %s: evento %lld não confere com o estado do mapa\n", caminho, resumo->eventos);
+                return 1;
+            }
+            anotarEscrita(mapa, &mapa->tropas[territorio]);
+            mapa->tropas[territorio] += evento->b;
+        } else if (evento->tipo == EVENTO_FIM_TURNO) {
+            resumo->turno = evento->a;
+        } else if (evento->tipo == EVENTO_CHECKPOINT || evento->tipo == EVENTO_RESTAURACAO) {
+            if (bytesCheckpoint > tamanho - posicao) {
+                break;
+            }
+            // Um checkpoint repete o estado atual; uma restauração o substitui
+            if (evento->tipo == EVENTO_RESTAURACAO) {
+                if (carregarCheckpoint(mapa, dados + posicao, caminho, evento->a) != 0) {
+                    return 1;
+                }
+                resumo->turno = evento->a;
+            }
+            posicao += bytesCheckpoint;
+        }
+        resumo->eventos++;
+    }
+    
+    if (turnoAlvo >= 0 && resumo->turno < turnoAlvo) {
+        printf("⚠️  O registro termina no turno %d; exibindo o último estado.\n", resumo->turno);
+    }
+    return 0;
+}
+
+/**
+ * reproduzirRegistro()
+ * Leva o mapa ao estado do fim de um turno registrado. O arquivo é mapeado
+ * em memória; uma primeira passada só salta de evento em evento até o último
+ * checkpoint anterior ao turno pedido, e a partir dele as rodadas são
+ * reaplicadas com resolverAtaque(), conferindo cada resultado.
+ * Parâmetros:
+ *   - mapa: mapa da partida (mesmo mapa usado ao gravar; é modificado)
+ *   - caminho: arquivo de registro
+ *   - turnoAlvo: turno desejado (negativo = até o fim do registro)
+ *   - resumo: recebe o turno alcançado, a missão e as contagens
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro
+ */
+int reproduzirRegistro(Mapa *mapa, const char *caminho, int32_t turnoAlvo, ResumoReproducao *resumo) {
+    memset(resumo, 0, sizeof(*resumo));
+    resumo->turnoCheckpoint = -1;
+    
+    int descritor = open(caminho, O_RDONLY);
+    struct stat info;
+    if (descritor < 0 || fstat(descritor, &info) != 0) {
+        printf("❌ Não foi possível abrir o registro %s\n", caminho);
+        if (descritor >= 0) {
+            close(descritor);
+        }
+        return 1;
+    }
+    
+    size_t tamanho = (size_t) info.st_size;
+    void *base = (tamanho >= sizeof(CabecalhoRegistro))
+               ? mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, descritor, 0)
+               : MAP_FAILED;
+    close(descritor);
+    if (base == MAP_FAILED) {
+        printf("❌ %s não é um registro de partida válido\n", caminho);
+        return 1;
+    }
+    
+    int status = aplicarRegistro(mapa, (const uint8_t*) base, tamanho, caminho, turnoAlvo, resumo);
+    munmap(base, tamanho);
+    return status;
+}
+
+/**
+ * abrirComandos()
+ * Abre um arquivo de comandos para leitura em blocos.
+ * Parâmetros:
+ *   - caminho: arquivo de comandos ("-" para a entrada padrão, como um pipe)
+ * Retorna:
+ *   - Ponteiro para o leitor, ou NULL em caso de erro
+ */
+LeitorComandos* abrirComandos(const char *caminho) {
+    int usarEntrada = strcmp(caminho, "-") == 0;
+    int descritor = usarEntrada ? STDIN_FILENO : open(caminho, O_RDONLY);
+    if (descritor < 0) {
+        printf("❌ Não foi possível abrir o arquivo de comandos %s\n", caminho);
+        return NULL;
+    }
+    
+    LeitorComandos *leitor = (LeitorComandos*) calloc(1, sizeof(LeitorComandos));
+    // Um byte a mais para o '\0' da última linha quando o buffer está cheio
+    char *buffer = (char*) malloc(TAM_BUFFER_COMANDOS + 1);
+    if (leitor == NULL || buffer == NULL) {
+        printf("❌ Erro ao alocar memória para o leitor de comandos!\n");
+        free(leitor);
+        free(buffer);
+        if (!usarEntrada) {
+            close(descritor);
+        }
+        return NULL;
+    }
+    leitor->descritor = descritor;
+    leitor->fecharAoFim = !usarEntrada;
+    leitor->buffer = buffer;
+    return leitor;
+}
+
+/**
+ * proximaLinha()
+ * Devolve a próxima linha do arquivo de comandos, já terminada em '\0'.
+ * O arquivo é lido em blocos de TAM_BUFFER_COMANDOS bytes; uma linha maior
+ * que isso é devolvida truncada e o seu restante é descartado.
+ * Parâmetros:
+ *   - leitor: leitor de comandos
+ *   - linha: recebe o início da linha (válido até a próxima chamada)
+ * Retorna:
+ *   - 1 se uma linha foi lida, 0 no fim do arquivo, -1 em erro de leitura
+ */
+int proximaLinha(LeitorComandos *leitor, char **linha) {
+    char *buffer = leitor->buffer;
+    for (;;) {
+        size_t disponivel = leitor->fim - leitor->inicio;
+        char *quebra = (char*) memchr(buffer + leitor->inicio, '\n', disponivel);
+        
+        if (leitor->descartando) {
+            if (quebra == NULL) {
+                leitor->inicio = leitor->fim;
+            } else {
+                leitor->inicio = (size_t) (quebra - buffer) + 1;
+                leitor->descartando = 0;
+                continue;
+            }
+        } else if (quebra != NULL) {
+            *quebra = '\0';
+            *linha = buffer + leitor->inicio;
+            leitor->inicio = (size_t) (quebra - buffer) + 1;
+            leitor->linha++;
+            return 1;
+        } else if (leitor->terminou || disponivel == TAM_BUFFER_COMANDOS) {
+            if (disponivel == 0) {
+                return 0;
+            }
+            // Última linha sem '\n', ou linha que não cabe no buffer
+            buffer[leitor->fim] = '\0';
+            *linha = buffer + leitor->inicio;
+            leitor->descartando = !leitor->terminou;
+            leitor->inicio = leitor->fim = 0;
+            leitor->linha++;
+            return 1;
+        }
+        if (leitor->terminou) {
+            return 0;
+        }
+        
+        // Move a linha incompleta para o começo e lê o próximo bloco
+        disponivel = leitor->fim - leitor->inicio;
+        memmove(buffer, buffer + leitor->inicio, disponivel);
+        leitor->inicio = 0;
+        leitor->fim = disponivel;
+        ssize_t lidos = read(leitor->descritor, buffer + leitor->fim, TAM_BUFFER_COMANDOS - leitor->fim);
+        if (lidos < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (lidos == 0) {
+            leitor->terminou = 1;
+        }
+        leitor->fim += (size_t) lidos;
+    }
+}
+
+/**
+ * fecharComandos()
+ * Fecha o arquivo de comandos e libera o leitor.
+ * Parâmetros:
+ *   - leitor: leitor de comandos (pode ser NULL)
+ */
+void fecharComandos(LeitorComandos *leitor) {
+    if (leitor == NULL) {
+        return;
+    }
+    if (leitor->fecharAoFim) {
+        close(leitor->descritor);
+    }
+    free(leitor->buffer);
+    free(leitor);
+}
+
+// Pula espaços, tabulações e o '\r' de arquivos gravados no Windows.
+static const char* pularEspacos(const char *cursor) {
+    while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r') {
+        cursor++;
+    }
+    return cursor;
+}
+
+// Lê um inteiro com sinal opcional; devolve NULL se não houver um número
+// válido (ou se ele não couber em um int).
+static const char* lerInteiro(const char *cursor, int *valor) {
+    int negativo = (*cursor == '-');
+    if (*cursor == '-' || *cursor == '+') {
+        cursor++;
+    }
+    if (*cursor < '0' || *cursor > '9') {
+        return NULL;
+    }
+    long long acumulado = 0;
+    while (*cursor >= '0' && *cursor <= '9') {
+        acumulado = acumulado * 10 + (*cursor - '0');
+        if (acumulado > INT32_MAX) {
+            return NULL;
+        }
+        cursor++;
+    }
+    *valor = (int) (negativo ? -acumulado : acumulado);
+    return cursor;
+}
+
+/**
+ * interpretarComando()
+ * Converte uma linha do arquivo de comandos em um Comando. Formatos aceitos
+ * (territórios numerados de 1 a N, como no menu):
+ *   atacar A D | tropas T N | reforcar T N | missao | turno | desfazer | mapa | metricas | sair | # comentário
+ * Parâmetros:
+ *   - linha: texto da linha, terminado em '\0'
+ *   - comando: recebe o comando interpretado
+ * Retorna:
+ *   - O tipo do comando (COMANDO_INVALIDO se a linha não for reconhecida)
+ */
+TipoComando interpretarComando(const char *linha, Comando *comando) {
+    static const struct {
+        const char *palavra;
+        TipoComando tipo;
+        int argumentos;
+    } comandos[] = {
+        {"atacar", COMANDO_ATACAR, 2},
+        {"tropas", COMANDO_TROPAS, 2},
+        {"reforcar", COMANDO_REFORCAR, 2},
+        {"missao", COMANDO_MISSAO, 0},
+        {"turno", COMANDO_TURNO, 0},
+        {"desfazer", COMANDO_DESFAZER, 0},
+        {"mapa", COMANDO_MAPA, 0},
+        {"metricas", COMANDO_METRICAS, 0},
+        {"sair", COMANDO_SAIR, 0},
+    };
+    
+    comando->tipo = COMANDO_INVALIDO;
+    comando->a = 0;
+    comando->b = 0;
+    
+    const char *cursor = pularEspacos(linha);
+    if (*cursor == '\0' || *cursor == '#') {
+        comando->tipo = COMANDO_VAZIO;
+        return COMANDO_VAZIO;
+    }
+    
+    const char *palavra = cursor;
+    while (*cursor != '\0' && *cursor != ' ' && *cursor != '\t' && *cursor != '\r') {
+        cursor++;
+    }
+    size_t tamanho = (size_t) (cursor - palavra);
+    
+    for (size_t i = 0; i < sizeof(comandos) / sizeof(comandos[0]); i++) {
+        if (strlen(comandos[i].palavra) != tamanho || memcmp(comandos[i].palavra, palavra, tamanho) != 0) {
+            continue;
+        }
+        if (comandos[i].argumentos >= 1) {
+            cursor = lerInteiro(pularEspacos(cursor), &comando->a);
+            if (cursor == NULL) {
+                return COMANDO_INVALIDO;
+            }
+        }
+        if (comandos[i].argumentos >= 2) {
+            cursor = lerInteiro(pularEspacos(cursor), &comando->b);
+            if (cursor == NULL) {
+                return COMANDO_INVALIDO;
+            }
+        }
+        cursor = pularEspacos(cursor);
+        if (*cursor != '\0' && *cursor != '#') {
+            return COMANDO_INVALIDO;
+        }
+        comando->tipo = comandos[i].tipo;
+        return comando->tipo;
+    }
+    return COMANDO_INVALIDO;
+}
+
+/**
+ * executarComando()
+ * Aplica um comando à partida, sem pausas nem leituras do teclado. Cada
+ * comando produz uma linha curta na tela da partida.
+ * Parâmetros:
+ *   - partida: partida em andamento
+ *   - comando: comando já interpretado
+ *   - resumo: contadores da execução
+ * Retorna:
+ *   - 0 se o comando pede para encerrar (sair), 1 caso contrário
+ */
+int executarComando(Partida *partida, const Comando *comando, ResumoComandos *resumo) {
+    Mapa *mapa = partida->mapa;
+    Tela *tela = partida->tela;
+    int quantidade = mapa->quantidade;
+    
+    switch (comando->tipo) {
+        case COMANDO_VAZIO:
+            return 1;
+            
+        case COMANDO_ATACAR: {
+            INICIAR_MEDICAO(inicio);
+            int atacante = comando->a - 1;
+            int defensor = comando->b - 1;
+            if (atacante < 0 || atacante >= quantidade || defensor < 0 || defensor >= quantidade) {
+                escreverTela(tela, "❌ atacar %d %d: território inválido (1 a %d)\n", comando->a, comando->b, quantidade);
+                resumo->recusados++;
+                ENCERRAR_MEDICAO(TEMPO_ATACAR_COMANDO, inicio);
+                break;
+            }
+            ResultadoAtaque validacao = validarAtaque(mapa, atacante, defensor);
+            if (validacao != ATAQUE_VALIDO) {
+                const char *motivo = "território sem fronteira";
+                if (validacao == ATAQUE_TROPAS_INSUFICIENTES) {
+                    motivo = "tropas insuficientes";
+                } else if (validacao == ATAQUE_MESMA_COR) {
+                    motivo = "mesma cor";
+                }
+                escreverTela(tela, "❌ atacar %d %d: %s\n", comando->a, comando->b, motivo);
+                resumo->recusados++;
+                ENCERRAR_MEDICAO(TEMPO_ATACAR_COMANDO, inicio);
+                break;
+            }
+            
+            guardarPassoDesfazer(partida->historico, mapa, partida->reforcos, partida->registro);
+            int dadoAtacante = rolarDado(&partida->gerador);
+            int dadoDefensor = rolarDado(&partida->gerador);
+            ResultadoAtaque resultado = resolverAtaque(mapa, atacante, defensor, dadoAtacante, dadoDefensor,
+                                                       &partida->objetivo);
+            registrarAtaque(partida->registro, atacante, defensor, dadoAtacante, dadoDefensor, resultado);
+            contarJogada(resultado);
+            resumo->ataques++;
+            
+            const char *desfecho = "o defensor resistiu";
+            if (resultado == ATAQUE_ATACANTE_VENCEU) {
+                desfecho = "o defensor perdeu 1 tropa";
+            } else if (resultado == ATAQUE_CONQUISTA) {
+                desfecho = "🏴 território conquistado";
+            } else if (resultado == ATAQUE_MISSAO_CUMPRIDA) {
+                desfecho = "🏴 território conquistado, 🎯 missão cumprida";
+            }
+            if (resultado == ATAQUE_CONQUISTA || resultado == ATAQUE_MISSAO_CUMPRIDA) {
+                resumo->conquistas++;
+            }
+            escreverTela(tela, "⚔️  atacar %d %d: 🎲 %d x %d, %s\n", comando->a, comando->b,
+                         dadoAtacante, dadoDefensor, desfecho);
+            ENCERRAR_MEDICAO(TEMPO_ATACAR_COMANDO, inicio);
+            break;
+        }
+            
+        case COMANDO_TROPAS: {
+            int territorio = comando->a - 1;
+            if (territorio < 0 || territorio >= quantidade) {
+                escreverTela(tela, "❌ tropas %d %d: território inválido (1 a %d)\n", comando->a, comando->b, quantidade);
+                resumo->recusados++;
+                break;
+            }
+            // Todo território mantém pelo menos 1 tropa
+            if ((long long) mapa->tropas[territorio] + comando->b < 1
+                || (long long) mapa->tropas[territorio] + comando->b > INT32_MAX) {
+                escreverTela(tela, "❌ tropas %d %d: o território ficaria com %lld tropas\n", comando->a, comando->b,
+                             (long long) mapa->tropas[territorio] + comando->b);
+                resumo->recusados++;
+                break;
+            }
+            guardarPassoDesfazer(partida->historico, mapa, partida->reforcos, partida->registro);
+            anotarEscrita(mapa, &mapa->tropas[territorio]);
+            mapa->tropas[territorio] += comando->b;
+            registrarTropas(partida->registro, territorio, comando->b);
+            escreverTela(tela, "🪖 tropas %d %d: %s agora tem %d tropas\n", comando->a, comando->b,
+                         nomeTerritorio(mapa, territorio), mapa->tropas[territorio]);
+            break;
+        }
+            
+        case COMANDO_REFORCAR: {
+            int territorio = comando->a - 1;
+            if (territorio < 0 || territorio >= quantidade) {
+                escreverTela(tela, "❌ reforcar %d %d: território inválido (1 a %d)\n", comando->a, comando->b,
+                             quantidade);
+                resumo->recusados++;
+                break;
+            }
+            if (mapa->cor[territorio] != partida->objetivo.corJogador) {
+                escreverTela(tela, "❌ reforcar %d %d: %s não é do seu exército\n", comando->a, comando->b,
+                             nomeTerritorio(mapa, territorio));
+                resumo->recusados++;
+                break;
+            }
+            if (comando->b < 1 || comando->b > partida->reforcos) {
+                escreverTela(tela, "❌ reforcar %d %d: restam %d tropas de reforço neste turno\n", comando->a,
+                             comando->b, partida->reforcos);
+                resumo->recusados++;
+                break;
+            }
+            guardarPassoDesfazer(partida->historico, mapa, partida->reforcos, partida->registro);
+            if (posicionarReforco(mapa, territorio, comando->b, partida->registro) != 0) {
+                // Nada mudou: o passo guardado é descartado
+                PassoDesfazer descartado;
+                desfazerPasso(partida->historico, mapa, &descartado);
+                escreverTela(tela, "❌ reforcar %d %d: %s não comporta mais tropas\n", comando->a, comando->b,
+                             nomeTerritorio(mapa, territorio));
+                resumo->recusados++;
+                break;
+            }
+            partida->reforcos -= comando->b;
+            escreverTela(tela, "🪖 reforcar %d %d: %s agora tem %d tropas (restam %d)\n", comando->a, comando->b,
+                         nomeTerritorio(mapa, territorio), mapa->tropas[territorio], partida->reforcos);
+            break;
+        }
+            
+        case COMANDO_MISSAO:
+            escreverTela(tela, "%s\n", verificarVitoria(mapa, &partida->objetivo)
+                         ? "🎉 missao: cumprida" : "🎯 missao: ainda não cumprida");
+            break;
+            
+        case COMANDO_TURNO: {
+            INICIAR_MEDICAO(inicio);
+            guardarPassoDesfazer(partida->historico, mapa, partida->reforcos, partida->registro);
+            if (partida->motorIA != NULL) {
+                // As jogadas do computador são impressas com printf
+                descarregarTela(tela);
+                jogarTurnosIA(partida->motorIA, mapa, partida->objetivo.corJogador, &partida->gerador,
+                              partida->registro);
+                fflush(stdout);
+            }
+            registrarFimTurno(partida->registro, mapa);
+            ENCERRAR_MEDICAO(TEMPO_TURNO, inicio);
+            // Reforços não posicionados se perdem; o próximo turno recebe os seus
+            partida->reforcos = calcularReforcos(mapa, partida->objetivo.corJogador);
+            escreverTela(tela, "⏭️  turno encerrado (%d tropas de reforço no próximo)\n", partida->reforcos);
+            break;
+        }
+            
+        case COMANDO_DESFAZER: {
+            PassoDesfazer passo;
+            if (partida->historico == NULL) {
+                escreverTela(tela, "❌ desfazer: esta partida não guarda histórico\n");
+                resumo->recusados++;
+                break;
+            }
+            if (desfazerPasso(partida->historico, mapa, &passo) != 0) {
+                escreverTela(tela, "❌ desfazer: nada a desfazer\n");
+                resumo->recusados++;
+                break;
+            }
+            partida->reforcos = passo.reforcos;
+            registrarRestauracao(partida->registro, mapa, passo.turno);
+            escreverTela(tela, "↩️  desfazer: mapa restaurado (mais %d comando(s) podem ser desfeitos)\n",
+                         partida->historico->quantidade);
+            break;
+        }
+            
+        case COMANDO_MAPA:
+            exibirMapa(tela, mapa);
+            break;
+            
+        case COMANDO_METRICAS: {
+#ifdef WAR_METRICAS
+            Metricas metricas;
+            capturarMetricas(&metricas);
+            exportarMetricasTexto(tela, &metricas);
+#else
+            escreverTela(tela, "❌ metricas: executável compilado sem métricas (use: make METRICAS=1)\n");
+#endif
+            break;
+        }
+            
+        case COMANDO_SAIR:
+            resumo->comandos++;
+            return 0;
+            
+        case COMANDO_INVALIDO:
+            break;
+    }
+    resumo->comandos++;
+    return 1;
+}
+
+/**
+ * executarArquivoComandos()
+ * Modo não interativo: executa todos os comandos de um arquivo ou pipe
+ * sobre a partida e mostra um resumo com a vazão alcançada.
+ * A saída de cada comando é acumulada na tela e enviada em blocos.
+ * Parâmetros:
+ *   - partida: partida em andamento
+ *   - caminho: arquivo de comandos ("-" para a entrada padrão)
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 se o arquivo não pôde ser lido
+ */
+int executarArquivoComandos(Partida *partida, const char *caminho) {
+    LeitorComandos *leitor = abrirComandos(caminho);
+    if (leitor == NULL) {
+        return 1;
+    }
+    
+    ResumoComandos resumo;
+    memset(&resumo, 0, sizeof(resumo));
+    Tela *tela = partida->tela;
+    
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    
+    char *linha;
+    int status;
+    while ((status = proximaLinha(leitor, &linha)) > 0) {
+        Comando comando;
+        if (interpretarComando(linha, &comando) == COMANDO_INVALIDO) {
+            if (resumo.invalidos++ == 0) {
+                resumo.primeiraLinhaInvalida = leitor->linha;
+            }
+            escreverTela(tela, "❌ linha %lld: comando desconhecido: %.60s\n", leitor->linha, linha);
+            continue;
+        }
+        if (!executarComando(partida, &comando, &resumo)) {
+            break;
+        }
+        if (tela->usado >= TAM_BUFFER_COMANDOS) {
+            descarregarTela(tela);
+        }
+    }
+    descarregarTela(tela);
+    
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    
+    if (status < 0) {
+        printf("❌ Erro de leitura no arquivo de comandos %s (linha %lld)\n", caminho, leitor->linha);
+    }
+    printf("\n✓ %lld comandos em %.2f ms (%.0f comandos/s): %lld ataques, %lld conquistas, %lld recusados\n",
+           resumo.comandos, segundos * 1e3, segundos > 0 ? resumo.comandos / segundos : 0.0,
+           resumo.ataques, resumo.conquistas, resumo.recusados);
+    if (resumo.invalidos > 0) {
+        printf("⚠️  %lld linhas inválidas (a primeira é a linha %lld)\n", resumo.invalidos, resumo.primeiraLinhaInvalida);
+    }
+    if (verificarVitoria(partida->mapa, &partida->objetivo)) {
+        printf("🎉 Missão cumprida pelo exército %s!\n", nomeCor(partida->mapa, partida->objetivo.corJogador));
+    }
+    
+    fecharComandos(leitor);
+    return status < 0;
+}
+
+/**
+ * criarGerenciador()
+ * Prepara o gerenciador de sessões: o arena de mapas, o pool de threads
+ * e o vetor de sessões (todas inativas).
+ * Parâmetros:
+ *   - modelo: mapa de onde todas as partidas partem
+ *   - maxSessoes: maior id de sessão aceito
+ *   - numThreads: trabalhadores do pool
+ *   - semente: semente base das partidas
+ *   - silenciosa: 1 para não mostrar o resultado de cada comando
+ * Retorna:
+ *   - Ponteiro para o gerenciador, ou NULL em caso de erro
+ */
+GerenciadorSessoes* criarGerenciador(const Mapa *modelo, int maxSessoes, int numThreads, uint64_t semente,
+                                     int silenciosa) {
+    GerenciadorSessoes *gerenciador = (GerenciadorSessoes*) calloc(1, sizeof(GerenciadorSessoes));
+    if (gerenciador == NULL) {
+        return NULL;
+    }
+    int numFaixas = (maxSessoes + SESSOES_POR_TAREFA - 1) / SESSOES_POR_TAREFA;
+    gerenciador->modelo = modelo;
+    gerenciador->maxSessoes = maxSessoes;
+    gerenciador->semente = semente;
+    gerenciador->silenciosa = silenciosa;
+    gerenciador->sessoes = (Sessao*) calloc((size_t) maxSessoes, sizeof(Sessao));
+    gerenciador->faixas = (FaixaSessoes*) calloc((size_t) numFaixas, sizeof(FaixaSessoes));
+    gerenciador->arena = criarArena(modelo);
+    gerenciador->pool = criarPool(numThreads);
+    gerenciador->saida = criarTela(silenciosa);
+    
+    if (gerenciador->sessoes == NULL || gerenciador->faixas == NULL || gerenciador->arena == NULL
+        || gerenciador->pool == NULL || gerenciador->saida == NULL) {
+        destruirGerenciador(gerenciador);
+        return NULL;
+    }
+    // As saídas das sessões se intercalam: o mapa nunca fica fixo no terminal
+    gerenciador->saida->linhasTerminal = 0;
+    for (int i = 0; i < maxSessoes; i++) {
+        gerenciador->sessoes[i].id = i + 1;
+    }
+    return gerenciador;
+}
+
+/**
+ * abrirSessao()
+ * Começa uma partida nova na sessão indicada: clona o mapa modelo no
+ * arena e sorteia a missão, como no início do jogo interativo.
+ * Parâmetros:
+ *   - gerenciador: gerenciador de sessões
+ *   - id: sessão a abrir (1 a maxSessoes, ainda inativa)
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro
+ */
+int abrirSessao(GerenciadorSessoes *gerenciador, int id) {
+    Sessao *sessao = &gerenciador->sessoes[id - 1];
+    Mapa *mapa = clonarMapaNaArena(gerenciador->arena, gerenciador->modelo);
+    Tela *tela = criarTela(gerenciador->silenciosa);
+    if (mapa == NULL || tela == NULL) {
+        liberarMemoria(mapa);
+        liberarTela(tela);
+        return 1;
+    }
+    tela->linhasTerminal = 0;
+    
+    // A semente depende da ordem de abertura: a mesma entrada repete as mesmas partidas.
+    // As sessões não guardam histórico (desfazer), para que cada uma continue
+    // ocupando só a sua fatia do arena.
+    Partida *partida = &sessao->partida;
+    memset(partida, 0, sizeof(Partida));
+    partida->mapa = mapa;
+    partida->tela = tela;
+    semearGerador(&partida->gerador, gerenciador->semente + (uint64_t) gerenciador->sessoesAbertas);
+    
+    IdCor corJogador = buscarCor(mapa, "Azul");
+    if (corJogador == COR_INVALIDA) {
+        corJogador = 0;
+    }
+    int missao = sortearMissao(mapa, &partida->gerador);
+    partida->objetivo = prepararObjetivo(mapa, missao, corJogador);
+    partida->reforcos = calcularReforcos(mapa, corJogador);
+    
+    memset(&sessao->resumo, 0, sizeof(ResumoComandos));
+    sessao->numPendentes = 0;
+    sessao->ativa = 1;
+    gerenciador->ativas++;
+    gerenciador->sessoesAbertas++;
+    escreverTela(tela, "[%d] 🎮 nova sessão: exército %s, missão %d\n", id, nomeCor(mapa, corJogador), missao);
+    return 0;
+}
+
+// Passa a saída acumulada de uma sessão para a saída do gerenciador.
+static void recolherSaida(GerenciadorSessoes *gerenciador, Sessao *sessao) {
+    Tela *tela = sessao->partida.tela;
+    if (tela->usado > 0) {
+        escreverTela(gerenciador->saida, "%.*s", (int) tela->usado, tela->buffer);
+        tela->usado = 0;
+    }
+}
+
+/**
+ * fecharSessao()
+ * Encerra a partida de uma sessão e devolve o seu mapa ao arena. Os
+ * comandos pendentes da sessão devem ter sido executados antes.
+ * Parâmetros:
+ *   - gerenciador: gerenciador de sessões
+ *   - id: sessão a fechar (ativa)
+ */
+void fecharSessao(GerenciadorSessoes *gerenciador, int id) {
+    Sessao *sessao = &gerenciador->sessoes[id - 1];
+    Partida *partida = &sessao->partida;
+    recolherSaida(gerenciador, sessao);
+    escreverTela(gerenciador->saida, "[%d] 🏁 sessão encerrada: %lld comandos, %lld ataques, missão %s\n", id,
+                 sessao->resumo.comandos, sessao->resumo.ataques,
+                 verificarVitoria(partida->mapa, &partida->objetivo) ? "cumprida" : "não cumprida");
+    
+    ResumoComandos *total = &gerenciador->total;
+    total->comandos += sessao->resumo.comandos;
+    total->ataques += sessao->resumo.ataques;
+    total->conquistas += sessao->resumo.conquistas;
+    total->recusados += sessao->resumo.recusados;
+    
+    liberarTela(partida->tela);
+    liberarMemoria(partida->mapa);
+    partida->tela = NULL;
+    partida->mapa = NULL;
+    sessao->ativa = 0;
+    gerenciador->ativas--;
+}
+
+/**
+ * executarFaixaSessoes()
+ * Tarefa do pool: executa em ordem os comandos pendentes de cada sessão da
+ * faixa. Cada sessão pertence a uma única faixa, então não há travas.
+ */
+static void executarFaixaSessoes(void *argumento, int trabalhador) {
+    (void) trabalhador;
+    FaixaSessoes *faixa = (FaixaSessoes*) argumento;
+    for (int i = faixa->inicio; i < faixa->fim; i++) {
+        Sessao *sessao = &faixa->gerenciador->sessoes[i];
+        for (int k = 0; k < sessao->numPendentes; k++) {
+            // O mapa ocupa várias linhas: o id da sessão vai em uma linha própria
+            escreverTela(sessao->partida.tela, sessao->pendentes[k].tipo == COMANDO_MAPA ? "[%d] 🗺️  mapa:\n" : "[%d] ",
+                         sessao->id);
+            executarComando(&sessao->partida, &sessao->pendentes[k], &sessao->resumo);
+        }
+        sessao->numPendentes = 0;
+    }
+}
+
+/**
+ * executarLoteSessoes()
+ * Executa no pool os comandos acumulados de todas as sessões, uma tarefa
+ * por faixa de SESSOES_POR_TAREFA sessões, e envia a saída do lote em
+ * ordem de sessão com uma única escrita.
+ * Parâmetros:
+ *   - gerenciador: gerenciador de sessões
+ */
+void executarLoteSessoes(GerenciadorSessoes *gerenciador) {
+    int numFaixas = 0;
+    for (int inicio = 0; inicio < gerenciador->maxSessoes && gerenciador->pendentes > 0;
+         inicio += SESSOES_POR_TAREFA) {
+        int fim = inicio + SESSOES_POR_TAREFA < gerenciador->maxSessoes ? inicio + SESSOES_POR_TAREFA
+                                                                        : gerenciador->maxSessoes;
+        int temComandos = 0;
+        for (int i = inicio; i < fim && !temComandos; i++) {
+            temComandos = gerenciador->sessoes[i].numPendentes > 0;
+        }
+        if (!temComandos) {
+            continue;
+        }
+        FaixaSessoes *faixa = &gerenciador->faixas[numFaixas++];
+        faixa->gerenciador = gerenciador;
+        faixa->inicio = inicio;
+        faixa->fim = fim;
+        if (enviarTarefa(gerenciador->pool, executarFaixaSessoes, faixa) != 0) {
+            executarFaixaSessoes(faixa, 0);
+        }
+    }
+    aguardarPool(gerenciador->pool);
+    
+    for (int i = 0; i < gerenciador->maxSessoes; i++) {
+        if (gerenciador->sessoes[i].ativa) {
+            recolherSaida(gerenciador, &gerenciador->sessoes[i]);
+        }
+    }
+    descarregarTela(gerenciador->saida);
+    if (gerenciador->pendentes > 0) {
+        gerenciador->lotes++;
+    }
+    gerenciador->pendentes = 0;
+}
+
+/**
+ * destruirGerenciador()
+ * Libera as sessões ainda abertas (sem executar o que estiver pendente),
+ * o pool e o arena.
+ * Parâmetros:
+ *   - gerenciador: gerenciador de sessões (pode ser NULL)
+ */
+void destruirGerenciador(GerenciadorSessoes *gerenciador) {
+    if (gerenciador == NULL) {
+        return;
+    }
+    if (gerenciador->sessoes != NULL) {
+        for (int i = 0; i < gerenciador->maxSessoes; i++) {
+            Sessao *sessao = &gerenciador->sessoes[i];
+            if (sessao->ativa) {
+                liberarTela(sessao->partida.tela);
+                liberarMemoria(sessao->partida.mapa);
+            }
+            free(sessao->pendentes);
+        }
+    }
+    destruirPool(gerenciador->pool);
+    destruirArena(gerenciador->arena);
+    liberarTela(gerenciador->saida);
+    free(gerenciador->sessoes);
+    free(gerenciador->faixas);
+    free(gerenciador);
+}
+
+// Acrescenta um comando à fila da sessão para o próximo lote.
+static int enfileirarComando(Sessao *sessao, const Comando *comando) {
+    if (sessao->numPendentes == sessao->capacidadePendentes) {
+        int capacidade = sessao->capacidadePendentes ? sessao->capacidadePendentes * 2 : 16;
+        Comando *pendentes = (Comando*) realloc(sessao->pendentes, (size_t) capacidade * sizeof(Comando));
+        if (pendentes == NULL) {
+            return 1;
+        }
+        sessao->pendentes = pendentes;
+        sessao->capacidadePendentes = capacidade;
+    }
+    sessao->pendentes[sessao->numPendentes++] = *comando;
+    return 0;
+}
+
+/**
+ * executarSessoes()
+ * Modo multissessão: cada linha da entrada é "SESSAO COMANDO", com os
+ * comandos do modo de comandos e mais "nova" para abrir a sessão ("sair"
+ * a encerra). As linhas de várias sessões podem vir intercaladas, como de
+ * vários clientes em uma mesma conexão; os comandos de uma sessão são
+ * executados na ordem em que chegaram, e sessões diferentes em paralelo.
+ * Parâmetros:
+ *   - modelo: mapa de onde todas as partidas partem
+ *   - caminho: arquivo de comandos ("-" para a entrada padrão)
+ *   - maxSessoes: maior id de sessão aceito
+ *   - numThreads: trabalhadores do pool
+ *   - semente: semente base das partidas
+ *   - silenciosa: 1 para mostrar só o resumo
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro
+ */
+int executarSessoes(const Mapa *modelo, const char *caminho, int maxSessoes, int numThreads, uint64_t semente,
+                    int silenciosa) {
+    GerenciadorSessoes *gerenciador = criarGerenciador(modelo, maxSessoes, numThreads, semente, silenciosa);
+    if (gerenciador == NULL) {
+        printf("❌ Erro ao preparar %d sessões!\n", maxSessoes);
+        return 1;
+    }
+    LeitorComandos *leitor = abrirComandos(caminho);
+    if (leitor == NULL) {
+        destruirGerenciador(gerenciador);
+        return 1;
+    }
+    
+    Tela *saida = gerenciador->saida;
+    ResumoComandos *total = &gerenciador->total;
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
     
-    return 0;  // Missão desconhecida ou não cumprida
+    char *linha;
+    int status;
+    while ((status = proximaLinha(leitor, &linha)) > 0) {
+        const char *cursor = pularEspacos(linha);
+        if (*cursor == '\0' || *cursor == '#') {
+            continue;
+        }
+        
+        int id;
+        cursor = lerInteiro(cursor, &id);
+        Comando comando;
+        const char *erro = NULL;
+        if (cursor == NULL || id < 1 || id > maxSessoes) {
+            erro = "sessão inválida";
+        } else {
+            cursor = pularEspacos(cursor);
+            Sessao *sessao = &gerenciador->sessoes[id - 1];
+            int nova = 0;
+            if (strncmp(cursor, "nova", 4) == 0) {
+                const char *resto = pularEspacos(cursor + 4);
+                nova = (*resto == '\0' || *resto == '#');
+            }
+            if (nova) {
+                if (sessao->ativa) {
+                    erro = "a sessão já está aberta";
+                } else if (abrirSessao(gerenciador, id) != 0) {
+                    erro = "sem memória para a sessão";
+                }
+            } else if (interpretarComando(cursor, &comando) == COMANDO_INVALIDO || comando.tipo == COMANDO_VAZIO) {
+                erro = "comando desconhecido";
+            } else if (!sessao->ativa) {
+                erro = "a sessão não foi aberta (use \"N nova\")";
+            } else if (comando.tipo == COMANDO_SAIR) {
+                if (sessao->numPendentes > 0) {
+                    executarLoteSessoes(gerenciador);
+                }
+                sessao->resumo.comandos++;
+                fecharSessao(gerenciador, id);
+            } else if (enfileirarComando(sessao, &comando) != 0) {
+                erro = "sem memória para a fila da sessão";
+            } else if (++gerenciador->pendentes >= COMANDOS_POR_LOTE_SESSOES) {
+                executarLoteSessoes(gerenciador);
+            }
+        }
+        
+        if (erro != NULL) {
+            // A saída das linhas anteriores vem antes do aviso
+            executarLoteSessoes(gerenciador);
+            if (total->invalidos++ == 0) {
+                total->primeiraLinhaInvalida = leitor->linha;
+            }
+            escreverTela(saida, "❌ linha %lld: %s: %.60s\n", leitor->linha, erro, linha);
+        }
+    }
+    
+    // Executa o último lote e encerra as sessões que ficaram abertas
+    executarLoteSessoes(gerenciador);
+    for (int i = 0; i < maxSessoes; i++) {
+        if (gerenciador->sessoes[i].ativa) {
+            fecharSessao(gerenciador, i + 1);
+        }
+    }
+    descarregarTela(saida);
+    
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    double segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    
+    if (status < 0) {
+        printf("❌ Erro de leitura no arquivo de comandos %s (linha %lld)\n", caminho, leitor->linha);
+    }
+    printf("\n✓ %lld comandos em %lld sessões (%lld lotes, %d threads) em %.2f ms (%.0f comandos/s)\n",
+           total->comandos, gerenciador->sessoesAbertas, gerenciador->lotes, gerenciador->pool->numTrabalhadores,
+           segundos * 1e3, segundos > 0 ? total->comandos / segundos : 0.0);
+    printf("   %lld ataques, %lld conquistas, %lld recusados; arena: %d blocos de %d mapas (%zu bytes por mapa)\n",
+           total->ataques, total->conquistas, total->recusados, gerenciador->arena->numBlocos,
+           FATIAS_POR_BLOCO_ARENA, gerenciador->arena->tamanhoFatia);
+    if (total->invalidos > 0) {
+        printf("⚠️  %lld linhas inválidas (a primeira é a linha %lld)\n", total->invalidos, total->primeiraLinhaInvalida);
+    }
+    
+    fecharComandos(leitor);
+    destruirGerenciador(gerenciador);
+    return status < 0;
+}
+
+#ifdef WAR_METRICAS
+// Nomes dos contadores e trechos, na ordem dos enums (texto e chave JSON).
+static const char *NOMES_CONTADORES[NUM_CONTADORES][2] = {
+    { "Ataques tentados",                "ataques_tentados" },
+    { "Recusados: tropas insuficientes", "recusados_tropas" },
+    { "Recusados: mesma cor",            "recusados_mesma_cor" },
+    { "Recusados: sem fronteira",        "recusados_nao_adjacente" },
+    { "Conquistas",                      "conquistas" },
+    { "Dados lançados",                  "dados_rolados" },
+    { "Conquistas simuladas",            "conquistas_simuladas" },
+    { "Dados simulados",                 "dados_simulados" }
+};
+static const char *NOMES_TEMPORIZADORES[NUM_TEMPORIZADORES][2] = {
+    { "faseDeAtaque()",     "fase_de_ataque" },
+    { "simularAtaque()",    "simular_ataque" },
+    { "comando atacar",     "atacar_comando" },
+    { "verificarVitoria()", "verificar_vitoria" },
+    { "exibirMapa()",       "exibir_mapa" },
+    { "turno",              "turno" }
+};
+
+// Métricas de todas as threads que já mediram algo. Os blocos vivem até o
+// fim do processo, para que o retrato inclua threads que já terminaram.
+static MetricasThread *listaMetricas = NULL;
+static pthread_mutex_t travaMetricas = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local MetricasThread *metricasDaThread = NULL;
+
+/**
+ * metricasLocais()
+ * Bloco de métricas da thread atual, criado e registrado na primeira medição.
+ * Retorna:
+ *   - Ponteiro para o bloco, ou NULL se faltou memória (a medição é perdida)
+ */
+static MetricasThread* metricasLocais(void) {
+    MetricasThread *metricas = metricasDaThread;
+    if (metricas != NULL) {
+        return metricas;
+    }
+    
+    metricas = (MetricasThread*) calloc(1, sizeof(MetricasThread));
+    if (metricas == NULL) {
+        return NULL;
+    }
+    for (int t = 0; t < NUM_TEMPORIZADORES; t++) {
+        atomic_init(&metricas->tempos[t].minimoNs, UINT64_MAX);
+    }
+    pthread_mutex_lock(&travaMetricas);
+    metricas->proxima = listaMetricas;
+    listaMetricas = metricas;
+    pthread_mutex_unlock(&travaMetricas);
+    metricasDaThread = metricas;
+    return metricas;
+}
+
+// Soma em um campo escrito só pela própria thread: carga e gravação relaxadas,
+// sem a trava de barramento de um atomic_fetch_add.
+static inline void acumular(_Atomic uint64_t *campo, uint64_t valor) {
+    atomic_store_explicit(campo, atomic_load_explicit(campo, memory_order_relaxed) + valor, memory_order_relaxed);
+}
+
+/**
+ * instanteMetricas()
+ * Relógio monotônico usado pelas medições.
+ * Retorna:
+ *   - Instante atual em nanossegundos
+ */
+uint64_t instanteMetricas(void) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (uint64_t) agora.tv_sec * 1000000000u + (uint64_t) agora.tv_nsec;
+}
+
+/**
+ * somarContador()
+ * Acrescenta uma quantidade a um contador da thread atual.
+ * Parâmetros:
+ *   - contador: contador a incrementar
+ *   - quantidade: valor a somar
+ */
+void somarContador(Contador contador, uint64_t quantidade) {
+    MetricasThread *metricas = metricasLocais();
+    if (metricas != NULL) {
+        acumular(&metricas->contadores[contador], quantidade);
+    }
+}
+
+/**
+ * registrarTempo()
+ * Anota uma duração no histograma de um trecho, na thread atual.
+ * Parâmetros:
+ *   - temporizador: trecho medido
+ *   - nanossegundos: duração da execução
+ */
+void registrarTempo(Temporizador temporizador, uint64_t nanossegundos) {
+    MetricasThread *metricas = metricasLocais();
+    if (metricas == NULL) {
+        return;
+    }
+    HistogramaThread *histograma = &metricas->tempos[temporizador];
+    
+    int balde = nanossegundos > 0 ? 63 - __builtin_clzll(nanossegundos) : 0;
+    if (balde >= BALDES_HISTOGRAMA) {
+        balde = BALDES_HISTOGRAMA - 1;
+    }
+    acumular(&histograma->baldes[balde], 1);
+    acumular(&histograma->amostras, 1);
+    acumular(&histograma->totalNs, nanossegundos);
+    if (nanossegundos < atomic_load_explicit(&histograma->minimoNs, memory_order_relaxed)) {
+        atomic_store_explicit(&histograma->minimoNs, nanossegundos, memory_order_relaxed);
+    }
+    if (nanossegundos > atomic_load_explicit(&histograma->maximoNs, memory_order_relaxed)) {
+        atomic_store_explicit(&histograma->maximoNs, nanossegundos, memory_order_relaxed);
+    }
+}
+
+/**
+ * capturarMetricas()
+ * Soma as métricas de todas as threads em um retrato. Pode ser chamada a
+ * qualquer momento, inclusive com outras threads medindo.
+ * Parâmetros:
+ *   - metricas: recebe o retrato
+ */
+void capturarMetricas(Metricas *metricas) {
+    memset(metricas, 0, sizeof(Metricas));
+    for (int t = 0; t < NUM_TEMPORIZADORES; t++) {
+        metricas->tempos[t].minimoNs = UINT64_MAX;
+    }
+    
+    pthread_mutex_lock(&travaMetricas);
+    for (MetricasThread *thread = listaMetricas; thread != NULL; thread = thread->proxima) {
+        for (int c = 0; c < NUM_CONTADORES; c++) {
+            metricas->contadores[c] += atomic_load_explicit(&thread->contadores[c], memory_order_relaxed);
+        }
+        for (int t = 0; t < NUM_TEMPORIZADORES; t++) {
+            const HistogramaThread *origem = &thread->tempos[t];
+            Histograma *destino = &metricas->tempos[t];
+            destino->amostras += atomic_load_explicit(&origem->amostras, memory_order_relaxed);
+            destino->totalNs += atomic_load_explicit(&origem->totalNs, memory_order_relaxed);
+            uint64_t minimo = atomic_load_explicit(&origem->minimoNs, memory_order_relaxed);
+            uint64_t maximo = atomic_load_explicit(&origem->maximoNs, memory_order_relaxed);
+            if (minimo < destino->minimoNs) {
+                destino->minimoNs = minimo;
+            }
+            if (maximo > destino->maximoNs) {
+                destino->maximoNs = maximo;
+            }
+            for (int b = 0; b < BALDES_HISTOGRAMA; b++) {
+                destino->baldes[b] += atomic_load_explicit(&origem->baldes[b], memory_order_relaxed);
+            }
+        }
+    }
+    pthread_mutex_unlock(&travaMetricas);
+    
+    for (int t = 0; t < NUM_TEMPORIZADORES; t++) {
+        if (metricas->tempos[t].amostras == 0) {
+            metricas->tempos[t].minimoNs = 0;
+        }
+    }
+}
+
+/**
+ * percentilHistograma()
+ * Estima um percentil pelo limite superior do balde em que ele cai
+ * (no máximo o maior valor observado).
+ * Parâmetros:
+ *   - histograma: histograma somado
+ *   - fracao: percentil desejado, de 0 a 1
+ * Retorna:
+ *   - Duração estimada em nanossegundos (0 se não há amostras)
+ */
+static uint64_t percentilHistograma(const Histograma *histograma, double fracao) {
+    if (histograma->amostras == 0) {
+        return 0;
+    }
+    // Posição da amostra do percentil, arredondada para cima (a partir de 1)
+    double posicao = fracao * (double) histograma->amostras;
+    uint64_t alvo = (uint64_t) posicao;
+    if (alvo < posicao || alvo == 0) {
+        alvo++;
+    }
+    uint64_t acumulado = 0;
+    for (int b = 0; b < BALDES_HISTOGRAMA; b++) {
+        acumulado += histograma->baldes[b];
+        if (acumulado >= alvo) {
+            uint64_t limite = (b == BALDES_HISTOGRAMA - 1) ? UINT64_MAX : (UINT64_C(2) << b) - 1;
+            return limite < histograma->maximoNs ? limite : histograma->maximoNs;
+        }
+    }
+    return histograma->maximoNs;
+}
+
+/**
+ * formatarDuracao()
+ * Escreve uma duração em nanossegundos na unidade mais legível.
+ */
+static void formatarDuracao(char *texto, size_t tamanho, double nanossegundos) {
+    if (nanossegundos < 1e3) {
+        snprintf(texto, tamanho, "%.0f ns", nanossegundos);
+    } else if (nanossegundos < 1e6) {
+        snprintf(texto, tamanho, "%.1f µs", nanossegundos / 1e3);
+    } else if (nanossegundos < 1e9) {
+        snprintf(texto, tamanho, "%.1f ms", nanossegundos / 1e6);
+    } else {
+        snprintf(texto, tamanho, "%.2f s", nanossegundos / 1e9);
+    }
+}
+
+/**
+ * exportarMetricasTexto()
+ * Escreve um retrato das métricas em texto: contadores, um resumo por
+ * trecho e os baldes não vazios de cada histograma.
+ * Parâmetros:
+ *   - tela: saída do texto
+ *   - metricas: retrato de capturarMetricas()
+ */
+void exportarMetricasTexto(Tela *tela, const Metricas *metricas) {
+    enum { LARGURA_BARRA = 40 };
+    char media[32], p50[32], p99[32], maximo[32], inicio[32];
+    
+    escreverTela(tela, "📊 Métricas de desempenho\n");
+    for (int c = 0; c < NUM_CONTADORES; c++) {
+        escreverTela(tela, "   %-33s %12" PRIu64 "\n", NOMES_CONTADORES[c][0], metricas->contadores[c]);
+    }
+    
+    escreverTela(tela, "\n   %-20s %10s %10s %10s %10s %10s\n", "Trecho", "amostras", "média", "p50", "p99", "máximo");
+    for (int t = 0; t < NUM_TEMPORIZADORES; t++) {
+        const Histograma *histograma = &metricas->tempos[t];
+        uint64_t amostras = histograma->amostras;
+        formatarDuracao(media, sizeof(media), amostras ? (double) histograma->totalNs / (double) amostras : 0.0);
+        formatarDuracao(p50, sizeof(p50), (double) percentilHistograma(histograma, 0.50));
+        formatarDuracao(p99, sizeof(p99), (double) percentilHistograma(histograma, 0.99));
+        formatarDuracao(maximo, sizeof(maximo), (double) histograma->maximoNs);
+        // "µs" ocupa um byte a mais do que aparece na tela
+        escreverTela(tela, "   %-20s %10" PRIu64 " %*s %*s %*s %*s\n", NOMES_TEMPORIZADORES[t][0], amostras,
+                     10 + (strstr(media, "µ") != NULL), media, 10 + (strstr(p50, "µ") != NULL), p50,
+                     10 + (strstr(p99, "µ") != NULL), p99, 10 + (strstr(maximo, "µ") != NULL), maximo);
+    }
+    
+    for (int t = 0; t < NUM_TEMPORIZADORES; t++) {
+        const Histograma *histograma = &metricas->tempos[t];
+        if (histograma->amostras == 0) {
+            continue;
+        }
+        uint64_t maiorBalde = 0;
+        for (int b = 0; b < BALDES_HISTOGRAMA; b++) {
+            if (histograma->baldes[b] > maiorBalde) {
+                maiorBalde = histograma->baldes[b];
+            }
+        }
+        escreverTela(tela, "\n   %s\n", NOMES_TEMPORIZADORES[t][0]);
+        for (int b = 0; b < BALDES_HISTOGRAMA; b++) {
+            if (histograma->baldes[b] == 0) {
+                continue;
+            }
+            formatarDuracao(inicio, sizeof(inicio), b == 0 ? 0.0 : (double) (UINT64_C(1) << b));
+            escreverTela(tela, "   ≥ %*s │", 9 + (strstr(inicio, "µ") != NULL), inicio);
+            int barra = (int) ((histograma->baldes[b] * LARGURA_BARRA + maiorBalde - 1) / maiorBalde);
+            for (int i = 0; i < barra; i++) {
+                escreverTela(tela, "█");
+            }
+            escreverTela(tela, " %" PRIu64 "\n", histograma->baldes[b]);
+        }
+    }
+}
+
+/**
+ * exportarMetricasJson()
+ * Escreve um retrato das métricas em JSON. Os baldes vão em ordem; o balde
+ * i conta as durações de 2^i a 2^(i+1) - 1 nanossegundos.
+ * Parâmetros:
+ *   - tela: saída do texto
+ *   - metricas: retrato de capturarMetricas()
+ */
+void exportarMetricasJson(Tela *tela, const Metricas *metricas) {
+    escreverTela(tela, "{\n  \"contadores\": {\n");
+    for (int c = 0; c < NUM_CONTADORES; c++) {
+        escreverTela(tela, "    \"%s\": %" PRIu64 "%s\n", NOMES_CONTADORES[c][1], metricas->contadores[c],
+                     c + 1 < NUM_CONTADORES ? "," : "");
+    }
+    escreverTela(tela, "  },\n  \"tempos\": {\n");
+    for (int t = 0; t < NUM_TEMPORIZADORES; t++) {
+        const Histograma *histograma = &metricas->tempos[t];
+        escreverTela(tela, "    \"%s\": {\"amostras\": %" PRIu64 ", \"total_ns\": %" PRIu64 ", \"minimo_ns\": %" PRIu64
+                     ", \"maximo_ns\": %" PRIu64 ", \"p50_ns\": %" PRIu64 ", \"p99_ns\": %" PRIu64 ", \"baldes\": [",
+                     NOMES_TEMPORIZADORES[t][1], histograma->amostras, histograma->totalNs, histograma->minimoNs,
+                     histograma->maximoNs, percentilHistograma(histograma, 0.50),
+                     percentilHistograma(histograma, 0.99));
+        for (int b = 0; b < BALDES_HISTOGRAMA; b++) {
+            escreverTela(tela, "%s%" PRIu64, b > 0 ? ", " : "", histograma->baldes[b]);
+        }
+        escreverTela(tela, "]}%s\n", t + 1 < NUM_TEMPORIZADORES ? "," : "");
+    }
+    escreverTela(tela, "  }\n}\n");
+}
+
+/**
+ * salvarMetricas()
+ * Captura as métricas e as grava em um arquivo: JSON se o nome terminar
+ * em ".json", texto caso contrário; "-" escreve o texto na saída padrão.
+ * Parâmetros:
+ *   - caminho: arquivo de destino ou "-"
+ * Retorna:
+ *   - 0 em caso de sucesso, 1 em caso de erro
+ */
+int salvarMetricas(const char *caminho) {
+    Metricas metricas;
+    capturarMetricas(&metricas);
+    
+    Tela *tela = criarTela(0);
+    if (tela == NULL) {
+        printf("❌ Erro ao alocar memória para as métricas!\n");
+        return 1;
+    }
+    size_t tamanhoCaminho = strlen(caminho);
+    if (tamanhoCaminho > 5 && strcmp(caminho + tamanhoCaminho - 5, ".json") == 0) {
+        exportarMetricasJson(tela, &metricas);
+    } else {
+        exportarMetricasTexto(tela, &metricas);
+    }
+    
+    int status = 0;
+    if (strcmp(caminho, "-") == 0) {
+        descarregarTela(tela);
+    } else {
+        FILE *arquivo = fopen(caminho, "w");
+        if (arquivo == NULL || fwrite(tela->buffer, 1, tela->usado, arquivo) != tela->usado) {
+            status = 1;
+        }
+        if (arquivo != NULL && fclose(arquivo) != 0) {
+            status = 1;
+        }
+        if (status != 0) {
+            printf("❌ Erro ao gravar as métricas em %s: %s\n", caminho, strerror(errno));
+        }
+    }
+    liberarTela(tela);
+    return status;
 }
+#endif // WAR_METRICAS
 
 /**
  * limparBufferEntrada()
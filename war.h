@@ -0,0 +1,763 @@
+// ============================================================================
+//         PROJETO WAR ESTRUTURADO - DESAFIO DE CÓDIGO
+//         Constantes, estruturas de dados e protótipos compartilhados
+// ============================================================================
+//
+// Incluído por war.c (o jogo) e por bench.c (os benchmarks), que é compilado
+// com war.c e -DWAR_SEM_MAIN.
+//
+// ============================================================================
+
+#ifndef WAR_H
+#define WAR_H
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <locale.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#ifdef WAR_METRICAS
+#include <stdatomic.h>
+#endif
+
+// --- Constantes Globais ---
+#define NUM_TERRITORIOS 5
+#define MAX_CORES 64
+#define MAX_TERRITORIOS (1 << 26)
+#define MAX_FRONTEIRAS (1 << 28)
+#define COR_INVALIDA 0xFF
+#define MAX_MISSOES 64
+#define MAX_TURNOS_SIMULACAO 1000
+#define MAX_THREADS 256
+#define TAM_RESERVA_DADOS 256
+#define MAX_SUGESTOES_ATAQUE 10
+#define MAX_RODADAS_BATALHA 64
+#define RODADAS_PREVISAO 10
+#define ORCAMENTO_IA_MS 20
+#define REFORCO_MINIMO 3            // Tropas de reforço de quem ainda tem algum território
+#define TERRITORIOS_POR_REFORCO 2   // Uma tropa de reforço a cada 2 territórios
+#define MAX_CANDIDATOS_IA 16
+#define SIMULACOES_POR_ETAPA_IA 512
+#define TAM_LOTE_IA 16
+#define PROFUNDIDADE_IA 2
+#define ASSINATURA_MAPA "WARMAPA"
+#define VERSAO_MAPA 2                // A versão 1 (sem regiões) continua sendo lida
+#define ASSINATURA_REGISTRO "WARLOG"
+#define VERSAO_REGISTRO 2            // A versão 1 (sem restaurações) continua sendo lida
+#define TAM_BUFFER_REGISTRO (1 << 16)
+#define EVENTOS_POR_CHECKPOINT 4096
+#define LINHAS_ANTES_DA_TABELA 7    // Título (3), linha em branco e cabeçalho da tabela (3)
+#define LINHAS_MOLDURA_MAPA 8       // LINHAS_ANTES_DA_TABELA + rodapé da tabela
+#define LINHAS_MINIMAS_ROLAGEM 20   // Espaço mínimo abaixo do mapa fixo para menus e mensagens
+#define TAM_BUFFER_COMANDOS (1 << 20)
+#define FATIAS_POR_BLOCO_ARENA 64
+#define ALINHAMENTO_ARENA 64        // Linha de cache: as fatias de sessões diferentes não se misturam
+#define COMANDOS_POR_LOTE_SESSOES (1 << 16)
+#define SESSOES_POR_TAREFA 64
+#define MAX_DESFAZER 32             // Passos guardados para desfazer (os mais antigos são esquecidos)
+#define BALDES_HISTOGRAMA 40        // Balde i: durações de 2^i a 2^(i+1) - 1 ns (o último acumula o resto)
+
+// --- Estrutura de Dados ---
+// Cores e nomes são internados: cada texto distinto vira um ID inteiro pequeno
+// e as comparações de dono passam a ser comparações de inteiros.
+typedef uint8_t IdCor;
+
+// Tabela de textos internados. Os textos ficam lado a lado em um único bloco
+// de caracteres e inicio[id] guarda o deslocamento de cada um.
+typedef struct {
+    char *caracteres;
+    size_t tamanho;
+    size_t capacidadeCaracteres;
+    uint32_t *inicio;
+    int quantidade;
+    int capacidade;
+} TabelaTextos;
+
+struct CatalogoMissoes;
+
+// Escrita anotada no diário de um mapa: o campo alterado e o valor que ele
+// tinha antes.
+typedef struct {
+    void *campo;                  // int32_t* (largura 4) ou IdCor* (largura 1)
+    int32_t valor;
+    int32_t largura;
+} EscritaDiario;
+
+// Diário de escritas de um mapa. Antes de cada mudança no estado da partida
+// (donos, tropas e estado derivado) o valor antigo do campo é anotado, então
+// um instantâneo é só a posição atual do diário: tudo o que não mudou
+// continua sendo o próprio mapa, e voltar a um instantâneo desfaz apenas as
+// escritas feitas depois dele, da última para a primeira.
+typedef struct DiarioMapa {
+    EscritaDiario *escritas;
+    size_t quantidade;
+    size_t capacidade;
+    uint64_t descartadas;         // Posição absoluta de escritas[0]; instantâneos anteriores não valem mais
+} DiarioMapa;
+
+typedef uint64_t Instantaneo;     // Posição absoluta no diário do mapa
+
+// Mapa em forma de estrutura de vetores: o dono e as tropas de cada território
+// ficam em vetores contíguos separados (5 bytes por território nos laços
+// quentes), e o nome do território i é o texto i da tabela de nomes.
+// Regiões (continentes) agrupam territórios; cada território está em no
+// máximo uma, e quem domina uma região inteira ganha o bônus dela no reforço.
+typedef struct Mapa {
+    int quantidade;
+    IdCor *cor;
+    int32_t *tropas;
+    TabelaTextos *nomes;
+    TabelaTextos *cores;
+    TabelaTextos *regioes;        // Nome da região r é o texto r
+    uint32_t *inicioVizinhos;     // Fronteiras em CSR: vizinhos de i em vizinhos[inicioVizinhos[i] .. inicioVizinhos[i + 1])
+    uint32_t *vizinhos;
+    int numRegioes;
+    int32_t *regiaoDe;            // Região de cada território (-1 = nenhuma); NULL sem regiões
+    int32_t *tamanhoRegiao;       // Territórios de cada região
+    int32_t *bonusRegiao;         // Tropas extras de reforço para quem domina a região
+    const struct Mapa *original;  // Clones compartilham as tabelas e as fronteiras do mapa original
+    struct ArenaMapas *arena;     // Arena de onde o clone veio (NULL se os vetores vieram de malloc)
+    const struct CatalogoMissoes *missoes;  // Missões compiladas para este mapa (compartilhadas pelos clones)
+    void *arquivo;                // Mapeamento do arquivo binário (NULL se os vetores vieram de calloc)
+    size_t tamanhoArquivo;
+    struct DiarioMapa *diario;    // NULL = as mudanças não são anotadas (sem instantâneos)
+    
+    // Estado derivado, mantido a cada conquista por transferirTerritorio():
+    int32_t territoriosPorCor[MAX_CORES];
+    int32_t *vizinhosInimigos;    // Quantos vizinhos de cada território têm outra cor
+    int32_t *posicaoFronteira;    // Posição do território na lista de fronteira da sua cor (-1 = interior)
+    int32_t *fronteiras;          // Lista de fronteira da cor c: fronteiras[c * quantidade ..], numFronteiras[c] itens
+    int32_t numFronteiras[MAX_CORES];
+    int32_t *territoriosPorRegiao;// Territórios da cor c na região r: territoriosPorRegiao[c * numRegioes + r]
+    int32_t regioesPorCor[MAX_CORES];  // Regiões dominadas por inteiro por cada cor
+    int32_t bonusPorCor[MAX_CORES];    // Soma dos bônus dessas regiões
+} Mapa;
+
+// Arena de clones de um mesmo mapa. Cada clone ocupa uma fatia de tamanho
+// fixo (a estrutura Mapa seguida dos seus vetores); as fatias são reservadas
+// em blocos de FATIAS_POR_BLOCO_ARENA e as devolvidas vão para uma lista de
+// livres, reaproveitada pelo próximo clone. Usada por uma única thread.
+typedef struct ArenaMapas {
+    const struct Mapa *modelo;
+    size_t tamanhoFatia;
+    char **blocos;
+    int numBlocos;
+    int capacidadeBlocos;
+    void *livres;                 // Lista encadeada: cada fatia livre guarda o endereço da próxima
+    long fatiasEmUso;
+} ArenaMapas;
+
+// Par atacante → defensor que faz fronteira e passa em validarAtaque().
+typedef struct {
+    int32_t atacante;
+    int32_t defensor;
+} Ataque;
+
+// Cabeçalho do arquivo binário de mapa. Cada seção começa em um deslocamento
+// múltiplo de 8 bytes, e o arquivo é mapeado em memória e usado no próprio
+// lugar: os vetores do Mapa apontam direto para as seções.
+typedef struct {
+    char assinatura[8];          // ASSINATURA_MAPA
+    uint32_t versao;             // VERSAO_MAPA
+    uint32_t numTerritorios;
+    uint32_t numCores;
+    uint32_t numVizinhos;        // Entradas em vizinhos[] (cada fronteira aparece duas vezes)
+    uint64_t tamanhoTextos;
+    uint64_t secaoCor;           // IdCor[numTerritorios]
+    uint64_t secaoTropas;        // int32_t[numTerritorios]
+    uint64_t secaoNomes;         // uint32_t[numTerritorios]: início de cada nome em textos
+    uint64_t secaoCores;         // uint32_t[numCores]: início de cada cor em textos
+    uint64_t secaoInicioVizinhos;// uint32_t[numTerritorios + 1]
+    uint64_t secaoVizinhos;      // uint32_t[numVizinhos]
+    uint64_t secaoTextos;        // char[tamanhoTextos]
+    // A partir da versão 2:
+    uint32_t numRegioes;
+    uint32_t reservado;
+    uint64_t secaoRegiaoDe;      // int32_t[numTerritorios] (-1 = fora de qualquer região)
+    uint64_t secaoTamanhoRegioes;// int32_t[numRegioes]
+    uint64_t secaoBonusRegioes;  // int32_t[numRegioes]
+    uint64_t secaoRegioes;       // uint32_t[numRegioes]: início de cada nome de região em textos
+} CabecalhoMapa;
+
+// Tipos de missão que o catálogo sabe compilar.
+typedef enum {
+    MISSAO_ELIMINAR = 1,     // missao;eliminar;Cor;...      destruir um exército
+    MISSAO_TERRITORIOS,      // missao;territorios;N;...     dominar N territórios
+    MISSAO_REGIAO            // missao;regiao;A,B,C;...      dominar todos os territórios listados
+                             // missao;regiao;Região;...     ou uma região do mapa
+} TipoMissao;
+
+// Missão do catálogo já compilada para um mapa: cores e territórios viram
+// IDs e índices, e os textos ficam na tabela do catálogo.
+typedef struct {
+    TipoMissao tipo;
+    IdCor corAlvo;           // MISSAO_ELIMINAR (COR_INVALIDA se a cor não existe no mapa)
+    int territoriosMinimos;  // MISSAO_TERRITORIOS
+    int inicioRegiao;        // MISSAO_REGIAO: territórios em territoriosRegioes[inicioRegiao ..]
+    int tamanhoRegiao;
+    int regiaoMapa;          // MISSAO_REGIAO: região do mapa (-1 = lista de territórios)
+    int titulo;              // IDs na tabela de textos do catálogo
+    int detalhe;
+} Missao;
+
+// Catálogo de missões de um mapa. A missão de ID i fica em missoes[i - 1].
+typedef struct CatalogoMissoes {
+    Missao missoes[MAX_MISSOES];
+    int quantidade;
+    int32_t *territoriosRegioes;
+    int numTerritoriosRegioes;
+    TabelaTextos textos;
+} CatalogoMissoes;
+
+// Missão de um jogador, pronta para ser verificada sem procurar nomes:
+// eliminar e territórios custam O(1) com os contadores por cor, uma região do
+// mapa com a contagem por cor e região, e uma lista de territórios custa no
+// máximo uma passada por eles.
+typedef struct {
+    int idMissao;            // 0 = nenhuma missão
+    TipoMissao tipo;
+    IdCor corJogador;
+    IdCor corAlvo;
+    int territoriosMinimos;
+    const int32_t *regiao;
+    int tamanhoRegiao;
+    int regiaoMapa;          // Região do mapa (-1 = usa a lista regiao[])
+} Objetivo;
+
+// Gerador de números aleatórios xoshiro256** com estado próprio por partida.
+// Substitui o rand() global: pode ser usado em várias threads e uma mesma
+// semente sempre reproduz exatamente a mesma partida.
+typedef struct {
+    uint64_t s[4];
+} GeradorAleatorio;
+
+// Resultado de um ataque, usado para separar a lógica da batalha da exibição.
+typedef enum {
+    ATAQUE_VALIDO = 0,
+    ATAQUE_TROPAS_INSUFICIENTES,
+    ATAQUE_MESMA_COR,
+    ATAQUE_NAO_ADJACENTE,
+    ATAQUE_DEFENSOR_RESISTIU,
+    ATAQUE_ATACANTE_VENCEU,
+    ATAQUE_CONQUISTA,
+    ATAQUE_MISSAO_CUMPRIDA  // Conquista que acabou de cumprir o objetivo informado
+} ResultadoAtaque;
+
+// Distribuição exata das perdas do defensor em uma batalha de várias rodadas.
+// Como o atacante não perde tropas quando o defensor resiste, cada rodada é
+// uma tentativa independente com chance 15/36 de derrubar uma tropa, e as
+// perdas em r rodadas seguem uma Binomial(r, 15/36). Por isso a tabela é
+// indexada por rodadas e tropas do defensor; as tropas do atacante não mudam
+// o resultado.
+typedef struct {
+    double acumulada[MAX_RODADAS_BATALHA + 1][MAX_RODADAS_BATALHA + 1];    // P(perdas <= k) em r rodadas
+    uint64_t limiar[MAX_RODADAS_BATALHA + 1][MAX_RODADAS_BATALHA + 1];     // acumulada em escala 2^64
+    double perdasMedias[MAX_RODADAS_BATALHA + 1][MAX_RODADAS_BATALHA + 1]; // E[min(perdas, d)] em r rodadas
+} TabelaBatalha;
+
+// Estatísticas acumuladas de uma missão durante a simulação em lote.
+typedef struct {
+    long long partidas;
+    long long vitorias;
+    long long turnos;
+} EstatisticaMissao;
+
+// Estado privado de cada thread da simulação (sem memória compartilhada no laço).
+typedef struct {
+    long long primeiraPartida;
+    long long ultimaPartida;
+    uint64_t sementeBase;
+    const Mapa *modelo;
+    IdCor corJogador;
+    int rodadasPorAtaque;
+    int falhou;
+    EstatisticaMissao porMissao[MAX_MISSOES + 1];
+} TrabalhoSimulacao;
+
+// Tarefa do pool de threads: a função recebe o argumento e o índice do
+// trabalhador que a executa (para usar dados de trabalho daquela thread).
+typedef void (*FuncaoTarefa)(void *argumento, int trabalhador);
+
+typedef struct {
+    FuncaoTarefa funcao;
+    void *argumento;
+} Tarefa;
+
+// Fila de tarefas de um trabalhador. O dono retira do fim e os outros
+// trabalhadores roubam do início quando as suas filas esvaziam.
+typedef struct {
+    pthread_mutex_t trava;
+    Tarefa *itens;
+    int inicio;
+    int fim;
+    int capacidade;
+} FilaTarefas;
+
+struct PoolTrabalho;
+
+typedef struct {
+    struct PoolTrabalho *pool;
+    int id;
+} CabecaTrabalhador;
+
+// Pool fixo de threads com roubo de tarefas. As threads são criadas uma vez
+// e reaproveitadas em todas as buscas da partida.
+typedef struct PoolTrabalho {
+    int numTrabalhadores;
+    pthread_t *threads;
+    CabecaTrabalhador *cabecas;
+    FilaTarefas *filas;
+    pthread_mutex_t trava;         // Protege os contadores abaixo
+    pthread_cond_t temTrabalho;
+    pthread_cond_t terminou;
+    long pendentes;                // Tarefas enviadas e ainda não terminadas
+    long naFila;                   // Tarefas nas filas, ainda não retiradas
+    int proximaFila;
+    int encerrando;
+} PoolTrabalho;
+
+// Estado dos jogadores controlados pelo computador: o pool e um mapa de
+// trabalho (e vetor de ataques) por thread, criados uma vez por partida.
+typedef struct {
+    PoolTrabalho *pool;
+    Mapa **rascunhos;
+    Ataque **ataques;
+    uint64_t *buscaDoRascunho;     // Busca cujo estado raiz o mapa de trabalho de cada thread tem
+    uint64_t numBuscas;
+    int orcamentoMs;
+    GeradorAleatorio gerador;      // Sementes das simulações da busca
+} MotorIA;
+
+// Busca de uma jogada: candidatos e prazo, lidos por todos os lotes.
+typedef struct {
+    MotorIA *motor;
+    const Mapa *raiz;
+    uint64_t numero;               // Muda a cada busca (o mapa raiz pode ter mudado)
+    IdCor cor;
+    Ataque candidatos[MAX_CANDIDATOS_IA];
+    int numCandidatos;
+    struct timespec inicio;
+    double prazo;                  // Segundos a partir de inicio
+} BuscaIA;
+
+// Lote de simulações de um candidato, executado como uma tarefa do pool.
+typedef struct {
+    const BuscaIA *busca;
+    int candidato;
+    int quantidade;
+    uint64_t semente;
+    double soma;                   // Territórios finais somados
+    int simulacoes;                // Simulações feitas antes do prazo
+} LoteIA;
+
+// Tipos de evento do registro de partida.
+typedef enum {
+    EVENTO_CHECKPOINT = 1,   // a = turno; seguido de cor[] (alinhado a 4 bytes) e tropas[]
+    EVENTO_MISSAO,           // a = missão, b = cor do jogador
+    EVENTO_ATAQUE,           // a = atacante, b = defensor, dados e resultado
+    EVENTO_TROPAS,           // a = território, b = tropas acrescentadas (ou retiradas, se negativo)
+    EVENTO_FIM_TURNO,        // a = número do turno que terminou
+    EVENTO_RESTAURACAO       // Como o checkpoint, mas a partida voltou a esse estado (desfazer); a = turno
+} TipoEvento;
+
+// Evento do registro de partida: 12 bytes, gravados na ordem em que acontecem.
+typedef struct {
+    uint8_t tipo;
+    uint8_t dadoAtacante;
+    uint8_t dadoDefensor;
+    uint8_t resultado;       // ResultadoAtaque (a conquista já inclui a perda de tropa)
+    int32_t a;
+    int32_t b;
+} EventoJogo;
+
+// Cabeçalho do arquivo de registro de partida.
+typedef struct {
+    char assinatura[8];      // ASSINATURA_REGISTRO
+    uint32_t versao;         // VERSAO_REGISTRO
+    uint32_t numTerritorios;
+    uint64_t semente;
+} CabecalhoRegistro;
+
+// Registro de partida em gravação. Os eventos vão para um buffer e só são
+// escritos no arquivo em blocos de TAM_BUFFER_REGISTRO bytes.
+typedef struct {
+    FILE *arquivo;
+    uint8_t *buffer;
+    size_t usado;
+    long long eventos;
+    long long eventosDesdeCheckpoint;
+    int32_t turno;
+    int falhou;
+} RegistroEventos;
+
+// Resultado de reproduzirRegistro().
+typedef struct {
+    uint64_t semente;
+    int idMissao;
+    IdCor corJogador;
+    int32_t turno;             // Turno alcançado
+    int32_t turnoCheckpoint;   // Checkpoint de onde a reprodução partiu
+    long long eventos;         // Eventos reaplicados depois do checkpoint
+    long long ataques;
+} ResumoReproducao;
+
+// Saída do jogo montada em um buffer e enviada com um write() por quadro.
+// Guarda os donos e tropas do último quadro para redesenhar só o que mudou.
+typedef struct {
+    char *buffer;
+    size_t usado;
+    size_t capacidade;
+    int silenciosa;          // Não desenha nada (sessões automatizadas)
+    int linhasTerminal;      // Altura do terminal (0 = saída não é um terminal)
+    int fixa;                // Mapa fixo no topo, atualizado no lugar
+    int desenhada;           // Já existe um quadro anterior completo
+    int quantidade;
+    IdCor *corAnterior;
+    int32_t *tropasAnterior;
+} Tela;
+
+// Comandos do modo não interativo (um por linha, territórios de 1 a N).
+typedef enum {
+    COMANDO_VAZIO = 0,       // Linha em branco ou comentário (#)
+    COMANDO_ATACAR,          // atacar A D: uma rodada de dados de A contra D
+    COMANDO_TROPAS,          // tropas T N: acrescenta N tropas a T (retira, se negativo)
+    COMANDO_REFORCAR,        // reforcar T N: posiciona N das tropas de reforço do turno em T
+    COMANDO_MISSAO,          // missao: verifica se a missão foi cumprida
+    COMANDO_TURNO,           // turno: jogadas dos outros exércitos e fim do turno
+    COMANDO_MAPA,            // mapa: mostra o que mudou no mapa
+    COMANDO_DESFAZER,        // desfazer: volta o mapa ao estado anterior ao último comando que o alterou
+    COMANDO_METRICAS,        // metricas: retrato das métricas de desempenho (make METRICAS=1)
+    COMANDO_SAIR,            // sair: encerra a leitura
+    COMANDO_INVALIDO
+} TipoComando;
+
+typedef struct {
+    TipoComando tipo;
+    int a;
+    int b;
+} Comando;
+
+// Leitor de comandos em blocos de TAM_BUFFER_COMANDOS bytes. As linhas são
+// devolvidas no próprio buffer, sem cópia e sem uma leitura por comando.
+typedef struct {
+    int descritor;
+    int fecharAoFim;         // 0 para a entrada padrão
+    char *buffer;
+    size_t inicio;           // Bytes ainda não consumidos: buffer[inicio .. fim)
+    size_t fim;
+    long long linha;         // Número da última linha devolvida
+    int terminou;            // O arquivo chegou ao fim
+    int descartando;         // Pulando o resto de uma linha maior que o buffer
+} LeitorComandos;
+
+// Passo que pode ser desfeito: o instantâneo do mapa antes dele e o que
+// mais a partida precisa para voltar atrás.
+typedef struct {
+    Instantaneo instantaneo;
+    int32_t reforcos;
+    int32_t turno;           // Turno do registro de eventos
+} PassoDesfazer;
+
+// Últimos MAX_DESFAZER passos de uma partida, em um vetor circular.
+typedef struct {
+    PassoDesfazer passos[MAX_DESFAZER];
+    int inicio;
+    int quantidade;
+} HistoricoDesfazer;
+
+// Partida em andamento, como vista pelo modo de comandos.
+typedef struct {
+    Mapa *mapa;
+    GeradorAleatorio gerador;
+    Objetivo objetivo;
+    MotorIA *motorIA;        // NULL = outros exércitos parados
+    RegistroEventos *registro;
+    Tela *tela;
+    int reforcos;            // Tropas de reforço do jogador ainda não posicionadas neste turno
+    HistoricoDesfazer *historico;  // NULL = partida sem histórico (desfazer indisponível)
+} Partida;
+
+// Contadores de uma execução do modo de comandos.
+typedef struct {
+    long long comandos;
+    long long ataques;
+    long long conquistas;
+    long long recusados;     // Ataques e reforços recusados pelas regras
+    long long invalidos;     // Linhas que não são comandos
+    long long primeiraLinhaInvalida;
+} ResumoComandos;
+
+// Sessão do modo multissessão: uma partida independente e os comandos que
+// ela recebeu no lote atual, executados em ordem por um trabalhador do pool.
+typedef struct {
+    int id;
+    int ativa;
+    Partida partida;
+    Comando *pendentes;
+    int numPendentes;
+    int capacidadePendentes;
+    ResumoComandos resumo;
+} Sessao;
+
+struct GerenciadorSessoes;
+
+// Faixa de sessões executada como uma tarefa do pool.
+typedef struct {
+    struct GerenciadorSessoes *gerenciador;
+    int inicio;
+    int fim;
+} FaixaSessoes;
+
+// Gerenciador de sessões: todas as partidas partem do mesmo mapa modelo e
+// os seus vetores vêm de um único arena. Os comandos de cada sessão são
+// acumulados e executados em lotes no pool, em paralelo entre sessões.
+typedef struct GerenciadorSessoes {
+    const Mapa *modelo;
+    ArenaMapas *arena;
+    PoolTrabalho *pool;
+    Sessao *sessoes;               // A sessão de id N fica em sessoes[N - 1]
+    FaixaSessoes *faixas;
+    int maxSessoes;
+    int ativas;
+    int pendentes;                 // Comandos acumulados no lote atual
+    int silenciosa;
+    uint64_t semente;
+    Tela *saida;                   // Saída das sessões, enviada uma vez por lote
+    ResumoComandos total;          // Contadores das sessões já encerradas
+    long long sessoesAbertas;
+    long long lotes;
+} GerenciadorSessoes;
+
+// Contadores dos pontos quentes do jogo (ver CONTAR()).
+typedef enum {
+    CONTADOR_ATAQUES_TENTADOS = 0,   // Ataques que passaram por validarAtaque()
+    CONTADOR_RECUSA_TROPAS,          // ... recusados por tropas insuficientes
+    CONTADOR_RECUSA_MESMA_COR,       // ... recusados por serem da mesma cor
+    CONTADOR_RECUSA_NAO_ADJACENTE,   // ... recusados por falta de fronteira
+    CONTADOR_CONQUISTAS,             // Conquistas das jogadas da partida (jogador e outros exércitos)
+    CONTADOR_DADOS_ROLADOS,          // Dados lançados nas jogadas da partida
+    CONTADOR_CONQUISTAS_SIMULADAS,   // Conquistas das simulações em lote e da busca da IA
+    CONTADOR_DADOS_SIMULADOS,        // Dados sorteados pelas simulações em lote e pela busca da IA
+    NUM_CONTADORES
+} Contador;
+
+// Trechos cronometrados (ver INICIAR_MEDICAO()/ENCERRAR_MEDICAO()).
+typedef enum {
+    TEMPO_FASE_ATAQUE = 0,
+    TEMPO_SIMULAR_ATAQUE,
+    TEMPO_ATACAR_COMANDO,            // Comando "atacar" do modo de comandos e das sessões
+    TEMPO_VERIFICAR_VITORIA,
+    TEMPO_EXIBIR_MAPA,
+    TEMPO_TURNO,                     // Turno completo: jogador e outros exércitos
+    NUM_TEMPORIZADORES
+} Temporizador;
+
+// Histograma de latências em baldes de potências de 2 (nanossegundos).
+typedef struct {
+    uint64_t amostras;
+    uint64_t totalNs;
+    uint64_t minimoNs;
+    uint64_t maximoNs;
+    uint64_t baldes[BALDES_HISTOGRAMA];
+} Histograma;
+
+// Retrato das métricas de todas as threads, somadas por capturarMetricas().
+typedef struct {
+    uint64_t contadores[NUM_CONTADORES];
+    Histograma tempos[NUM_TEMPORIZADORES];
+} Metricas;
+
+// Instrumentação só existe com -DWAR_METRICAS (make METRICAS=1). Sem ela, as
+// macros abaixo não geram código e o jogo não paga nada pelas medições.
+#ifdef WAR_METRICAS
+// Métricas de uma thread. Só a própria thread escreve (sem instruções
+// atômicas de leitura-modificação-escrita); os campos atômicos relaxados
+// deixam capturarMetricas() somar as threads a qualquer momento.
+typedef struct {
+    _Atomic uint64_t amostras;
+    _Atomic uint64_t totalNs;
+    _Atomic uint64_t minimoNs;
+    _Atomic uint64_t maximoNs;
+    _Atomic uint64_t baldes[BALDES_HISTOGRAMA];
+} HistogramaThread;
+
+typedef struct MetricasThread {
+    _Atomic uint64_t contadores[NUM_CONTADORES];
+    HistogramaThread tempos[NUM_TEMPORIZADORES];
+    struct MetricasThread *proxima;   // Lista de todas as threads já medidas
+} MetricasThread;
+
+#define CONTAR(contador, n) somarContador((contador), (uint64_t) (n))
+#define INICIAR_MEDICAO(inicio) uint64_t inicio = instanteMetricas()
+#define ENCERRAR_MEDICAO(temporizador, inicio) registrarTempo((temporizador), instanteMetricas() - (inicio))
+#else
+#define CONTAR(contador, n) ((void) 0)
+#define INICIAR_MEDICAO(inicio) ((void) 0)
+#define ENCERRAR_MEDICAO(temporizador, inicio) ((void) 0)
+#endif
+
+// --- Protótipos das Funções ---
+// Funções de setup e gerenciamento de memória:
+Mapa* alocarMapa(int quantidade);
+Mapa* clonarMapa(const Mapa *original);
+void copiarEstadoMapa(Mapa *destino, const Mapa *origem);
+int recalcularContagens(Mapa *mapa);
+int definirFronteiras(Mapa *mapa, const uint32_t pares[][2], int numPares);
+int inicializarTerritorios(Mapa *mapa);
+void liberarMemoria(Mapa *mapa);
+
+// Funções de instantâneos do mapa (diário de escritas):
+int iniciarDiario(Mapa *mapa);
+Instantaneo tirarInstantaneo(const Mapa *mapa);
+int restaurarInstantaneo(Mapa *mapa, Instantaneo instantaneo);
+void esquecerInstantaneos(Mapa *mapa, Instantaneo instantaneo);
+void guardarPassoDesfazer(HistoricoDesfazer *historico, Mapa *mapa, int32_t reforcos,
+                          const RegistroEventos *registro);
+int desfazerPasso(HistoricoDesfazer *historico, Mapa *mapa, PassoDesfazer *passo);
+
+// Funções do arena de mapas (clones sem malloc por partida):
+ArenaMapas* criarArena(const Mapa *modelo);
+Mapa* clonarMapaNaArena(ArenaMapas *arena, const Mapa *original);
+void destruirArena(ArenaMapas *arena);
+
+// Funções de arquivos de mapa:
+Mapa* carregarMapa(const char *caminho);
+Mapa* carregarMapaTexto(const char *caminho);
+Mapa* mapearMapaBinario(const char *caminho);
+int salvarMapaBinario(const Mapa *mapa, const char *caminho);
+int converterMapa(const char *origem, const char *destino);
+
+// Funções da tabela de textos internados:
+int adicionarTexto(TabelaTextos *tabela, const char *texto);
+int internarTexto(TabelaTextos *tabela, const char *texto);
+const char* textoDe(const TabelaTextos *tabela, int id);
+const char* nomeTerritorio(const Mapa *mapa, int territorio);
+const char* nomeCor(const Mapa *mapa, IdCor cor);
+IdCor buscarCor(const Mapa *mapa, const char *nome);
+int buscarRegiao(const Mapa *mapa, const char *nome);
+
+// Funções de interface com o usuário:
+Tela* criarTela(int silenciosa);
+void liberarTela(Tela *tela);
+void escreverTela(Tela *tela, const char *formato, ...);
+void descarregarTela(Tela *tela);
+void exibirMenuPrincipal(Tela *tela);
+void exibirMapa(Tela *tela, const Mapa *mapa);
+void exibirMissao(Tela *tela, const Mapa *mapa, int idMissao);
+
+// Funções do gerador de números aleatórios:
+void semearGerador(GeradorAleatorio *gerador, uint64_t semente);
+uint64_t proximoAleatorio(GeradorAleatorio *gerador);
+uint32_t sortearIntervalo(GeradorAleatorio *gerador, uint32_t limite);
+void rolarDados(GeradorAleatorio *gerador, uint8_t dados[], int quantidade);
+
+// Funções de lógica principal do jogo:
+void faseDeAtaque(Mapa *mapa, GeradorAleatorio *gerador, const Objetivo *objetivo, RegistroEventos *registro);
+void simularAtaque(Mapa *mapa, int atacante, int defensor, GeradorAleatorio *gerador, const Objetivo *objetivo,
+                   RegistroEventos *registro);
+ResultadoAtaque validarAtaque(const Mapa *mapa, int atacante, int defensor);
+ResultadoAtaque resolverAtaque(Mapa *mapa, int atacante, int defensor, int dadoAtacante, int dadoDefensor,
+                               const Objetivo *objetivo);
+void transferirTerritorio(Mapa *mapa, int territorio, IdCor novaCor);
+int saoVizinhos(const Mapa *mapa, int a, int b);
+int listarAtaques(const Mapa *mapa, IdCor cor, Ataque ataques[], int capacidade);
+int calcularReforcos(const Mapa *mapa, IdCor cor);
+void faseDeReforco(Mapa *mapa, IdCor cor, RegistroEventos *registro);
+int definirRegiao(Mapa *mapa, const char *nome, int32_t bonus, const int32_t territorios[], int quantidade);
+int limiteAtaques(const Mapa *mapa);
+int rolarDado(GeradorAleatorio *gerador);
+int verificarVitoria(const Mapa *mapa, const Objetivo *objetivo);
+
+// Funções do catálogo de missões:
+int compilarMissoes(Mapa *mapa, const char *caminho);
+int compilarMissoesTexto(Mapa *mapa, const char *texto, const char *origem);
+void liberarMissoes(CatalogoMissoes *catalogo);
+int sortearMissao(const Mapa *mapa, GeradorAleatorio *gerador);
+Objetivo prepararObjetivo(const Mapa *mapa, int idMissao, IdCor corJogador);
+int verificarMissoes(const Mapa *mapa, const Objetivo objetivos[], int quantidade, int cumpridas[]);
+
+// Funções da tabela de probabilidades de batalha:
+const TabelaBatalha* tabelaBatalha(void);
+double chanceConquista(int tropasDefensor, int rodadas);
+double perdasEsperadas(int tropasDefensor, int rodadas);
+double rodadasEsperadasConquista(int tropasDefensor);
+ResultadoAtaque resolverBatalha(Mapa *mapa, int atacante, int defensor, int rodadas, GeradorAleatorio *gerador,
+                                const Objetivo *objetivo);
+
+// Funções do motor de simulação em lote (sem entrada/saída no laço principal):
+int contarTerritoriosDaCor(const Mapa *mapa, IdCor cor);
+int jogarPartidaAutomatica(Mapa *mapa, int idMissao, IdCor corJogador, int rodadasPorAtaque,
+                           GeradorAleatorio *gerador, Ataque ataques[], int *turnos);
+void* executarTrabalhoSimulacao(void *argumento);
+int executarSimulacao(const Mapa *modelo, long long numPartidas, uint64_t semente, int numThreads,
+                      int rodadasPorAtaque);
+
+// Funções do pool de threads com roubo de tarefas:
+PoolTrabalho* criarPool(int numTrabalhadores);
+int enviarTarefa(PoolTrabalho *pool, FuncaoTarefa funcao, void *argumento);
+void aguardarPool(PoolTrabalho *pool);
+void destruirPool(PoolTrabalho *pool);
+
+// Funções dos jogadores controlados pelo computador:
+MotorIA* criarMotorIA(const Mapa *mapa, int numThreads, int orcamentoMs, uint64_t semente);
+void destruirMotorIA(MotorIA *motor);
+long long escolherJogadaIA(MotorIA *motor, const Mapa *mapa, IdCor cor, Ataque *escolhida);
+void jogarTurnosIA(MotorIA *motor, Mapa *mapa, IdCor corJogador, GeradorAleatorio *gerador,
+                   RegistroEventos *registro);
+
+// Funções do registro de eventos (gravação e reprodução de partidas):
+RegistroEventos* abrirRegistro(const char *caminho, const Mapa *mapa, uint64_t semente);
+void registrarMissao(RegistroEventos *registro, int idMissao, IdCor corJogador);
+void registrarAtaque(RegistroEventos *registro, int atacante, int defensor, int dadoAtacante, int dadoDefensor,
+                     ResultadoAtaque resultado);
+void registrarTropas(RegistroEventos *registro, int territorio, int32_t variacao);
+void registrarFimTurno(RegistroEventos *registro, const Mapa *mapa);
+void registrarRestauracao(RegistroEventos *registro, const Mapa *mapa, int32_t turno);
+int fecharRegistro(RegistroEventos *registro);
+int reproduzirRegistro(Mapa *mapa, const char *caminho, int32_t turnoAlvo, ResumoReproducao *resumo);
+
+// Funções do modo de comandos (entrada por arquivo ou pipe, sem pausas):
+LeitorComandos* abrirComandos(const char *caminho);
+int proximaLinha(LeitorComandos *leitor, char **linha);
+void fecharComandos(LeitorComandos *leitor);
+TipoComando interpretarComando(const char *linha, Comando *comando);
+int executarComando(Partida *partida, const Comando *comando, ResumoComandos *resumo);
+int executarArquivoComandos(Partida *partida, const char *caminho);
+
+// Funções do gerenciador de sessões (várias partidas no mesmo processo):
+GerenciadorSessoes* criarGerenciador(const Mapa *modelo, int maxSessoes, int numThreads, uint64_t semente,
+                                     int silenciosa);
+int abrirSessao(GerenciadorSessoes *gerenciador, int id);
+void fecharSessao(GerenciadorSessoes *gerenciador, int id);
+void executarLoteSessoes(GerenciadorSessoes *gerenciador);
+void destruirGerenciador(GerenciadorSessoes *gerenciador);
+int executarSessoes(const Mapa *modelo, const char *caminho, int maxSessoes, int numThreads, uint64_t semente,
+                    int silenciosa);
+
+#ifdef WAR_METRICAS
+// Funções das métricas de desempenho (só com -DWAR_METRICAS):
+uint64_t instanteMetricas(void);
+void somarContador(Contador contador, uint64_t quantidade);
+void registrarTempo(Temporizador temporizador, uint64_t nanossegundos);
+void capturarMetricas(Metricas *metricas);
+void exportarMetricasTexto(Tela *tela, const Metricas *metricas);
+void exportarMetricasJson(Tela *tela, const Metricas *metricas);
+int salvarMetricas(const char *caminho);
+#endif
+
+// Função utilitária:
+void limparBufferEntrada();
+
+#endif // WAR_H